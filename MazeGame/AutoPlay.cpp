@@ -0,0 +1,127 @@
+// AutoPlay.cpp
+#include "AutoPlay.h"
+#include "MctsBot.h"
+#include "GameSim.h"
+#include "Maze.h"
+#include "Player.h"
+#include "Enemy.h"
+#include "Item.h"
+#include "Goal.h"
+#include "GameConfig.h"
+#include "GameSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+
+// The bot of one game
+struct AutoPlay::SessionState {
+    bool enabled = GameConfig::AUTOPLAY_START_ENABLED;
+
+    // The bot's copy of the walls and goal, rebuilt when the maze changes
+    std::unique_ptr<GameSim::Level> level;
+    std::unique_ptr<MctsBot> bot;
+    int levelRevision = -1;
+    int levelGoalX = -1, levelGoalY = -1;
+
+    // The search running on the background thread, if any. Declared last so it is waited
+    // for before the bot it searches with is destroyed.
+    std::future<int> pendingMove;
+    Uint64 nextMoveTime = 0;
+};
+
+namespace {
+    AutoPlay::SessionState& state() {
+        return *GameSession::current().autoPlay;
+    }
+
+    // Make sure the level matches the maze; only called while no search is running
+    void refreshLevel(AutoPlay::SessionState& s) {
+        int goalX = Goal::getX();
+        int goalY = Goal::getY();
+        if (s.level && s.levelRevision == Maze::getRevision() && s.levelGoalX == goalX && s.levelGoalY == goalY) return;
+
+        GameSim::Rules rules;
+        rules.playerStepInterval = GameConfig::AUTOPLAY_STEP_INTERVAL;
+        s.level = std::make_unique<GameSim::Level>(
+            GameSim::makeLevel(Maze::getWalkGrid(), Player::getX(), Player::getY(), goalX, goalY, rules));
+        s.bot = std::make_unique<MctsBot>(*s.level);
+
+        s.levelRevision = Maze::getRevision();
+        s.levelGoalX = goalX;
+        s.levelGoalY = goalY;
+    }
+
+    // What is on screen right now, as a state the bot can copy and play on.
+    // The game doesn't remember which way items and enemies are heading, so the bot guesses.
+    GameSim::State snapshot(int score, int timeRemaining, int lives, Uint64 invulnerableLeft, Uint64 nextSecondIn) {
+        GameSim::State state = {};
+        state.random = static_cast<uint32_t>(SDL_GetTicks()) | 1;
+        state.playerX = Player::getX();
+        state.playerY = Player::getY();
+        state.score = score;
+        state.timeRemaining = timeRemaining;
+        state.lives = lives;
+
+        // The move being planned happens right away (time 0), the next one a step later
+        state.nextStep = 0;
+        state.nextSecond = nextSecondIn;
+        state.nextEnemyMove = GameConfig::ENEMY_MOVE_INTERVAL / 2;
+        state.nextItemMove = GameConfig::ITEM_MOVE_INTERVAL / 2;
+        state.invulnerableUntil = invulnerableLeft;
+
+        for (const auto& item : Item::getPositions()) {
+            if (state.itemCount == GameSim::MAX_SIM_ITEMS) break;
+            state.items[state.itemCount++] = { item.first, item.second, static_cast<int>(GameSim::nextRandom(state) % 4) };
+        }
+        for (const auto& enemy : Enemy::getPositions()) {
+            if (state.enemyCount == GameSim::MAX_SIM_ENEMIES) break;
+            state.enemies[state.enemyCount++] = { enemy.first, enemy.second, static_cast<int>(GameSim::nextRandom(state) % 4) };
+        }
+        return state;
+    }
+}
+
+std::shared_ptr<AutoPlay::SessionState> AutoPlay::createSessionState() {
+    return std::make_shared<SessionState>();
+}
+
+void AutoPlay::toggle() {
+    SessionState& s = state();
+    s.enabled = !s.enabled;
+}
+
+bool AutoPlay::isEnabled() {
+    return state().enabled;
+}
+
+void AutoPlay::update(int score, int timeRemaining, int lives, Uint64 invulnerableLeft, Uint64 nextSecondIn) {
+    SessionState& s = state();
+
+    // A finished search is always picked up, even if the bot was just turned off
+    if (s.pendingMove.valid()) {
+        if (s.pendingMove.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+        int move = s.pendingMove.get();
+        if (s.enabled && move != GameSim::STAY) Player::move(GameSim::STEP_X[move], GameSim::STEP_Y[move]);
+    }
+
+    Uint64 now = SDL_GetTicks();
+    if (!s.enabled || now < s.nextMoveTime) return;
+    s.nextMoveTime = now + GameConfig::AUTOPLAY_STEP_INTERVAL;
+
+    refreshLevel(s);
+    GameSim::State state = snapshot(score, timeRemaining, lives, invulnerableLeft, nextSecondIn);
+    MctsBot::Budget budget;
+    budget.timeMs = GameConfig::AUTOPLAY_THINK_TIME;
+
+    MctsBot* searcher = s.bot.get();
+    s.pendingMove = std::async(std::launch::async, [searcher, state, budget] {
+        return searcher->chooseMove(state, budget);
+    });
+}
+
+void AutoPlay::shutdown() {
+    SessionState& s = state();
+    if (s.pendingMove.valid()) s.pendingMove.wait();
+}
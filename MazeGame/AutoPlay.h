@@ -0,0 +1,24 @@
+// AutoPlay.h
+#pragma once
+#include <SDL3/SDL.h>
+#include <memory>
+
+// Lets the MCTS bot (see MctsBot) play the running game.
+// Every move it copies what is on screen into a GameSim::State and searches on a
+// background thread, so the game keeps drawing while the bot thinks.
+namespace AutoPlay {
+    // Turn the bot on or off (the A key)
+    void toggle();
+    bool isEnabled();
+
+    // Call once per frame with the numbers the game keeps itself. Starts a search when it is
+    // time for the next move and moves the player when the search is done.
+    void update(int score, int timeRemaining, int lives, Uint64 invulnerableLeft, Uint64 nextSecondIn);
+
+    // Wait for a search that is still running
+    void shutdown();
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
+}
@@ -0,0 +1,301 @@
+// BatchSim.cpp
+#include "BatchSim.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+
+namespace {
+    // Largest level (in walkable tiles) that gets a chase table; it needs tiles * tiles bytes
+    const int MAX_CHASE_TILES = 4096;
+
+    // Same generator as GameSim::nextRandom
+    inline uint32_t xorshift(uint32_t x) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    }
+}
+
+BatchSim::BatchSim(const GameSim::Level& level, int gameCount)
+    : level(level),
+    gameCount(std::max(1, gameCount)),
+    paddedWidth(level.width + 2) {
+    offset[0] = -paddedWidth;
+    offset[1] = 1;
+    offset[2] = paddedWidth;
+    offset[3] = -1;
+
+    // Walkable tiles with a ring of walls around them, and the way to the goal from each
+    const int paddedTiles = paddedWidth * (level.height + 2);
+    walk.assign(paddedTiles, 0);
+    goalDir.assign(paddedTiles, static_cast<int8_t>(GameSim::STAY));
+    compactId.assign(paddedTiles, -1);
+    for (int y = 0; y < level.height; ++y) {
+        for (int x = 0; x < level.width; ++x) {
+            if (!level.isWalkable(x, y)) continue;
+            int tile = (y + 1) * paddedWidth + (x + 1);
+            walk[tile] = 1;
+            goalDir[tile] = static_cast<int8_t>(GameSim::stepDownhill(level, level.goalDistance, x, y));
+            compactId[tile] = compactCount++;
+        }
+    }
+    if (level.goalX >= 0) goalTile = (level.goalY + 1) * paddedWidth + (level.goalX + 1);
+
+    // chaseDir[target * compactCount + from]: the step GameSim's chasing enemies would take
+    if (GameConfig::ENEMY_CHASE_PLAYER && compactCount <= MAX_CHASE_TILES) {
+        chaseDir.assign(static_cast<size_t>(compactCount) * compactCount, static_cast<int8_t>(GameSim::STAY));
+        std::vector<int> distance, queue;
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                int target = compactId[(y + 1) * paddedWidth + (x + 1)];
+                if (target < 0) continue;
+                GameSim::distancesFrom(level, y * level.width + x, distance, queue);
+                for (int fy = 0; fy < level.height; ++fy) {
+                    for (int fx = 0; fx < level.width; ++fx) {
+                        int from = compactId[(fy + 1) * paddedWidth + (fx + 1)];
+                        if (from < 0) continue;
+                        chaseDir[static_cast<size_t>(target) * compactCount + from] =
+                            static_cast<int8_t>(GameSim::stepDownhill(level, distance, fx, fy));
+                    }
+                }
+            }
+        }
+    }
+
+    reset(1);
+}
+
+void BatchSim::reset(uint32_t seed) {
+    // Every game starts from GameSim's own setup, then gets spread out into the arrays
+    std::vector<GameSim::State> starts(gameCount);
+    itemSlots = 0;
+    enemySlots = 0;
+    for (int g = 0; g < gameCount; ++g) {
+        starts[g] = GameSim::newGame(level, seed + static_cast<uint32_t>(g));
+        itemSlots = std::max(itemSlots, starts[g].itemCount);
+        enemySlots = std::max(enemySlots, starts[g].enemyCount);
+    }
+
+    playerTile.assign(gameCount, 0);
+    lives.assign(gameCount, 0);
+    score.assign(gameCount, 0);
+    over.assign(gameCount, 0);
+    won.assign(gameCount, 0);
+    invulnerableUntil.assign(gameCount, 0);
+    finishTime.assign(gameCount, 0);
+    random.assign(gameCount, 0);
+    itemCount.assign(gameCount, 0);
+    enemyCount.assign(gameCount, 0);
+
+    // Unused slots sit on tile 0, a wall in the corner that the player can never stand on
+    itemTile.assign(static_cast<size_t>(itemSlots) * gameCount, 0);
+    itemDir.assign(static_cast<size_t>(itemSlots) * gameCount, 0);
+    enemyTile.assign(static_cast<size_t>(enemySlots) * gameCount, 0);
+    enemyDir.assign(static_cast<size_t>(enemySlots) * gameCount, 0);
+
+    for (int g = 0; g < gameCount; ++g) {
+        const GameSim::State& s = starts[g];
+        playerTile[g] = (s.playerY + 1) * paddedWidth + (s.playerX + 1);
+        lives[g] = s.lives;
+        score[g] = s.score;
+        random[g] = s.random;
+        itemCount[g] = s.itemCount;
+        enemyCount[g] = s.enemyCount;
+        for (int k = 0; k < s.itemCount; ++k) {
+            itemTile[k * gameCount + g] = (s.items[k].y + 1) * paddedWidth + (s.items[k].x + 1);
+            itemDir[k * gameCount + g] = s.items[k].dir;
+        }
+        for (int k = 0; k < s.enemyCount; ++k) {
+            enemyTile[k * gameCount + g] = (s.enemies[k].y + 1) * paddedWidth + (s.enemies[k].x + 1);
+            enemyDir[k * gameCount + g] = s.enemies[k].dir;
+        }
+    }
+
+    const GameSim::State& first = starts[0];
+    now = 0;
+    nextStep = first.nextStep;
+    nextSecond = first.nextSecond;
+    nextEnemyMove = first.nextEnemyMove;
+    nextItemMove = first.nextItemMove;
+    timeRemaining = first.timeRemaining;
+    runningCount = gameCount;
+}
+
+void BatchSim::tick(const int8_t* actions) {
+    bool moved = false;
+
+    // Same event order as GameSim::step, but every event is handled for all games at once
+    while (runningCount > 0) {
+        Uint64 time = std::min({ nextStep, nextSecond, nextEnemyMove, nextItemMove });
+        bool pickUp = false;    // Items can only be picked up when the player or the items moved
+
+        if (time == nextStep) {
+            if (moved) return;
+            movePlayers(actions);
+            moved = true;
+            pickUp = true;
+            nextStep += level.rules.playerStepInterval;
+        }
+        now = time;
+
+        if (time == nextSecond) {
+            --timeRemaining;
+            nextSecond += GameConfig::TIME_DECREASE_INTERVAL;
+        }
+        if (time == nextEnemyMove) {
+            moveEnemies();
+            nextEnemyMove += level.rules.enemyMoveInterval;
+        }
+        if (time == nextItemMove) {
+            moveItems();
+            pickUp = true;
+            nextItemMove += GameConfig::ITEM_MOVE_INTERVAL;
+        }
+
+        if (pickUp) collectItems();
+        checkGames();
+    }
+}
+
+void BatchSim::movePlayers(const int8_t* actions) {
+    const uint8_t* walkable = walk.data();
+    for (int g = 0; g < gameCount; ++g) {
+        int action = actions[g];
+        int tile = playerTile[g];
+        int next = tile + offset[action & 3];
+        bool go = action >= 0 && action < 4 && !over[g] && walkable[next];
+        playerTile[g] = go ? next : tile;
+    }
+}
+
+void BatchSim::moveEnemies() {
+    const uint8_t* walkable = walk.data();
+
+    if (GameConfig::ENEMY_CHASE_PLAYER) {
+        if (!chaseDir.empty()) {
+            for (int k = 0; k < enemySlots; ++k) {
+                int32_t* tiles = &enemyTile[static_cast<size_t>(k) * gameCount];
+                int32_t* dirs = &enemyDir[static_cast<size_t>(k) * gameCount];
+                for (int g = 0; g < gameCount; ++g) {
+                    int from = compactId[tiles[g]];
+                    int chase = k < enemyCount[g] && from >= 0
+                        ? chaseDir[static_cast<size_t>(compactId[playerTile[g]]) * compactCount + from] : GameSim::STAY;
+                    dirs[g] = chase != GameSim::STAY ? chase : dirs[g];
+                }
+            }
+        }
+        else {
+            // Too big for the table: one search per game, like GameSim does
+            for (int g = 0; g < gameCount; ++g) {
+                int px = getPlayerX(g);
+                int py = getPlayerY(g);
+                GameSim::distancesFrom(level, py * level.width + px, scratch.distance, scratch.queue);
+                for (int k = 0; k < enemyCount[g]; ++k) {
+                    size_t index = static_cast<size_t>(k) * gameCount + g;
+                    int chase = GameSim::stepDownhill(level, scratch.distance,
+                        enemyTile[index] % paddedWidth - 1, enemyTile[index] / paddedWidth - 1);
+                    if (chase != GameSim::STAY) enemyDir[index] = chase;
+                }
+            }
+        }
+    }
+
+    // Walk on, or pick a random new direction when blocked (only then is a random number used)
+    for (int k = 0; k < enemySlots; ++k) {
+        int32_t* tiles = &enemyTile[static_cast<size_t>(k) * gameCount];
+        int32_t* dirs = &enemyDir[static_cast<size_t>(k) * gameCount];
+        for (int g = 0; g < gameCount; ++g) {
+            // Unused slots sit on tile 0 in the corner, so they look at their own tile
+            // instead of a neighbor that may lie outside the grid
+            bool active = k < enemyCount[g];
+            int tile = tiles[g];
+            int next = tile + (active ? offset[dirs[g]] : 0);
+            bool blocked = !walkable[next];
+            uint32_t shuffled = xorshift(random[g]);
+            bool turn = active && blocked;
+            random[g] = turn ? shuffled : random[g];
+            dirs[g] = turn ? static_cast<int32_t>(shuffled % 4) : dirs[g];
+            tiles[g] = active && !blocked ? next : tile;
+        }
+    }
+}
+
+void BatchSim::moveItems() {
+    const uint8_t* walkable = walk.data();
+
+    // Items number their directions right, down, left, up
+    const int itemOffset[4] = { 1, paddedWidth, -1, -paddedWidth };
+    for (int k = 0; k < itemSlots; ++k) {
+        int32_t* tiles = &itemTile[static_cast<size_t>(k) * gameCount];
+        int32_t* dirs = &itemDir[static_cast<size_t>(k) * gameCount];
+        for (int g = 0; g < gameCount; ++g) {
+            bool active = k < itemCount[g];
+            int tile = tiles[g];
+            int next = tile + (active ? itemOffset[dirs[g]] : 0);
+            bool blocked = !walkable[next];
+            uint32_t shuffled = xorshift(random[g]);
+            bool turn = active && blocked;
+            random[g] = turn ? shuffled : random[g];
+            dirs[g] = turn ? static_cast<int32_t>(shuffled % 4) : dirs[g];
+            tiles[g] = active && !blocked ? next : tile;
+        }
+    }
+}
+
+void BatchSim::collectItems() {
+    // Which games have an item on the player (unused slots are on tile 0)
+    std::vector<uint8_t>& onItem = gameFlags;
+    onItem.assign(gameCount, 0);
+    for (int k = 0; k < itemSlots; ++k) {
+        const int32_t* tiles = &itemTile[static_cast<size_t>(k) * gameCount];
+        for (int g = 0; g < gameCount; ++g) {
+            onItem[g] |= tiles[g] == playerTile[g];
+        }
+    }
+
+    // Picking up is rare, so it is done one game at a time, in the same order as GameSim
+    for (int g = 0; g < gameCount; ++g) {
+        if (!onItem[g] || over[g]) continue;
+        for (int i = 0; i < itemCount[g]; ) {
+            size_t index = static_cast<size_t>(i) * gameCount + g;
+            if (itemTile[index] != playerTile[g]) {
+                ++i;
+                continue;
+            }
+            score[g] += GameConfig::ITEM_SCORE;
+            size_t last = static_cast<size_t>(--itemCount[g]) * gameCount + g;
+            itemTile[index] = itemTile[last];
+            itemDir[index] = itemDir[last];
+            itemTile[last] = 0;
+            itemDir[last] = 0;
+        }
+    }
+}
+
+void BatchSim::checkGames() {
+    // Which games have an enemy on the player
+    std::vector<uint8_t>& hit = gameFlags;
+    hit.assign(gameCount, 0);
+    for (int k = 0; k < enemySlots; ++k) {
+        const int32_t* tiles = &enemyTile[static_cast<size_t>(k) * gameCount];
+        for (int g = 0; g < gameCount; ++g) {
+            hit[g] |= tiles[g] == playerTile[g];
+        }
+    }
+
+    const uint32_t time = static_cast<uint32_t>(now);
+    for (int g = 0; g < gameCount; ++g) {
+        bool running = !over[g];
+        bool hurt = running && hit[g] && time >= invulnerableUntil[g];
+        lives[g] -= hurt ? GameConfig::LIFE_LOSS_ON_HIT : 0;
+        invulnerableUntil[g] = hurt ? time + static_cast<uint32_t>(GameConfig::INVULNERABLE_DURATION) : invulnerableUntil[g];
+
+        bool reached = playerTile[g] == goalTile;
+        bool ends = running && (reached || timeRemaining <= 0 || lives[g] <= 0);
+        won[g] = ends ? reached : won[g];
+        over[g] = ends ? 1 : over[g];
+        finishTime[g] = ends ? time : finishTime[g];
+        runningCount -= ends ? 1 : 0;
+    }
+}
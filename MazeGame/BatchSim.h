@@ -0,0 +1,95 @@
+// BatchSim.h
+#pragma once
+#include "GameSim.h"
+#include <cstdint>
+#include <vector>
+
+// Thousands of games of the same level played in lockstep, for large-scale evaluation.
+//
+// GameSim keeps one game in one struct. Here every value gets its own array with one
+// entry per game ("structure of arrays"): all player tiles side by side, all scores side
+// by side, and so on. Since every game starts at the same moment and follows the same
+// rules, the clock and the event times are shared, and one tick runs the same simple
+// loop over all games for each kind of event. Those loops have no branches that depend
+// on the game, so the compiler can turn them into SIMD instructions.
+//
+// Started with the same seed, a game here plays exactly like GameSim::newGame/step.
+class BatchSim {
+public:
+    // The level must stay alive (and unchanged) as long as the batch is used
+    BatchSim(const GameSim::Level& level, int gameCount);
+
+    // Start every game again; game g plays like GameSim::newGame(level, seed + g)
+    void reset(uint32_t seed);
+
+    // Apply actions[g] (a direction 0-3 or GameSim::STAY) to every game that is still
+    // running and run all of them until the player's next move
+    void tick(const int8_t* actions);
+
+    // True once every game has ended
+    bool allOver() const { return runningCount == 0; }
+
+    int getGameCount() const { return gameCount; }
+    Uint64 getNow() const { return now; }
+
+    // Results of one game
+    int getPlayerX(int game) const { return playerTile[game] % paddedWidth - 1; }
+    int getPlayerY(int game) const { return playerTile[game] / paddedWidth - 1; }
+    int getScore(int game) const { return score[game]; }
+    int getLives(int game) const { return lives[game]; }
+    bool isOver(int game) const { return over[game] != 0; }
+    bool hasWon(int game) const { return won[game] != 0; }
+    Uint64 getFinishTime(int game) const { return finishTime[game]; }
+
+    // Direction that brings the player of game g one step closer to the goal (or GameSim::STAY)
+    int goalStep(int game) const { return goalDir[playerTile[game]]; }
+
+private:
+    const GameSim::Level& level;
+    const int gameCount;
+    const int paddedWidth;      // The level gets a ring of wall tiles, so a step never leaves the grid
+    int offset[4];              // Tile index change for each direction
+    std::vector<uint8_t> walk;  // Padded walkable tiles
+    std::vector<int8_t> goalDir;
+    int goalTile = -1;
+
+    // Enemy chasing: first step from any tile towards any other, when the level is small
+    // enough for the table (walkable tiles only, numbered by compactId)
+    std::vector<int32_t> compactId;
+    std::vector<int8_t> chaseDir;
+    int compactCount = 0;
+    GameSim::Scratch scratch;
+    std::vector<uint8_t> gameFlags;     // Per-game work space of checkGames
+
+    // Shared clock
+    Uint64 now = 0;
+    Uint64 nextStep = 0, nextSecond = 0, nextEnemyMove = 0, nextItemMove = 0;
+    int timeRemaining = 0;
+    int runningCount = 0;
+
+    // One entry per game
+    std::vector<int32_t> playerTile;
+    std::vector<int32_t> lives;
+    std::vector<int32_t> score;
+    std::vector<uint8_t> over;
+    std::vector<uint8_t> won;
+    std::vector<uint32_t> invulnerableUntil;   // ms, like `now` (32 bits keep the loops narrow)
+    std::vector<uint32_t> finishTime;
+    std::vector<uint32_t> random;
+    std::vector<int32_t> itemCount;
+    std::vector<int32_t> enemyCount;
+
+    // Items and enemies: slot k of game g is at [k * gameCount + g]
+    int itemSlots = 0;
+    int enemySlots = 0;
+    std::vector<int32_t> itemTile;
+    std::vector<int32_t> itemDir;
+    std::vector<int32_t> enemyTile;
+    std::vector<int32_t> enemyDir;
+
+    void movePlayers(const int8_t* actions);
+    void moveEnemies();
+    void moveItems();
+    void collectItems();
+    void checkGames();
+};
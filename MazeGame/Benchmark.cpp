@@ -0,0 +1,2070 @@
+// Benchmark.cpp
+#include "Benchmark.h"
+#include "BitGrid.h"
+#include "BatchSim.h"
+#include "BitBfs.h"
+#include "CaveGenerator.h"
+#include "ChunkWorld.h"
+#include "ComponentLabels.h"
+#include "ContractionHierarchy.h"
+#include "CooperativePlanner.h"
+#include "DistanceOracle.h"
+#include "EllerGenerator.h"
+#include "FlowField.h"
+#include "GameConfig.h"
+#include "GameSession.h"
+#include "GameSim.h"
+#include "IncrementalPlanner.h"
+#include "JunctionGraph.h"
+#include "LevelPack.h"
+#include "LevelProgression.h"
+#include "MappedMaze.h"
+#include "Maze.h"
+#include "MazeFile.h"
+#include "MazeGenerator.h"
+#include "MazeImage.h"
+#include "MctsBot.h"
+#include "PathWorker.h"
+#include "Player.h"
+#include "TiledMazeGenerator.h"
+#include "VecEnv.h"
+#include "Visibility.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Open area with randomly scattered walls
+    BitGrid makeOpenGrid(int width, int height, int wallPercent, unsigned seed) {
+        std::mt19937 rng(seed);
+        BitGrid grid(width, height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                grid.set(x, y, static_cast<int>(rng() % 100) >= wallPercent);
+            }
+        }
+        return grid;
+    }
+
+    // Perfect maze (exactly one path between any two tiles) carved by a depth-first search.
+    // Cells sit on odd coordinates, so the grid is (2 * cells + 1) tiles wide and high.
+    BitGrid makePerfectMaze(int cellsX, int cellsY, unsigned seed) {
+        std::mt19937 rng(seed);
+        BitGrid grid(cellsX * 2 + 1, cellsY * 2 + 1);
+        std::vector<uint8_t> visited(static_cast<size_t>(cellsX) * cellsY, 0);
+        std::vector<int> stack = { 0 };
+        visited[0] = 1;
+        grid.set(1, 1, true);
+
+        const int dx[4] = { 0, 1, 0, -1 };
+        const int dy[4] = { -1, 0, 1, 0 };
+
+        while (!stack.empty()) {
+            int cell = stack.back();
+            int cx = cell % cellsX;
+            int cy = cell / cellsX;
+
+            int options[4];
+            int count = 0;
+            for (int d = 0; d < 4; ++d) {
+                int nx = cx + dx[d];
+                int ny = cy + dy[d];
+                if (nx >= 0 && nx < cellsX && ny >= 0 && ny < cellsY && !visited[ny * cellsX + nx]) {
+                    options[count++] = d;
+                }
+            }
+
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+
+            int d = options[rng() % count];
+            int nx = cx + dx[d];
+            int ny = cy + dy[d];
+            visited[ny * cellsX + nx] = 1;
+            grid.set(cx * 2 + 1 + dx[d], cy * 2 + 1 + dy[d], true);
+            grid.set(nx * 2 + 1, ny * 2 + 1, true);
+            stack.push_back(ny * cellsX + nx);
+        }
+        return grid;
+    }
+
+    void reportFlood(const char* label, const BitGrid& grid, int startX, int startY, bool withDistances) {
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        const int runs = 5;
+
+        BitBfs::Result result;
+        auto start = Clock::now();
+        for (int i = 0; i < runs; ++i) {
+            result = BitBfs::flood(grid, startX, startY, reached, withDistances ? &distances : nullptr);
+        }
+        double seconds = secondsSince(start) / runs;
+
+        printf("  %-28s %5dx%-5d %10d tiles %8d layers %8.2f ms %8.0f M tiles/s\n",
+            label, grid.width, grid.height, result.tilesReached, result.layers,
+            seconds * 1000.0, result.tilesReached / seconds / 1e6);
+        if (!withDistances) return;
+
+        // The simplest distance map there is, to compare against: a queue and a distance
+        // per tile that doubles as the "seen" flag
+        std::vector<uint16_t> plain;
+        std::vector<int> queue;
+        start = Clock::now();
+        for (int i = 0; i < runs; ++i) {
+            plain.assign(static_cast<size_t>(grid.width) * grid.height, BitBfs::UNREACHED);
+            queue.assign(1, startY * grid.width + startX);
+            plain[queue[0]] = 0;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                int tile = queue[head];
+                int x = tile % grid.width;
+                int y = tile / grid.width;
+                const int nx[4] = { x, x + 1, x, x - 1 };
+                const int ny[4] = { y - 1, y, y + 1, y };
+                for (int d = 0; d < 4; ++d) {
+                    if (!grid.get(nx[d], ny[d])) continue;
+                    int next = ny[d] * grid.width + nx[d];
+                    if (plain[next] != BitBfs::UNREACHED) continue;
+                    plain[next] = static_cast<uint16_t>(std::min<int>(plain[tile] + 1, BitBfs::MAX_DISTANCE));
+                    queue.push_back(next);
+                }
+            }
+        }
+        double plainSeconds = secondsSince(start) / runs;
+        printf("  %-28s plain queue BFS %8.2f ms (%.2fx the time), same distances: %s\n",
+            "", plainSeconds * 1000.0, plainSeconds / seconds, plain == distances ? "yes" : "NO");
+    }
+
+    void benchBfs() {
+        printf("Bit-parallel BFS\n");
+
+        BitGrid open = makeOpenGrid(4096, 4096, 0, 1);
+        reportFlood("open, reachability", open, 0, 0, false);
+        reportFlood("open, distances", open, 0, 0, true);
+
+        BitGrid scattered = makeOpenGrid(4096, 4096, 25, 2);
+        scattered.set(0, 0, true);
+        reportFlood("25% walls, reachability", scattered, 0, 0, false);
+        reportFlood("25% walls, distances", scattered, 0, 0, true);
+
+        BitGrid maze = makePerfectMaze(1024, 1024, 3);
+        reportFlood("perfect maze, reachability", maze, 1, 1, false);
+        reportFlood("perfect maze, distances", maze, 1, 1, true);
+    }
+
+    // Perfect maze with some extra walls knocked out, so it has loops
+    BitGrid makeBraidedMaze(int cellsX, int cellsY, int openPercent, unsigned seed) {
+        BitGrid grid = makePerfectMaze(cellsX, cellsY, seed);
+        std::mt19937 rng(seed + 1);
+        for (int y = 1; y < grid.height - 1; ++y) {
+            for (int x = 1; x < grid.width - 1; ++x) {
+                if ((x + y) % 2 == 1 && static_cast<int>(rng() % 100) < openPercent) grid.set(x, y, true);
+            }
+        }
+        return grid;
+    }
+
+    void randomWalkableTile(const BitGrid& grid, std::mt19937& rng, int& x, int& y) {
+        do {
+            x = static_cast<int>(rng() % grid.width);
+            y = static_cast<int>(rng() % grid.height);
+        } while (!grid.get(x, y));
+    }
+
+    int countWalkable(const BitGrid& grid) {
+        int count = 0;
+        for (uint64_t word : grid.words) count += countBits(word);
+        return count;
+    }
+
+    // Steps from a to b by a plain queue BFS over the tiles that stops once b is reached,
+    // or -1 if b can't be reached. `seen` must be all zero and is left that way.
+    int plainBfsDistance(const BitGrid& grid, int ax, int ay, int bx, int by,
+        std::vector<int>& queue, std::vector<uint16_t>& seen) {
+        const int dx[4] = { 0, 1, 0, -1 };
+        const int dy[4] = { -1, 0, 1, 0 };
+        const int goal = by * grid.width + bx;
+        queue.clear();
+        queue.push_back(ay * grid.width + ax);
+        seen[queue[0]] = 1;
+        int result = -1;
+        for (size_t head = 0; head < queue.size() && result < 0; ++head) {
+            int tile = queue[head];
+            if (tile == goal) result = seen[tile] - 1;
+            int x = tile % grid.width;
+            int y = tile / grid.width;
+            for (int d = 0; d < 4; ++d) {
+                int nx = x + dx[d];
+                int ny = y + dy[d];
+                if (!grid.get(nx, ny)) continue;
+                int next = ny * grid.width + nx;
+                if (seen[next]) continue;
+                seen[next] = static_cast<uint16_t>(std::min<int>(seen[tile] + 1, 0xFFFF));
+                queue.push_back(next);
+            }
+        }
+        for (int tile : queue) seen[tile] = 0;
+        return result;
+    }
+
+    void reportJunctionGraph(const char* label, BitGrid grid) {
+        JunctionGraph graph;
+        auto start = Clock::now();
+        graph.build(grid);
+        double buildMs = secondsSince(start) * 1000.0;
+
+        // Distance queries, checked against a plain flood and timed against a plain BFS
+        // that stops at the target (only for the first few pairs of each start; it is slow)
+        std::mt19937 rng(7);
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        std::vector<int> bfsQueue;
+        std::vector<uint16_t> bfsSeen(static_cast<size_t>(grid.width) * grid.height, 0);
+        int mismatches = 0;
+        int queries = 0;
+        int bfsQueries = 0;
+        double querySeconds = 0.0;
+        double graphSampleSeconds = 0.0;
+        double bfsSeconds = 0.0;
+        for (int i = 0; i < 20; ++i) {
+            int ax, ay;
+            randomWalkableTile(grid, rng, ax, ay);
+            BitBfs::flood(grid, ax, ay, reached, &distances);
+
+            for (int j = 0; j < 50; ++j) {
+                int bx, by;
+                randomWalkableTile(grid, rng, bx, by);
+                auto queryStart = Clock::now();
+                int dist = graph.distance(ax, ay, bx, by);
+                double seconds = secondsSince(queryStart);
+                querySeconds += seconds;
+                ++queries;
+
+                // Flood distances stop counting at MAX_DISTANCE
+                uint16_t expected = distances[static_cast<size_t>(by) * grid.width + bx];
+                if (expected == BitBfs::MAX_DISTANCE) continue;
+                if (dist != (expected == BitBfs::UNREACHED ? -1 : expected)) ++mismatches;
+
+                if (j < 5) {
+                    queryStart = Clock::now();
+                    int bfsDist = plainBfsDistance(grid, ax, ay, bx, by, bfsQueue, bfsSeen);
+                    bfsSeconds += secondsSince(queryStart);
+                    graphSampleSeconds += seconds;
+                    ++bfsQueries;
+                    if (bfsDist != dist) ++mismatches;
+                }
+            }
+        }
+
+        int walkable = countWalkable(grid);
+        printf("  %-22s %5dx%-5d %9d tiles -> %8d nodes %8d edges (%5.1f%% fewer nodes), build %8.2f ms\n",
+            label, grid.width, grid.height, walkable, graph.getNodeCount(), graph.getEdgeCount(),
+            100.0 * (walkable - graph.getNodeCount()) / walkable, buildMs);
+        printf("  %-22s query %8.3f ms avg (%8.3f ms vs %8.3f ms for a plain BFS on the same %d pairs, %.2fx), "
+            "%d/%d mismatches vs BFS\n",
+            "", querySeconds * 1e3 / queries, graphSampleSeconds * 1e3 / bfsQueries, bfsSeconds * 1e3 / bfsQueries,
+            bfsQueries, bfsSeconds / graphSampleSeconds, mismatches, queries + bfsQueries);
+
+        // Random single-tile edits
+        const int edits = 1000;
+        start = Clock::now();
+        for (int i = 0; i < edits; ++i) {
+            int x = 1 + static_cast<int>(rng() % (grid.width - 2));
+            int y = 1 + static_cast<int>(rng() % (grid.height - 2));
+            grid.set(x, y, !grid.get(x, y));
+            graph.updateTile(grid, x, y);
+        }
+        double editUs = secondsSince(start) * 1e6 / edits;
+
+        printf("  %-22s tile edit %6.1f us avg\n", "", editUs);
+    }
+
+    void benchJunction() {
+        printf("Junction graph (corridors merged into edges)\n");
+        reportJunctionGraph("current layout", Maze::getWalkGrid());
+        reportJunctionGraph("perfect maze", makePerfectMaze(512, 512, 4));
+        reportJunctionGraph("maze, 10% loops", makeBraidedMaze(512, 512, 10, 5));
+        reportJunctionGraph("25% walls", makeOpenGrid(1024, 1024, 25, 6));
+    }
+
+    void reportLandmarks(const char* label, const BitGrid& grid) {
+        DistanceOracle oracle(8);
+        auto start = Clock::now();
+        oracle.build(grid);
+        double buildMs = secondsSince(start) * 1000.0;
+
+        std::mt19937 rng(11);
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        std::vector<DistanceOracle::Query> queries;
+        std::vector<int> expected;
+        for (int i = 0; i < 10; ++i) {
+            int ax, ay;
+            randomWalkableTile(grid, rng, ax, ay);
+            BitBfs::flood(grid, ax, ay, reached, &distances);
+            for (int j = 0; j < 20; ++j) {
+                int bx, by;
+                randomWalkableTile(grid, rng, bx, by);
+                uint16_t d = distances[static_cast<size_t>(by) * grid.width + bx];
+                if (d == BitBfs::MAX_DISTANCE) continue;
+                queries.push_back({ ax, ay, bx, by });
+                expected.push_back(d == BitBfs::UNREACHED ? -1 : d);
+            }
+        }
+
+        // Same A* search with and without the landmark bounds
+        int mismatches = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const DistanceOracle::Query& q = queries[i];
+            if (oracle.distance(q.ax, q.ay, q.bx, q.by) != expected[i]) ++mismatches;
+        }
+        double altUs = secondsSince(start) * 1e6 / queries.size();
+
+        DistanceOracle noLandmarks(0);
+        noLandmarks.build(grid);
+        start = Clock::now();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const DistanceOracle::Query& q = queries[i];
+            if (noLandmarks.distance(q.ax, q.ay, q.bx, q.by) != expected[i]) ++mismatches;
+        }
+        double plainUs = secondsSince(start) * 1e6 / queries.size();
+
+        // Batch of random pairs spread over all cores
+        std::vector<DistanceOracle::Query> batch(500);
+        for (DistanceOracle::Query& q : batch) {
+            randomWalkableTile(grid, rng, q.ax, q.ay);
+            randomWalkableTile(grid, rng, q.bx, q.by);
+        }
+        std::vector<int> results;
+        start = Clock::now();
+        oracle.distances(batch, results);
+        double batchSeconds = secondsSince(start);
+
+        printf("  %-22s %5dx%-5d build %8.2f ms, %6.1f MB, query %8.1f us (%8.1f us without landmarks), "
+            "%d/%zu mismatches, batch %8.0f queries/s\n",
+            label, grid.width, grid.height, buildMs, oracle.getMemoryBytes() / 1048576.0, altUs, plainUs,
+            mismatches, queries.size() * 2, batch.size() / batchSeconds);
+    }
+
+    // The walls change many times in a row, each time with a query, like a player editing the
+    // maze with the hint on. Only the newest layout should get built; the time until its tables
+    // are ready is compared with a single build.
+    void reportRebuilds(const char* label, const BitGrid& grid, int changes) {
+        DistanceOracle single(8);
+        auto start = Clock::now();
+        single.build(grid);
+        double buildMs = secondsSince(start) * 1000.0;
+
+        DistanceOracle oracle(8);
+        BitGrid edited = grid;
+        int x = 0, y = 0;
+        std::mt19937 rng(13);
+        start = Clock::now();
+        for (int i = 0; i < changes; ++i) {
+            randomWalkableTile(grid, rng, x, y);
+            edited.set(x, y, i % 2 == 0);
+            oracle.rebuildAsync(edited);
+            oracle.distance(x, y, x, y);
+        }
+        double changesMs = secondsSince(start) * 1000.0;
+        while (!oracle.hasLandmarks()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        double readyMs = secondsSince(start) * 1000.0;
+
+        printf("  %-22s %d changes in %8.2f ms, newest tables ready after %8.2f ms (one build %8.2f ms)\n",
+            label, changes, changesMs, readyMs, buildMs);
+    }
+
+    void benchLandmarks() {
+        printf("Landmark distance oracle (A* with ALT bounds, %u threads)\n", std::thread::hardware_concurrency());
+        reportLandmarks("current layout", Maze::getWalkGrid());
+        reportLandmarks("perfect maze", makePerfectMaze(512, 512, 8));
+        reportLandmarks("maze, 10% loops", makeBraidedMaze(512, 512, 10, 9));
+        reportLandmarks("25% walls", makeOpenGrid(1024, 1024, 25, 10));
+        reportLandmarks("open", makeOpenGrid(1024, 1024, 0, 12));
+        reportRebuilds("maze, 10% loops", makeBraidedMaze(512, 512, 10, 9), 50);
+    }
+
+    void reportHierarchy(const char* label, const BitGrid& grid, bool checkThreads) {
+        ContractionHierarchy hierarchy;
+        auto start = Clock::now();
+        hierarchy.build(grid);
+        double buildSeconds = secondsSince(start);
+
+        printf("  %-22s %5dx%-5d %8d nodes %9d arcs (%8d shortcuts), build %8.2f s\n",
+            label, grid.width, grid.height, hierarchy.getNodeCount(), hierarchy.getArcCount(),
+            hierarchy.getShortcutCount(), buildSeconds);
+
+        // The result must not depend on how many threads built it
+        const char* sameResult = "not checked";
+        if (checkThreads) {
+            ContractionHierarchy single;
+            single.build(grid, 1);
+            ContractionHierarchy several;
+            several.build(grid, 4);
+            sameResult = single.sameAs(hierarchy) && several.sameAs(hierarchy) ? "yes" : "NO";
+        }
+
+        // Round trip through a sidecar file
+        const char* path = "benchmark_hierarchy.mzch";
+        bool saved = hierarchy.save(path);
+        ContractionHierarchy loaded;
+        start = Clock::now();
+        bool reloaded = loaded.load(path, grid) && loaded.sameAs(hierarchy);
+        double loadMs = secondsSince(start) * 1000.0;
+
+        // The way mapped mazes load it: no tile map, tiles are looked up when a query needs them
+        ContractionHierarchy unmapped;
+        start = Clock::now();
+        bool unmappedLoaded = unmapped.load(path, grid.width, grid.height, hashLayout(grid),
+            [&grid](int x, int y) { return grid.get(x, y); });
+        double unmappedLoadMs = secondsSince(start) * 1000.0;
+
+        // A cut-off sidecar must be turned down before its counts are used to allocate anything
+        bool damagedRefused = true;
+        {
+            std::vector<char> bytes;
+            {
+                std::ifstream in(path, std::ios::binary | std::ios::ate);
+                bytes.resize(static_cast<size_t>(in.tellg()));
+                in.seekg(0);
+                in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            }
+            for (size_t keep : { bytes.size() / 2, size_t(48) }) {
+                {
+                    std::ofstream out(path, std::ios::binary);
+                    out.write(bytes.data(), static_cast<std::streamsize>(keep));
+                }
+                ContractionHierarchy damaged;
+                damagedRefused = damagedRefused && !damaged.load(path, grid);
+            }
+        }
+        std::remove(path);
+
+        // Distance queries, checked against a plain flood
+        std::mt19937 rng(13);
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        int mismatches = 0;
+        int unmappedMismatches = 0;
+        int queries = 0;
+        double querySeconds = 0.0;
+        double unmappedSeconds = 0.0;
+        for (int i = 0; i < 20; ++i) {
+            int ax, ay;
+            randomWalkableTile(grid, rng, ax, ay);
+            BitBfs::flood(grid, ax, ay, reached, &distances);
+
+            for (int j = 0; j < 100; ++j) {
+                int bx, by;
+                randomWalkableTile(grid, rng, bx, by);
+                auto queryStart = Clock::now();
+                int dist = loaded.distance(ax, ay, bx, by);
+                querySeconds += secondsSince(queryStart);
+                queryStart = Clock::now();
+                int unmappedDist = unmapped.distance(ax, ay, bx, by);
+                unmappedSeconds += secondsSince(queryStart);
+                ++queries;
+
+                uint16_t expected = distances[static_cast<size_t>(by) * grid.width + bx];
+                if (expected == BitBfs::MAX_DISTANCE) continue;
+                if (dist != (expected == BitBfs::UNREACHED ? -1 : expected)) ++mismatches;
+                if (unmappedDist != (expected == BitBfs::UNREACHED ? -1 : expected)) ++unmappedMismatches;
+            }
+        }
+
+        printf("  %-22s query %8.2f us avg, %d/%d mismatches vs BFS, sidecar %s (load %.1f ms), same for 1/4 threads: %s\n",
+            "", querySeconds * 1e6 / queries, mismatches, queries,
+            saved && reloaded ? "ok" : "FAILED", loadMs, sameResult);
+        printf("  %-22s without tile map: load %s in %.1f ms, query %8.2f us avg, %d/%d mismatches; damaged sidecar refused: %s\n",
+            "", unmappedLoaded ? "ok" : "FAILED", unmappedLoadMs, unmappedSeconds * 1e6 / queries, unmappedMismatches,
+            queries, damagedRefused ? "yes" : "NO");
+    }
+
+    void benchHierarchy() {
+        printf("Contraction hierarchy (%u threads)\n", std::thread::hardware_concurrency());
+        reportHierarchy("current layout", Maze::getWalkGrid(), true);
+        reportHierarchy("perfect maze", makePerfectMaze(512, 512, 14), true);
+        reportHierarchy("maze, 10% loops", makeBraidedMaze(512, 512, 10, 15), true);
+        reportHierarchy("25% walls", makeOpenGrid(256, 256, 25, 16), true);
+        reportHierarchy("perfect maze, 16M", makePerfectMaze(2048, 2048, 17), false);
+    }
+
+    // Agents sharing a tile, plus pairs that walked through each other
+    int countConflicts(const BitGrid& grid, const std::vector<CooperativePlanner::Agent>& before,
+        const std::vector<CooperativePlanner::Agent>& after, std::vector<int>& tileAgent) {
+        int conflicts = 0;
+        for (size_t i = 0; i < after.size(); ++i) {
+            int& slot = tileAgent[static_cast<size_t>(after[i].y) * grid.width + after[i].x];
+            if (slot >= 0) ++conflicts;
+            slot = static_cast<int>(i);
+        }
+        for (size_t i = 0; i < before.size(); ++i) {
+            int other = tileAgent[static_cast<size_t>(before[i].y) * grid.width + before[i].x];
+            if (other > static_cast<int>(i) && before[other].x == after[i].x && before[other].y == after[i].y &&
+                (after[i].x != before[i].x || after[i].y != before[i].y)) {
+                ++conflicts;
+            }
+        }
+        for (const CooperativePlanner::Agent& agent : after) {
+            tileAgent[static_cast<size_t>(agent.y) * grid.width + agent.x] = -1;
+        }
+        return conflicts;
+    }
+
+    void reportCooperative(const char* label, const BitGrid& grid, int agentCount, int ticks, int window, int maxPlansPerTick) {
+        std::mt19937 rng(21);
+        int targetX, targetY;
+        randomWalkableTile(grid, rng, targetX, targetY);
+
+        // Start every agent on its own tile
+        std::vector<CooperativePlanner::Agent> start;
+        std::vector<int> tileAgent(static_cast<size_t>(grid.width) * grid.height, -1);
+        while (static_cast<int>(start.size()) < agentCount) {
+            int x, y;
+            randomWalkableTile(grid, rng, x, y);
+            int& slot = tileAgent[static_cast<size_t>(y) * grid.width + x];
+            if (slot >= 0) continue;
+            slot = 0;
+            start.push_back({ x, y });
+        }
+        std::fill(tileAgent.begin(), tileAgent.end(), -1);
+
+        CooperativePlanner planner(window, maxPlansPerTick);
+        planner.setTarget(grid, targetX, targetY);
+
+        std::vector<CooperativePlanner::Agent> agents = start;
+        std::vector<CooperativePlanner::Agent> next;
+        double totalSeconds = 0.0;
+        double worstSeconds = 0.0;
+        int conflicts = 0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            auto stepStart = Clock::now();
+            planner.step(agents, next);
+            double seconds = secondsSince(stepStart);
+            totalSeconds += seconds;
+            worstSeconds = std::max(worstSeconds, seconds);
+            conflicts += countConflicts(grid, agents, next, tileAgent);
+            agents.swap(next);
+        }
+
+        // The same agents each stepping straight down the distance map, ignoring each other
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        BitBfs::flood(grid, targetX, targetY, reached, &distances);
+        const int dx[4] = { 0, 1, 0, -1 };
+        const int dy[4] = { -1, 0, 1, 0 };
+        std::vector<CooperativePlanner::Agent> greedy = start;
+        int greedyConflicts = 0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            next = greedy;
+            for (CooperativePlanner::Agent& agent : next) {
+                for (int d = 0; d < 4; ++d) {
+                    int nx = agent.x + dx[d];
+                    int ny = agent.y + dy[d];
+                    if (grid.get(nx, ny) && distances[static_cast<size_t>(ny) * grid.width + nx] <
+                        distances[static_cast<size_t>(agent.y) * grid.width + agent.x]) {
+                        agent = { nx, ny };
+                        break;
+                    }
+                }
+            }
+            greedyConflicts += countConflicts(grid, greedy, next, tileAgent);
+            greedy.swap(next);
+        }
+
+        // How far the crowd still has to go, on average
+        double remaining = 0.0;
+        for (const CooperativePlanner::Agent& agent : agents) {
+            remaining += distances[static_cast<size_t>(agent.y) * grid.width + agent.x];
+        }
+        double startRemaining = 0.0;
+        for (const CooperativePlanner::Agent& agent : start) {
+            startRemaining += distances[static_cast<size_t>(agent.y) * grid.width + agent.x];
+        }
+
+        printf("  %-22s %5dx%-5d %6d agents: %6.2f ms/tick avg, %6.2f ms worst, %d conflicts (%d when ignoring each other), "
+            "avg distance to target %.1f -> %.1f\n",
+            label, grid.width, grid.height, agentCount, totalSeconds * 1000.0 / ticks, worstSeconds * 1000.0,
+            conflicts, greedyConflicts, startRemaining / agentCount, remaining / agentCount);
+    }
+
+    void benchCooperative() {
+        // The game's few enemies look ENEMY_PLAN_WINDOW ticks ahead with no limit. A crowd of
+        // 10000 looks 4 ticks ahead and at most 1000 of them search per tick, which keeps a
+        // tick within 4 ms; the ones left over follow their route or wait a tick.
+        printf("Cooperative pathfinding (space-time reservations)\n");
+        printf("  %d tick window, no search limit:\n", GameConfig::ENEMY_PLAN_WINDOW);
+        reportCooperative("current layout", Maze::getWalkGrid(), 20, 40, GameConfig::ENEMY_PLAN_WINDOW, 0);
+        printf("  4 tick window, at most 1000 searches per tick:\n");
+        reportCooperative("maze, 10% loops", makeBraidedMaze(256, 256, 10, 22), 10000, 40, 4, 1000);
+        reportCooperative("25% walls", makeOpenGrid(512, 512, 25, 23), 10000, 40, 4, 1000);
+        reportCooperative("open", makeOpenGrid(256, 256, 0, 24), 10000, 40, 4, 1000);
+        printf("  8 tick window, at most 1000 searches per tick (over budget, for comparison):\n");
+        reportCooperative("maze, 10% loops", makeBraidedMaze(256, 256, 10, 22), 10000, 40, 8, 1000);
+    }
+
+    // Random single-tile edits, repaired lazily (only as far as the chasers' queries need)
+    // and eagerly (whole tree), compared against searching the whole maze again
+    void reportIncremental(const char* label, BitGrid grid, int edits) {
+        std::mt19937 rng(31);
+        int targetX, targetY;
+        randomWalkableTile(grid, rng, targetX, targetY);
+
+        IncrementalPlanner lazy;
+        IncrementalPlanner eager;
+        auto start = Clock::now();
+        lazy.setTarget(grid, targetX, targetY);
+        double rebuildMs = secondsSince(start) * 1000.0;
+        eager.setTarget(grid, targetX, targetY);
+
+        std::vector<std::pair<int, int>> chasers(100);
+        for (auto& chaser : chasers) {
+            randomWalkableTile(grid, rng, chaser.first, chaser.second);
+        }
+
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        std::vector<long long> lazyWork;
+        std::vector<long long> eagerWork;
+        double lazySeconds = 0.0;
+        double eagerSeconds = 0.0;
+        int mismatches = 0;
+        int checked = 0;
+
+        for (int i = 0; i < edits; ++i) {
+            int x = 1 + static_cast<int>(rng() % (grid.width - 2));
+            int y = 1 + static_cast<int>(rng() % (grid.height - 2));
+            if (x == targetX && y == targetY) continue;
+            grid.set(x, y, !grid.get(x, y));
+
+            long long before = lazy.getRepairCount();
+            start = Clock::now();
+            lazy.updateTile(grid, x, y);
+            Direction dir;
+            for (const auto& chaser : chasers) {
+                lazy.nextStep(chaser.first, chaser.second, dir);
+            }
+            lazySeconds += secondsSince(start);
+            lazyWork.push_back(lazy.getRepairCount() - before);
+
+            before = eager.getRepairCount();
+            start = Clock::now();
+            eager.updateTile(grid, x, y);
+            eager.repairAll();
+            eagerSeconds += secondsSince(start);
+            eagerWork.push_back(eager.getRepairCount() - before);
+
+            // Check both against a fresh flood now and then
+            if (i % (edits / 10) != 0) continue;
+            BitBfs::flood(grid, targetX, targetY, reached, &distances);
+            for (int j = 0; j < 1000; ++j) {
+                int cx, cy;
+                if (j < static_cast<int>(chasers.size())) {
+                    cx = chasers[j].first;
+                    cy = chasers[j].second;
+                }
+                else {
+                    cx = static_cast<int>(rng() % grid.width);
+                    cy = static_cast<int>(rng() % grid.height);
+                }
+                uint16_t d = distances[static_cast<size_t>(cy) * grid.width + cx];
+                if (d == BitBfs::MAX_DISTANCE) continue;
+                int expected = d == BitBfs::UNREACHED ? -1 : d;
+                if (lazy.distance(cx, cy) != expected) ++mismatches;
+                if (eager.distance(cx, cy) != expected) ++mismatches;
+                checked += 2;
+            }
+        }
+
+        auto median = [](std::vector<long long> values) {
+            if (values.empty()) return 0LL;
+            std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+            return values[values.size() / 2];
+        };
+        auto mean = [](const std::vector<long long>& values) {
+            long long sum = 0;
+            for (long long v : values) sum += v;
+            return values.empty() ? 0.0 : static_cast<double>(sum) / values.size();
+        };
+
+        int done = static_cast<int>(lazyWork.size());
+        printf("  %-22s %5dx%-5d full search %8.2f ms; per edit: lazy %8.1f us (tiles fixed: median %lld, avg %.0f), "
+            "eager %8.1f us (median %lld, avg %.0f); %d/%d mismatches vs BFS\n",
+            label, grid.width, grid.height, rebuildMs,
+            lazySeconds * 1e6 / done, median(lazyWork), mean(lazyWork),
+            eagerSeconds * 1e6 / done, median(eagerWork), mean(eagerWork), mismatches, checked);
+    }
+
+    void benchIncremental() {
+        printf("Incremental replanning (LPA*, random single-tile edits, 100 chasers)\n");
+        reportIncremental("current layout", Maze::getWalkGrid(), 1000);
+        reportIncremental("maze, 10% loops", makeBraidedMaze(1023, 1023, 10, 32), 1000);
+        reportIncremental("25% walls", makeOpenGrid(2048, 2048, 25, 33), 1000);
+        reportIncremental("open", makeOpenGrid(2048, 2048, 0, 34), 1000);
+    }
+
+    // Every viewer checks whether it sees one target, with rays and with the table
+    void reportVisibility(const char* label, const BitGrid& grid, int viewerCount) {
+        const int range = VisibilityTable::MAX_RANGE;
+        VisibilityTable table;
+        auto start = Clock::now();
+        table.build(grid, range);
+        double buildMs = secondsSince(start) * 1000.0;
+
+        // Each target gets its own crowd of viewers close by, like enemies hunting the player
+        std::mt19937 rng(41);
+        std::vector<Visibility::Point> targets(100);
+        std::vector<std::vector<Visibility::Point>> crowds(targets.size());
+        for (size_t t = 0; t < targets.size(); ++t) {
+            randomWalkableTile(grid, rng, targets[t].x, targets[t].y);
+            crowds[t].assign(viewerCount / targets.size() + 1, targets[t]);
+            for (auto& viewer : crowds[t]) {
+                for (int tries = 0; tries < 20; ++tries) {
+                    int x = targets[t].x + static_cast<int>(rng() % (2 * range + 1)) - range;
+                    int y = targets[t].y + static_cast<int>(rng() % (2 * range + 1)) - range;
+                    if (grid.get(x, y)) {
+                        viewer = { x, y };
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::vector<uint8_t> bySight;
+        std::vector<uint8_t> byTable;
+        double raySeconds = 0.0;
+        double tableSeconds = 0.0;
+        double checks = 0.0;
+        int mismatches = 0;
+        int visible = 0;
+        for (const int repeat : { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }) {
+            for (size_t t = 0; t < targets.size(); ++t) {
+                start = Clock::now();
+                Visibility::canSeeTarget(grid, crowds[t], targets[t].x, targets[t].y, range, bySight);
+                raySeconds += secondsSince(start);
+
+                start = Clock::now();
+                table.canSeeTarget(crowds[t], targets[t].x, targets[t].y, byTable);
+                tableSeconds += secondsSince(start);
+
+                checks += crowds[t].size();
+                if (repeat > 0) continue;
+                for (size_t i = 0; i < crowds[t].size(); ++i) {
+                    if (bySight[i] != byTable[i]) ++mismatches;
+                    visible += bySight[i];
+                }
+            }
+        }
+
+        // A sees B exactly when B sees A
+        int asymmetric = 0;
+        for (int i = 0; i < 10000; ++i) {
+            int ax, ay, bx, by;
+            randomWalkableTile(grid, rng, ax, ay);
+            randomWalkableTile(grid, rng, bx, by);
+            if (Visibility::lineOfSight(grid, ax, ay, bx, by) != Visibility::lineOfSight(grid, bx, by, ax, ay)) ++asymmetric;
+        }
+
+        printf("  %-22s %5dx%-5d table build %8.2f ms, %6.1f MB; rays %6.1f ns/check, table %6.1f ns/check, "
+            "%.0f%% visible, %d mismatches, %d asymmetric\n",
+            label, grid.width, grid.height, buildMs, table.getMemoryBytes() / 1048576.0,
+            raySeconds * 1e9 / checks, tableSeconds * 1e9 / checks, visible * 1000.0 / checks,
+            mismatches, asymmetric);
+    }
+
+    void benchVisibility() {
+        printf("Line of sight (Bresenham rays vs precomputed table, range %d)\n", VisibilityTable::MAX_RANGE);
+        reportVisibility("current layout", Maze::getWalkGrid(), 20);
+        reportVisibility("maze, 10% loops", makeBraidedMaze(512, 512, 10, 42), 10000);
+        reportVisibility("25% walls", makeOpenGrid(1024, 1024, 25, 43), 10000);
+        reportVisibility("open", makeOpenGrid(1024, 1024, 0, 44), 10000);
+    }
+
+    void reportComponents(const char* label, const BitGrid& grid, bool checkFlood) {
+        ComponentLabels labels;
+        auto start = Clock::now();
+        labels.build(grid);
+        double buildMs = secondsSince(start) * 1000.0;
+
+        // Labels must not depend on how many threads made them
+        std::mt19937 rng(51);
+        ComponentLabels single;
+        single.build(grid, 1);
+        ComponentLabels several;
+        several.build(grid, 4);
+        int threadMismatches = 0;
+        for (int i = 0; i < 100000; ++i) {
+            int x = static_cast<int>(rng() % grid.width);
+            int y = static_cast<int>(rng() % grid.height);
+            int expected = labels.componentAt(x, y);
+            if (single.componentAt(x, y) != expected || several.componentAt(x, y) != expected) ++threadMismatches;
+        }
+
+        // Same component exactly when a flood from one tile reaches the other
+        int floodMismatches = 0;
+        if (checkFlood) {
+            BitGrid reached;
+            for (int i = 0; i < 10; ++i) {
+                int ax, ay;
+                randomWalkableTile(grid, rng, ax, ay);
+                BitBfs::flood(grid, ax, ay, reached);
+                int component = labels.componentAt(ax, ay);
+                for (int j = 0; j < 10000; ++j) {
+                    int x = static_cast<int>(rng() % grid.width);
+                    int y = static_cast<int>(rng() % grid.height);
+                    if ((labels.componentAt(x, y) == component) != reached.get(x, y)) ++floodMismatches;
+                }
+            }
+        }
+
+        printf("  %-22s %5dx%-5d %9d runs %9d components, build %8.1f ms; %d mismatches across thread counts, "
+            "%d mismatches vs flood%s\n",
+            label, grid.width, grid.height, labels.getRunCount(), labels.getComponentCount(), buildMs,
+            threadMismatches, floodMismatches, checkFlood ? "" : " (not checked)");
+    }
+
+    // Maze::isReachable on the current layout after random wall edits, against a flood from
+    // the player's tile after each edit
+    void checkMazeReachable(int edits) {
+        const BitGrid& grid = Maze::getWalkGrid();
+        std::vector<std::vector<int>> layout(grid.height, std::vector<int>(grid.width, 0));
+        std::vector<int> paths;
+        for (int y = 0; y < grid.height; ++y) {
+            for (int x = 0; x < grid.width; ++x) {
+                layout[y][x] = grid.get(x, y) ? 1 : 0;
+                if (grid.get(x, y)) paths.push_back(y * grid.width + x);
+            }
+        }
+        if (paths.size() < 2) return;
+        layout[paths.front() / grid.width][paths.front() % grid.width] = 3;
+        layout[paths.back() / grid.width][paths.back() % grid.width] = 4;
+
+        GameSession session(1);
+        session.start(layout);
+        GameSession::Use use(session);
+        std::mt19937 rng(57);
+        BitGrid reached;
+        int mismatches = 0;
+        for (int edit = 0; edit < edits; ++edit) {
+            int x = static_cast<int>(rng() % grid.width);
+            int y = static_cast<int>(rng() % grid.height);
+            if (x == Player::getX() && y == Player::getY()) continue;
+            Maze::setWalkable(x, y, !Maze::isWalkable(x, y));
+
+            const BitGrid& walk = Maze::getWalkGrid();
+            BitBfs::flood(walk, Player::getX(), Player::getY(), reached);
+            for (int ty = 0; ty < walk.height; ++ty) {
+                for (int tx = 0; tx < walk.width; ++tx) {
+                    if (Maze::isReachable(tx, ty) != reached.get(tx, ty)) ++mismatches;
+                }
+            }
+        }
+        printf("  Maze::isReachable after %d wall edits on the current layout: %d mismatches vs flood\n", edits, mismatches);
+    }
+
+    void benchComponents() {
+        printf("Connected components (union-find over row runs, %u threads)\n", std::thread::hardware_concurrency());
+        reportComponents("current layout", Maze::getWalkGrid(), true);
+        reportComponents("perfect maze", makePerfectMaze(1024, 1024, 52), true);
+        reportComponents("40% walls", makeOpenGrid(2048, 2048, 40, 53), true);
+        reportComponents("perfect maze, 16k", makePerfectMaze(8191, 8191, 54), false);
+        reportComponents("40% walls, 16k", makeOpenGrid(16384, 16384, 40, 55), false);
+        reportComponents("25% walls, 16k", makeOpenGrid(16384, 16384, 25, 56), false);
+        checkMazeReachable(200);
+    }
+
+    // A player walking through the maze at one step every few frames, with a hint
+    // path requested after every step. Measures how long a frame spends on the hint.
+    void reportHint(const char* label, const BitGrid& grid, int frames, int framesPerStep) {
+        auto walk = std::make_shared<const BitGrid>(grid);
+        std::mt19937 rng(61);
+        int px, py, gx, gy;
+        randomWalkableTile(grid, rng, px, py);
+        randomWalkableTile(grid, rng, gx, gy);
+
+        PathWorker worker;
+        std::vector<std::pair<int, int>> path;
+        const int dx[4] = { 0, 1, 0, -1 };
+        const int dy[4] = { -1, 0, 1, 0 };
+
+        double worstFrameUs = 0.0;
+        double totalFrameUs = 0.0;
+        int requests = 0;
+        int received = 0;
+        auto requestTime = Clock::now();
+        double latencyMs = 0.0;
+
+        auto frame = [&](bool move) {
+            auto start = Clock::now();
+            if (move) {
+                // Random step, preferring not to stand still
+                for (int tries = 0; tries < 8; ++tries) {
+                    int d = static_cast<int>(rng() % 4);
+                    if (grid.get(px + dx[d], py + dy[d])) {
+                        px += dx[d];
+                        py += dy[d];
+                        break;
+                    }
+                }
+                worker.request(walk, px, py, gx, gy);
+                requestTime = Clock::now();
+                ++requests;
+            }
+            bool got = worker.takeResult(path);
+            double us = secondsSince(start) * 1e6;
+            worstFrameUs = std::max(worstFrameUs, us);
+            totalFrameUs += us;
+            if (got) {
+                ++received;
+                latencyMs = secondsSince(requestTime) * 1000.0;
+            }
+            return got;
+        };
+
+        for (int i = 0; i < frames; ++i) {
+            frame(i % framesPerStep == 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        }
+
+        // The player stops; the last request must still come through
+        int waitFrames = 0;
+        while (!frame(false) && waitFrames < 1000) {
+            ++waitFrames;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bool valid = !path.empty() && path.front() == std::make_pair(px, py) && path.back() == std::make_pair(gx, gy);
+
+        printf("  %-22s %5dx%-5d frame cost %6.1f us avg, %6.1f us worst; %d requests, %d paths shown, "
+            "%d discarded; last path %zu tiles %s, arrived %.1f ms after the request\n",
+            label, grid.width, grid.height, totalFrameUs / (frames + waitFrames + 1), worstFrameUs,
+            requests, received, worker.getDiscardedCount(), path.size(), valid ? "ok" : "WRONG", latencyMs);
+    }
+
+    void benchHint() {
+        printf("Hint path on a worker thread (16 ms frames, a step every 4 frames)\n");
+        reportHint("current layout", Maze::getWalkGrid(), 120, 4);
+        reportHint("maze, 10% loops", makeBraidedMaze(512, 512, 10, 62), 120, 4);
+        reportHint("maze, 10% loops", makeBraidedMaze(1024, 1024, 10, 63), 120, 4);
+        reportHint("25% walls", makeOpenGrid(2048, 2048, 25, 64), 120, 4);
+    }
+
+    // Level on `grid` with the player at the first walkable tile and the goal as far away as possible
+    GameSim::Level makeSimLevel(const BitGrid& grid) {
+        int startX = -1, startY = -1;
+        for (int y = 0; y < grid.height && startX < 0; ++y) {
+            for (int x = 0; x < grid.width; ++x) {
+                if (grid.get(x, y)) {
+                    startX = x;
+                    startY = y;
+                    break;
+                }
+            }
+        }
+
+        GameSim::Rules rules;
+        GameSim::Level level = GameSim::makeLevel(grid, startX, startY, -1, -1, rules);
+        std::vector<int> distance, queue;
+        GameSim::distancesFrom(level, startY * level.width + startX, distance, queue);
+        int goal = static_cast<int>(std::max_element(distance.begin(), distance.end()) - distance.begin());
+        return GameSim::makeLevel(grid, startX, startY, goal % level.width, goal / level.width, rules);
+    }
+
+    void reportMcts(const char* label, const BitGrid& grid, Uint64 moveTimeMs) {
+        GameSim::Level level = makeSimLevel(grid);
+        GameSim::State start = GameSim::newGame(level, 1);
+        printf("  %-18s %4d x %-4d goal %d steps away\n", label, grid.width, grid.height,
+            level.goalDistance[level.playerY * level.width + level.playerX]);
+
+        // Cloning: copy the state into a ring of slots, changing one field so nothing is skipped
+        const int CLONES = 2000000;
+        std::vector<GameSim::State> slots(64);
+        auto cloneStart = Clock::now();
+        for (int i = 0; i < CLONES; ++i) {
+            GameSim::State& slot = slots[i & 63];
+            slot = start;
+            slot.random += i;
+        }
+        double cloneNs = secondsSince(cloneStart) * 1e9 / CLONES;
+        uint32_t check = 0;
+        for (const GameSim::State& slot : slots) {
+            check += slot.random;
+        }
+
+        // Simulation: random moves until the game ends, over and over
+        GameSim::Scratch scratch;
+        long long steps = 0;
+        auto stepStart = Clock::now();
+        for (uint32_t game = 1; secondsSince(stepStart) < 0.5; ++game) {
+            GameSim::State state = GameSim::newGame(level, game);
+            while (!state.over) {
+                GameSim::step(level, state, static_cast<int>(GameSim::nextRandom(state) % 4), scratch);
+                ++steps;
+            }
+        }
+        double stepNs = secondsSince(stepStart) * 1e9 / steps;
+        printf("    state %zu bytes, clone %.1f ns, one player move simulated %.0f ns (check %u)\n",
+            sizeof(GameSim::State), cloneNs, stepNs, check % 10);
+
+        // Search: play a whole game with the bot, for 1 thread and for every core
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int threads : { 1, cores }) {
+            MctsBot bot(level, threads);
+            MctsBot::Budget budget;
+            budget.timeMs = moveTimeMs;
+
+            GameSim::State state = start;
+            long long iterations = 0;
+            int played = 0;
+            auto searchStart = Clock::now();
+            while (!state.over) {
+                int move = bot.chooseMove(state, budget);
+                iterations += bot.getLastIterations();
+                GameSim::step(level, state, move, scratch);
+                ++played;
+            }
+            double seconds = secondsSince(searchStart);
+            printf("    %d thread(s), %llu ms per move: %lld tries per move, %.0f tries/s, "
+                "%s after %d moves (%.1f s of game time), score %d, lives %d\n",
+                threads, static_cast<unsigned long long>(moveTimeMs), played > 0 ? iterations / played : 0,
+                iterations / seconds, state.won ? "won" : "lost", played, state.now / 1000.0, state.score, state.lives);
+            if (threads == cores) break;
+        }
+    }
+
+    void benchMcts() {
+        printf("MCTS bot: state cloning, simulation speed and search throughput\n");
+        reportMcts("current layout", Maze::getWalkGrid(), 10);
+        reportMcts("maze, 10% loops", makeBraidedMaze(20, 15, 10, 71), 10);
+        reportMcts("maze, 10% loops", makeBraidedMaze(40, 40, 10, 72), 10);
+    }
+
+    void reportVecEnv(const GameSim::Level& level, int envCount, int threads, bool withObservations) {
+        VecEnv env(level, envCount, threads);
+        std::vector<uint8_t> observations(static_cast<size_t>(envCount) * env.getObservationSize());
+        if (withObservations) env.setObservationBuffer(observations.data());
+        std::vector<int> actions(envCount);
+        std::vector<float> rewards(envCount);
+        std::vector<uint8_t> dones(envCount);
+
+        uint32_t random = 12345;
+        long long steps = 0;
+        int episodes = 0;
+        auto start = Clock::now();
+        while (secondsSince(start) < 1.0) {
+            for (int batch = 0; batch < 16; ++batch) {
+                for (int& action : actions) {
+                    random ^= random << 13;
+                    random ^= random >> 17;
+                    random ^= random << 5;
+                    action = static_cast<int>(random % VecEnv::ACTION_COUNT);
+                }
+                env.step(actions.data(), rewards.data(), dones.data());
+                for (uint8_t done : dones) {
+                    episodes += done;
+                }
+                steps += envCount;
+            }
+        }
+        double seconds = secondsSince(start);
+        printf("    %5d envs, %d thread(s), observations %-3s: %6.2f M env-steps/s, %.0f ns per env-step, %d games finished\n",
+            envCount, threads, withObservations ? "on" : "off", steps / seconds / 1e6, seconds * 1e9 / steps, episodes);
+    }
+
+    void benchVecEnv() {
+        GameSim::Level level = makeSimLevel(Maze::getWalkGrid());
+        printf("Vectorized environment, current layout (%d x %d, %d observation bytes per env), random actions\n",
+            level.width, level.height, VecEnv::PLANE_COUNT * level.width * level.height);
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int envCount : { 64, 1024, 4096 }) {
+            reportVecEnv(level, envCount, 1, false);
+            reportVecEnv(level, envCount, 1, true);
+            if (cores > 1) reportVecEnv(level, envCount, cores, true);
+        }
+    }
+
+    // Action of game g at move m for the "random" bot, the same for both engines
+    int8_t randomAction(int game, int move) {
+        uint32_t x = static_cast<uint32_t>(game) * 2654435761u ^ static_cast<uint32_t>(move) * 40503u;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return static_cast<int8_t>(x % 4);
+    }
+
+    void reportBatch(const GameSim::Level& level, int gameCount, bool runner) {
+        // One game at a time with GameSim (setting up the games isn't timed, for either engine)
+        std::vector<GameSim::State> states(gameCount);
+        for (int g = 0; g < gameCount; ++g) {
+            states[g] = GameSim::newGame(level, 1000 + g);
+        }
+        GameSim::Scratch scratch;
+        long long scalarMoves = 0;
+        auto scalarStart = Clock::now();
+        for (int g = 0; g < gameCount; ++g) {
+            GameSim::State& state = states[g];
+            for (int move = 0; !state.over; ++move) {
+                int action = runner ? GameSim::stepDownhill(level, level.goalDistance, state.playerX, state.playerY)
+                    : randomAction(g, move);
+                GameSim::step(level, state, action, scratch);
+                ++scalarMoves;
+            }
+        }
+        double scalarSeconds = secondsSince(scalarStart);
+
+        // All games together with BatchSim (finished games are carried along until the last ends)
+        BatchSim batch(level, gameCount);
+        std::vector<int8_t> actions(gameCount);
+        batch.reset(1000);
+        auto batchStart = Clock::now();
+        int ticks = 0;
+        while (!batch.allOver()) {
+            for (int g = 0; g < gameCount; ++g) {
+                actions[g] = static_cast<int8_t>(runner ? batch.goalStep(g) : randomAction(g, ticks));
+            }
+            batch.tick(actions.data());
+            ++ticks;
+        }
+        double batchSeconds = secondsSince(batchStart);
+
+        int mismatches = 0;
+        for (int g = 0; g < gameCount; ++g) {
+            const GameSim::State& state = states[g];
+            if (state.won != batch.hasWon(g) || state.score != batch.getScore(g) || state.lives != batch.getLives(g) ||
+                state.now != batch.getFinishTime(g) || state.playerX != batch.getPlayerX(g) || state.playerY != batch.getPlayerY(g)) {
+                ++mismatches;
+            }
+        }
+
+        long long batchMoves = static_cast<long long>(ticks) * gameCount;
+        printf("    %5d games, %-6s bot: one by one %6.2f M moves/s, batch %6.2f M moves/s "
+            "(%.2f M useful/s, %d ticks), %d mismatches\n",
+            gameCount, runner ? "runner" : "random", scalarMoves / scalarSeconds / 1e6, batchMoves / batchSeconds / 1e6,
+            scalarMoves / batchSeconds / 1e6, ticks, mismatches);
+    }
+
+    void benchBatch() {
+        GameSim::Level level = makeSimLevel(Maze::getWalkGrid());
+        printf("Lockstep batch of games (structure of arrays) against GameSim one game at a time, current layout\n");
+        for (int gameCount : { 256, 4096, 32768 }) {
+            reportBatch(level, gameCount, false);
+            reportBatch(level, gameCount, true);
+        }
+    }
+
+    // How one headless session ended
+    struct SessionResult {
+        int score, lives, timeRemaining;
+        bool won;
+        Uint64 playTime;
+
+        bool operator==(const SessionResult& other) const {
+            return score == other.score && lives == other.lives && timeRemaining == other.timeRemaining &&
+                won == other.won && playTime == other.playTime;
+        }
+    };
+
+    // Play one session to the end at 60 frames per second of game time: every player step
+    // goes downhill toward the goal half of the time and in a random direction otherwise
+    SessionResult playSession(const GameSim::Level& level, const std::vector<std::vector<int>>& layout,
+        int index, long long& frames) {
+        const Uint64 FRAME_TIME = 16;
+        GameSession session(1000 + index);
+        session.start(layout);
+
+        Uint64 nextStep = 0;
+        for (int move = 0; !session.isOver(); ) {
+            if (session.now() >= nextStep) {
+                nextStep += GameConfig::AUTOPLAY_STEP_INTERVAL;
+                int x, y;
+                {
+                    GameSession::Use use(session);
+                    x = Player::getX();
+                    y = Player::getY();
+                }
+                int dir = randomAction(index, move) % 2 == 0 ?
+                    GameSim::stepDownhill(level, level.goalDistance, x, y) : randomAction(index + 1, move);
+                if (dir != GameSim::STAY) session.movePlayer(GameSim::STEP_X[dir], GameSim::STEP_Y[dir]);
+                ++move;
+            }
+            session.update();
+            session.advanceTime(FRAME_TIME);
+            ++frames;
+        }
+        return { session.getScore(), session.getLives(), session.getTimeRemaining(), session.hasWon(), session.getPlayTime() };
+    }
+
+    // Play every session once, handing them out to `threadCount` threads as they become free
+    double playSessions(const GameSim::Level& level, const std::vector<std::vector<int>>& layout,
+        int threadCount, std::vector<SessionResult>& results, long long& frames) {
+        std::atomic<int> nextSession{ 0 };
+        std::atomic<long long> totalFrames{ 0 };
+        auto work = [&] {
+            long long myFrames = 0;
+            for (int i = nextSession++; i < static_cast<int>(results.size()); i = nextSession++) {
+                results[i] = playSession(level, layout, i, myFrames);
+            }
+            totalFrames += myFrames;
+        };
+
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        frames = totalFrames;
+        return secondsSince(start);
+    }
+
+    void benchSessions() {
+        // The current walls with the player and goal where the other game benchmarks put them;
+        // items and enemies are placed by each session's own random numbers
+        GameSim::Level level = makeSimLevel(Maze::getWalkGrid());
+        std::vector<std::vector<int>> layout(level.height, std::vector<int>(level.width, 0));
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                layout[y][x] = level.isWalkable(x, y) ? 1 : 0;
+            }
+        }
+        layout[level.playerY][level.playerX] = 3;
+        layout[level.goalY][level.goalX] = 4;
+
+        printf("Independent GameSessions played to the end, current layout, 16 ms frames\n");
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int sessionCount : { 64, 512 }) {
+            // One thread first; the same sessions on a pool must end exactly the same way
+            std::vector<SessionResult> alone(sessionCount);
+            long long frames = 0;
+            double seconds = playSessions(level, layout, 1, alone, frames);
+            int wins = static_cast<int>(std::count_if(alone.begin(), alone.end(), [](const SessionResult& r) { return r.won; }));
+            printf("    %4d sessions, %2d thread(s): %8.0f sessions/s %8.2f M frames/s, %d won\n",
+                sessionCount, 1, sessionCount / seconds, frames / seconds / 1e6, wins);
+
+            for (int threadCount : { 4, std::max(8, cores * 2) }) {
+                std::vector<SessionResult> pooled(sessionCount);
+                seconds = playSessions(level, layout, threadCount, pooled, frames);
+                int mismatches = 0;
+                for (int i = 0; i < sessionCount; ++i) {
+                    if (!(pooled[i] == alone[i])) ++mismatches;
+                }
+                printf("    %4d sessions, %2d thread(s): %8.0f sessions/s %8.2f M frames/s, %d mismatches\n",
+                    sessionCount, threadCount, sessionCount / seconds, frames / seconds / 1e6, mismatches);
+            }
+        }
+    }
+
+    // Flow field toward the player on the current layout, with one tile walled in on all
+    // sides. Every tile is checked against a plain BFS: reachable tiles must step one tile
+    // closer, and the target and the walled-in tile must have no direction at all.
+    void benchFlowField() {
+        GameSim::Level level = makeSimLevel(Maze::getWalkGrid());
+        std::vector<std::vector<int>> layout(level.height, std::vector<int>(level.width, 0));
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                layout[y][x] = level.isWalkable(x, y) ? 1 : 0;
+            }
+        }
+        layout[level.playerY][level.playerX] = 3;
+        layout[level.goalY][level.goalX] = 4;
+
+        // The last plain path tile whose neighbors are all plain paths or walls
+        int closedX = -1, closedY = -1;
+        for (int y = 1; y + 1 < level.height; ++y) {
+            for (int x = 1; x + 1 < level.width; ++x) {
+                if (layout[y][x] != 1) continue;
+                if (layout[y - 1][x] > 1 || layout[y + 1][x] > 1 || layout[y][x - 1] > 1 || layout[y][x + 1] > 1) continue;
+                closedX = x;
+                closedY = y;
+            }
+        }
+        if (closedX < 0) {
+            printf("Flow field: no tile to wall in on the current layout\n");
+            return;
+        }
+        layout[closedY - 1][closedX] = 0;
+        layout[closedY + 1][closedX] = 0;
+        layout[closedY][closedX - 1] = 0;
+        layout[closedY][closedX + 1] = 0;
+
+        GameSession session(1);
+        session.start(layout);
+        GameSession::Use use(session);
+        const BitGrid& walk = Maze::getWalkGrid();
+        const int px = Player::getX();
+        const int py = Player::getY();
+
+        BitGrid reached;
+        std::vector<uint16_t> distances;
+        BitBfs::flood(walk, px, py, reached, &distances);
+
+        // Wait for the background build, asking from a tile next to the player
+        int probe = static_cast<int>(std::find(distances.begin(), distances.end(), 1) - distances.begin());
+        if (probe == static_cast<int>(distances.size())) {
+            printf("Flow field: the player can't move on the current layout\n");
+            return;
+        }
+        const int probeX = probe % walk.width;
+        const int probeY = probe / walk.width;
+        Direction dir;
+        auto start = Clock::now();
+        while (!FlowField::getDirection(px, py, probeX, probeY, dir)) {
+            std::this_thread::yield();
+        }
+        double buildSeconds = secondsSince(start);
+
+        const int dx[4] = { 0, 1, 0, -1 };
+        const int dy[4] = { -1, 0, 1, 0 };
+        int withWay = 0, wrong = 0;
+        start = Clock::now();
+        for (int y = 0; y < walk.height; ++y) {
+            for (int x = 0; x < walk.width; ++x) {
+                uint16_t here = distances[static_cast<size_t>(y) * walk.width + x];
+                bool expected = walk.get(x, y) && here != BitBfs::UNREACHED && here != 0;
+                bool got = FlowField::getDirection(px, py, x, y, dir);
+                withWay += got;
+                if (got != expected) {
+                    ++wrong;
+                }
+                else if (got) {
+                    int nx = x + dx[static_cast<int>(dir)];
+                    int ny = y + dy[static_cast<int>(dir)];
+                    if (!walk.get(nx, ny) || distances[static_cast<size_t>(ny) * walk.width + nx] != here - 1) ++wrong;
+                }
+            }
+        }
+        double lookupSeconds = secondsSince(start);
+        const std::vector<uint16_t>* steps = FlowField::getDistances(px, py);
+        bool sameSteps = steps && *steps == distances;
+
+        printf("Flow field toward the player, current layout with the tile at (%d, %d) walled in\n", closedX, closedY);
+        printf("  %d x %d: ready after %.2f ms, %.1f ns per lookup, %d tiles with a way, walled-in tile %s, target %s, %d wrong, "
+            "distances %s\n",
+            walk.width, walk.height, buildSeconds * 1000.0, lookupSeconds * 1e9 / (walk.width * walk.height), withWay,
+            FlowField::getDirection(px, py, closedX, closedY, dir) ? "HAS A WAY" : "has no way",
+            FlowField::getDirection(px, py, px, py, dir) ? "HAS A WAY" : "has no way", wrong,
+            sameSteps ? "same as BFS" : "DIFFERENT");
+    }
+
+    // Carve mazes with one algorithm and check that the last one is perfect: all path
+    // tiles connected, and exactly one path tile between two neighboring cells per join
+    void reportGenerator(MazeGenerator::Algorithm algorithm, int cells, int runs) {
+        const int size = cells * 2 + 1;
+        std::vector<uint8_t> tiles(static_cast<size_t>(size) * size);
+        MazeGenerator generator;
+        generator.carve(algorithm, tiles.data(), size, size, 0);     // Warm up the work buffers
+
+        auto start = Clock::now();
+        for (int run = 0; run < runs; ++run) {
+            generator.carve(algorithm, tiles.data(), size, size, static_cast<uint32_t>(run + 1));
+        }
+        double seconds = secondsSince(start) / runs;
+
+        BitGrid grid(size, size);
+        long long pathTiles = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                bool path = tiles[static_cast<size_t>(y) * size + x] != 0;
+                grid.set(x, y, path);
+                pathTiles += path;
+            }
+        }
+        BitGrid reached;
+        BitBfs::Result flood = BitBfs::flood(grid, 1, 1, reached, nullptr);
+        long long cellCount = static_cast<long long>(cells) * cells;
+        bool perfect = pathTiles == cellCount * 2 - 1 && flood.tilesReached == pathTiles;
+
+        printf("    %-13s %5d x %-5d cells %9.2f ms %8.1f M cells/s %s\n", MazeGenerator::getName(algorithm),
+            cells, cells, seconds * 1000.0, cellCount / seconds / 1e6, perfect ? "perfect" : "NOT PERFECT");
+    }
+
+    void benchGenerate() {
+        printf("Maze generators, carving into a reused tile buffer\n");
+        for (int cells : { 500, 2000 }) {
+            for (int a = 0; a < static_cast<int>(MazeGenerator::Algorithm::COUNT); ++a) {
+                reportGenerator(static_cast<MazeGenerator::Algorithm>(a), cells, cells <= 500 ? 10 : 2);
+            }
+        }
+    }
+
+    // Carve one big maze on 1, 2, ... threads; every thread count must give the same maze
+    void reportTiled(MazeGenerator::Algorithm algorithm, int cells) {
+        const int size = cells * 2 + 1;
+        std::vector<uint8_t> tiles(static_cast<size_t>(size) * size);
+
+        MazeGenerator generator;
+        auto start = Clock::now();
+        generator.carve(algorithm, tiles.data(), size, size, 9);
+        double singleSeconds = secondsSince(start);
+        printf("    %-13s %5d x %-5d cells, one piece:     %8.1f ms %8.1f M cells/s\n", MazeGenerator::getName(algorithm),
+            cells, cells, singleSeconds * 1000.0, static_cast<double>(cells) * cells / singleSeconds / 1e6);
+
+        uint64_t firstChecksum = 0;
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int threads : { 1, 2, 4, cores }) {
+            start = Clock::now();
+            TiledMazeGenerator::carve(algorithm, tiles.data(), size, size, 9, threads);
+            double seconds = secondsSince(start);
+
+            uint64_t checksum = 1469598103934665603ull;
+            long long pathTiles = 0;
+            BitGrid grid(size, size);
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) {
+                    uint8_t tile = tiles[static_cast<size_t>(y) * size + x];
+                    checksum = (checksum ^ tile) * 1099511628211ull;
+                    grid.set(x, y, tile != 0);
+                    pathTiles += tile != 0;
+                }
+            }
+            if (threads == 1) firstChecksum = checksum;
+            BitGrid reached;
+            BitBfs::Result result = BitBfs::flood(grid, 1, 1, reached, nullptr);
+            long long cellCount = static_cast<long long>(cells) * cells;
+            bool perfect = pathTiles == cellCount * 2 - 1 && result.tilesReached == pathTiles;
+
+            printf("    %-13s %5d x %-5d cells, %2d thread(s): %8.1f ms %8.1f M cells/s %s, %s\n", "",
+                cells, cells, threads, seconds * 1000.0, cellCount / seconds / 1e6,
+                perfect ? "perfect" : "NOT PERFECT", checksum == firstChecksum ? "same maze" : "DIFFERENT MAZE");
+        }
+    }
+
+    void benchTiled() {
+        printf("Tiled maze generation (%d x %d cell blocks, %u core(s))\n", TiledMazeGenerator::DEFAULT_BLOCK_CELLS,
+            TiledMazeGenerator::DEFAULT_BLOCK_CELLS, std::max(1u, std::thread::hardware_concurrency()));
+        reportTiled(MazeGenerator::Algorithm::BACKTRACKER, 2000);
+        reportTiled(MazeGenerator::Algorithm::WILSON, 2000);
+        reportTiled(MazeGenerator::Algorithm::BACKTRACKER, 8000);
+    }
+
+    // The 4-5 rule one tile at a time, to check the word-parallel step against
+    void caveStepSlow(const BitGrid& from, BitGrid& to) {
+        to = BitGrid(from.width, from.height);
+        for (int y = 1; y < from.height - 1; ++y) {
+            for (int x = 1; x < from.width - 1; ++x) {
+                int floorTiles = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        floorTiles += from.get(x + dx, y + dy);
+                    }
+                }
+                to.set(x, y, floorTiles >= 5);
+            }
+        }
+    }
+
+    void reportCave(int size, int steps) {
+        BitGrid cave(size, size), next(size, size), slow;
+        CaveGenerator::fillRandom(cave, CaveGenerator::DEFAULT_WALL_PERCENT, 3);
+
+        // The same steps again and again on the same noise, so every run does equal work
+        BitGrid noise = cave;
+        auto start = Clock::now();
+        for (int i = 0; i < steps; ++i) {
+            CaveGenerator::step(noise, next);
+        }
+        double stepSeconds = secondsSince(start) / steps;
+
+        int mismatches = 0;
+        for (int i = 0; i < CaveGenerator::DEFAULT_STEPS; ++i) {
+            CaveGenerator::step(cave, next);
+            caveStepSlow(cave, slow);
+            if (next.words != slow.words) ++mismatches;
+            std::swap(cave, next);
+        }
+
+        start = Clock::now();
+        int removed = CaveGenerator::keepLargestArea(cave);
+        double cleanupSeconds = secondsSince(start);
+
+        start = Clock::now();
+        BitGrid whole(size, size);
+        CaveGenerator::generate(whole, 3);
+        double generateSeconds = secondsSince(start);
+
+        long long floorTiles = 0;
+        for (uint64_t word : whole.words) {
+            floorTiles += countBits(word);
+        }
+        ComponentLabels areas;
+        areas.build(whole);
+
+        printf("    %5d x %-5d step %8.1f us (%6.2f ns per 64 tiles), cleanup %7.2f ms (%d tiles filled), "
+            "whole cave %7.2f ms, %4.1f%% floor, %d area(s), %d mismatches\n",
+            size, size, stepSeconds * 1e6, stepSeconds * 1e9 / (static_cast<double>(size) * size / 64),
+            cleanupSeconds * 1000.0, removed, generateSeconds * 1000.0,
+            100.0 * floorTiles / (static_cast<double>(size) * size), areas.getComponentCount(), mismatches);
+    }
+
+    void benchCave() {
+        printf("Cellular-automata caves (4-5 rule, %d%% walls, %d steps, %s kernel)\n",
+            CaveGenerator::DEFAULT_WALL_PERCENT, CaveGenerator::DEFAULT_STEPS, CaveGenerator::usesAvx2() ? "AVX2" : "scalar");
+        reportCave(256, 2000);
+        reportCave(1024, 200);
+        reportCave(4096, 10);
+    }
+
+    void benchMazeFile() {
+        const std::string path = "benchmark_maze.txt";
+        const int size = 10001;     // About 100 MB of text
+        printf("Text maze files (%d x %d tiles)\n", size, size);
+
+        MazeFile::TileGrid grid;
+        grid.width = size;
+        grid.height = size;
+        grid.tiles.resize(static_cast<size_t>(size) * size);
+        TiledMazeGenerator::carve(MazeGenerator::Algorithm::BACKTRACKER, grid.tiles.data(), size, size, 4);
+        MazeGenerator::placeObjects(grid.tiles.data(), size, size, 4, 1000, 1000);
+
+        auto start = Clock::now();
+        if (!MazeFile::save(path, grid)) {
+            printf("    can't write %s\n", path.c_str());
+            return;
+        }
+        double saveSeconds = secondsSince(start);
+        const double megabytes = (static_cast<double>(size) + 1) * size / 1e6;
+
+        // Reading the file without looking at it, for comparison (the second read of a file
+        // usually comes from the operating system's cache, like the load right after it)
+        start = Clock::now();
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::vector<char> block(1 << 20);
+            while (in.read(block.data(), static_cast<std::streamsize>(block.size())) || in.gcount() > 0) {
+            }
+        }
+        double readSeconds = secondsSince(start);
+
+        MazeFile::TileGrid loaded;
+        std::string error;
+        start = Clock::now();
+        bool ok = MazeFile::load(path, loaded, error);
+        double loadSeconds = secondsSince(start);
+        std::remove(path.c_str());
+
+        if (!ok) {
+            printf("    load failed: %s\n", error.c_str());
+            return;
+        }
+        bool same = loaded.width == grid.width && loaded.height == grid.height && loaded.tiles == grid.tiles;
+        printf("    save %7.1f ms (%6.0f MB/s), plain read %7.1f ms (%6.0f MB/s), load %7.1f ms (%6.0f MB/s), %s\n",
+            saveSeconds * 1000.0, megabytes / saveSeconds, readSeconds * 1000.0, megabytes / readSeconds,
+            loadSeconds * 1000.0, megabytes / loadSeconds, same ? "same maze" : "DIFFERENT MAZE");
+    }
+
+    void benchMapped() {
+        const std::string textPath = "benchmark_maze.txt";
+        const std::string mappedPath = "benchmark_maze.bin";
+        const int size = 16385;     // 268 M tiles
+        printf("Mapped maze files (%d x %d tiles)\n", size, size);
+
+        MazeFile::TileGrid grid;
+        grid.width = size;
+        grid.height = size;
+        grid.tiles.resize(static_cast<size_t>(size) * size);
+        TiledMazeGenerator::carve(MazeGenerator::Algorithm::BACKTRACKER, grid.tiles.data(), size, size, 6);
+        MazeGenerator::placeObjects(grid.tiles.data(), size, size, 6, 5000, 5000);
+
+        std::string error;
+        auto start = Clock::now();
+        bool ok = MappedMaze::write(mappedPath, grid, error);
+        double writeSeconds = secondsSince(start);
+        if (!ok || !MazeFile::save(textPath, grid)) {
+            printf("    can't write the benchmark files: %s\n", error.c_str());
+            return;
+        }
+
+        // What the same maze costs as text
+        MazeFile::TileGrid loaded;
+        start = Clock::now();
+        ok = MazeFile::load(textPath, loaded, error);
+        double textSeconds = secondsSince(start);
+        std::remove(textPath.c_str());
+        loaded = MazeFile::TileGrid();
+
+        MappedMaze maze;
+        start = Clock::now();
+        ok = ok && maze.open(mappedPath, error);
+        double openSeconds = secondsSince(start);
+        if (!ok) {
+            printf("    open failed: %s\n", error.c_str());
+            std::remove(mappedPath.c_str());
+            return;
+        }
+
+        // The first screen around the player: only its pages are read
+        start = Clock::now();
+        int walkable = 0;
+        for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+            for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
+                walkable += maze.isWalkable(maze.getPlayerX() - GameConfig::MAZE_WIDTH / 2 + x,
+                    maze.getPlayerY() - GameConfig::MAZE_HEIGHT / 2 + y);
+            }
+        }
+        double screenSeconds = secondsSince(start);
+
+        std::mt19937 rng(7);
+        const int lookups = 4000000;
+        std::vector<int> xs(lookups), ys(lookups);
+        for (int i = 0; i < lookups; ++i) {
+            xs[i] = static_cast<int>(rng() % size);
+            ys[i] = static_cast<int>(rng() % size);
+        }
+        start = Clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            walkable += maze.isWalkable(xs[i], ys[i]);
+        }
+        double lookupSeconds = secondsSince(start);
+
+        // Every tile and every item and enemy must match what was written
+        long long mismatches = 0;
+        size_t entities = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                uint8_t tile = grid.at(x, y);
+                mismatches += maze.isWalkable(x, y) != (tile != 0);
+                entities += tile == 2 || tile == 5;
+            }
+        }
+        for (int y = 0; y < size; y += 97) {
+            size_t count = 0;
+            const MappedMaze::Entity* entity = maze.getEntities(y, 0, size, count);
+            for (; count > 0; --count, ++entity) {
+                mismatches += grid.at(entity->x, entity->y) != entity->tile;
+            }
+        }
+        mismatches += entities != maze.getEntityCount();
+
+        // The header's hash must be the one a copy of the walls gives (sidecars are checked with it)
+        BitGrid walls;
+        maze.copyWalls(walls);
+        mismatches += maze.getLayoutHash() != hashLayout(walls);
+        maze.close();
+        std::remove(mappedPath.c_str());
+
+        printf("    write %7.1f ms, text load %7.1f ms, open %7.3f ms, first screen %7.3f ms\n",
+            writeSeconds * 1000.0, textSeconds * 1000.0, openSeconds * 1000.0, screenSeconds * 1000.0);
+        printf("    random lookup %6.2f ns, %zu items and enemies, %lld mismatches (%d walkable)\n",
+            lookupSeconds / lookups * 1e9, entities, mismatches, walkable);
+    }
+
+    // Stream rows of an endless maze, then jump to random rows and check they come out the same
+    void reportEndless(int width, int64_t rows) {
+        EllerGenerator stream(width, 7);
+        std::vector<uint8_t> row(width);
+        uint64_t checksum = 0;
+
+        auto start = Clock::now();
+        for (int64_t r = 0; r < rows; ++r) {
+            stream.getRow(r, row.data());
+            checksum = checksum * 31 + row[static_cast<size_t>(r % width)];
+        }
+        double streamSeconds = secondsSince(start);
+
+        // Remember a few rows, then ask a fresh generator for them out of order
+        std::mt19937 rng(3);
+        std::vector<int64_t> picks;
+        std::vector<std::vector<uint8_t>> expected;
+        EllerGenerator again(width, 7);
+        for (int i = 0; i < 200; ++i) {
+            picks.push_back(static_cast<int64_t>(rng() % static_cast<uint32_t>(rows)));
+        }
+        std::vector<int64_t> sorted = picks;
+        std::sort(sorted.begin(), sorted.end());
+        EllerGenerator ordered(width, 7);
+        for (int64_t r = 0, next = 0; next < static_cast<int64_t>(sorted.size()); ++r) {
+            ordered.getRow(r, row.data());
+            while (next < static_cast<int64_t>(sorted.size()) && sorted[next] == r) {
+                expected.push_back(row);
+                ++next;
+            }
+        }
+
+        int mismatches = 0;
+        start = Clock::now();
+        for (int64_t pick : picks) {
+            again.getRow(pick, row.data());
+            size_t index = std::lower_bound(sorted.begin(), sorted.end(), pick) - sorted.begin();
+            if (row != expected[index]) ++mismatches;
+        }
+        double jumpSeconds = secondsSince(start) / picks.size();
+
+        printf("    width %5d: %8.2f M rows/s streamed (%6.0f M tiles/s), random row %7.1f us, %d mismatches (checksum %llx)\n",
+            width, rows / streamSeconds / 1e6, rows * static_cast<double>(width) / streamSeconds / 1e6,
+            jumpSeconds * 1e6, mismatches, static_cast<unsigned long long>(checksum));
+    }
+
+    void benchEndless() {
+        printf("Endless maze rows (Eller's algorithm), corridor every %d cell rows\n", GameConfig::ENDLESS_ANCHOR_INTERVAL);
+        reportEndless(GameConfig::MAZE_WIDTH, 10000000);
+        reportEndless(101, 2000000);
+        reportEndless(1001, 200000);
+    }
+
+    // Walk a view of the game's size east through a world, one tile per frame, and count the
+    // chunks the view had to wait for
+    int walkWorld(bool prefetch, int frames) {
+        ChunkWorld world(23, static_cast<size_t>(GameConfig::WORLD_CACHE_KB) * 1024);
+        int found = 0;
+        for (int frame = 0; frame < frames; ++frame) {
+            const int64_t right = frame + GameConfig::MAZE_WIDTH - 1;
+            for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+                found += world.isWalkable(right, y - GameConfig::MAZE_HEIGHT / 2);
+            }
+            if (prefetch) world.prefetchAround(frame + GameConfig::MAZE_WIDTH / 2, 0);
+
+            // A real frame leaves far more time than this
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return found > 0 ? world.getMissCount() : -1;
+    }
+
+    void benchWorld() {
+        const int size = ChunkWorld::CHUNK_SIZE;
+        printf("Open world in %dx%d chunks, %d doors per side, %d KB cache\n", size, size,
+            GameConfig::WORLD_CHUNK_DOORS, GameConfig::WORLD_CACHE_KB);
+
+        // Making chunks
+        MazeGenerator generator;
+        std::vector<uint8_t> tiles;
+        uint64_t rows[ChunkWorld::CHUNK_SIZE];
+        uint64_t checksum = 0;
+        const int chunkCount = 5000;
+        auto start = Clock::now();
+        for (int i = 0; i < chunkCount; ++i) {
+            ChunkWorld::makeChunk(11, i % 100 - 50, i / 100 - 25, generator, tiles, rows);
+            checksum = checksum * 31 + rows[i % size];
+        }
+        double makeSeconds = secondsSince(start);
+        printf("    make:       %8.0f chunks/s (%5.1f us each, %6.1f M tiles/s, checksum %llx)\n",
+            chunkCount / makeSeconds, makeSeconds / chunkCount * 1e6,
+            chunkCount * static_cast<double>(size * size) / makeSeconds / 1e6, static_cast<unsigned long long>(checksum));
+
+        // Everything in a square of 4x4 chunks should be reachable from the start without leaving it
+        const int span = size * 4;
+        ChunkWorld world(11, 4 << 20);
+        BitGrid region(span, span);
+        int pathTiles = 0;
+        for (int y = 0; y < span; ++y) {
+            for (int x = 0; x < span; ++x) {
+                bool walkable = world.isWalkable(x - span / 2, y - span / 2);
+                region.set(x, y, walkable);
+                pathTiles += walkable;
+            }
+        }
+        ComponentLabels labels;
+        labels.build(region);
+        int startArea = labels.componentAt(span / 2 + 1, span / 2 + 1);
+        int reached = 0;
+        for (int y = 0; y < span; ++y) {
+            for (int x = 0; x < span; ++x) {
+                reached += region.get(x, y) && labels.componentAt(x, y) == startArea;
+            }
+        }
+        printf("    connected:  %d of %d path tiles in 4x4 chunks reachable from the start\n", reached, pathTiles);
+
+        // Lookups inside one chunk (fast path) and spread over 8x8 chunks (cache lookup each time)
+        std::mt19937 rng(5);
+        const int lookups = 4000000;
+        std::vector<int64_t> xs(lookups), ys(lookups);
+        for (int i = 0; i < lookups; ++i) {
+            xs[i] = static_cast<int64_t>(rng() % (size * 8)) - size * 4;
+            ys[i] = static_cast<int64_t>(rng() % (size * 8)) - size * 4;
+        }
+        int walkable = 0;
+        start = Clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            walkable += world.isWalkable(xs[i] & (size - 1), ys[i] & (size - 1));
+        }
+        double sameSeconds = secondsSince(start);
+        start = Clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            walkable += world.isWalkable(xs[i], ys[i]);
+        }
+        double spreadSeconds = secondsSince(start);
+        printf("    lookup:     %6.2f ns in the current chunk, %6.2f ns spread over 8x8 chunks (%d walkable)\n",
+            sameSeconds / lookups * 1e9, spreadSeconds / lookups * 1e9, walkable);
+
+        // A cache that only holds a few chunks has to make them again and again; they must come out the same
+        ChunkWorld small(11, 0);
+        int mismatches = 0;
+        for (int i = 0; i < lookups / 10; ++i) {
+            if (small.isWalkable(xs[i], ys[i]) != world.isWalkable(xs[i], ys[i])) ++mismatches;
+        }
+        printf("    eviction:   %d chunks thrown out and made again by a %d-chunk cache, %d mismatches\n",
+            small.getEvictedCount(), small.getCachedCount(), mismatches);
+
+        // Walking into new chunks with and without making them ahead of time
+        const int frames = size * 16;
+        printf("    walk %d tiles east: %d chunks waited for without prefetching, %d with\n",
+            frames, walkWorld(false, frames), walkWorld(true, frames));
+    }
+
+    void benchLevels() {
+        const MazeGenerator::Algorithm algorithm = MazeGenerator::Algorithm::BACKTRACKER;
+        printf("Level progression (%s mazes, %dx%d)\n", MazeGenerator::getName(algorithm),
+            GameConfig::MAZE_WIDTH, GameConfig::MAZE_HEIGHT);
+
+        // What the background thread does for every level
+        const int levelCount = 200;
+        std::vector<std::vector<std::vector<int>>> layouts;
+        int attempts = 0;
+        auto start = Clock::now();
+        for (int number = 1; number <= levelCount; ++number) {
+            LevelProgression::PreparedLevel level = LevelProgression::prepare(algorithm, 1, number);
+            attempts += level.attempts;
+            if (level.background) SDL_DestroySurface(level.background);
+            layouts.push_back(std::move(level.layout));
+        }
+        double prepareSeconds = secondsSince(start) / levelCount;
+
+        // What is left for the frame the goal is reached on
+        GameSession session(1);
+        session.start(layouts[0]);
+        start = Clock::now();
+        for (int i = 1; i < levelCount; ++i) {
+            session.startNextLevel(layouts[i]);
+        }
+        double swapSeconds = secondsSince(start) / (levelCount - 1);
+
+        printf("    prepare: %8.1f us per level in the background (%.2f mazes tried per level)\n",
+            prepareSeconds * 1e6, static_cast<double>(attempts) / levelCount);
+        printf("    swap:    %8.1f us on the winning frame (one frame at 60 fps is 16667 us)\n", swapSeconds * 1e6);
+
+        // A pack with a good level and one whose goal is walled in: the second must be
+        // swapped for a generated maze, the first played as it is
+        const std::string path = "benchmark_progression.pack";
+        std::vector<std::vector<int>> broken = layouts[0];
+        const int dx[4] = { 0, 1, 0, -1 };
+        const int dy[4] = { -1, 0, 1, 0 };
+        for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+            for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
+                if (layouts[0][y][x] != 4) continue;
+                for (int d = 0; d < 4; ++d) {
+                    int nx = x + dx[d], ny = y + dy[d];
+                    if (nx >= 0 && nx < GameConfig::MAZE_WIDTH && ny >= 0 && ny < GameConfig::MAZE_HEIGHT) broken[ny][nx] = 0;
+                }
+            }
+        }
+        std::vector<MazeFile::TileGrid> packLevels;
+        for (const auto* layout : { &layouts[0], &broken }) {
+            MazeFile::TileGrid grid;
+            grid.width = GameConfig::MAZE_WIDTH;
+            grid.height = GameConfig::MAZE_HEIGHT;
+            for (const auto& row : *layout) {
+                for (int tile : row) grid.tiles.push_back(static_cast<uint8_t>(tile));
+            }
+            packLevels.push_back(std::move(grid));
+        }
+        std::string error;
+        LevelPack pack;
+        if (!LevelPack::write(path, packLevels, error) || !pack.open(path, error)) {
+            printf("    pack check: %s\n", error.c_str());
+            std::remove(path.c_str());
+            return;
+        }
+        LevelProgression::PreparedLevel good = LevelProgression::prepare(pack, 1);
+        LevelProgression::PreparedLevel replaced = LevelProgression::prepare(pack, 2);
+        std::remove(path.c_str());
+        if (good.background) SDL_DestroySurface(good.background);
+        if (replaced.background) SDL_DestroySurface(replaced.background);
+        printf("    pack:    good level %s, level with the goal walled in %s\n",
+            good.layout == layouts[0] ? "played as it is" : "CHANGED",
+            !replaced.layout.empty() && replaced.layout != broken ? "replaced by a generated maze" : "KEPT");
+    }
+
+    // Pack `count` generated levels (every algorithm in turn), then load random ones back
+    void reportPack(int count, int width, int height) {
+        const std::string path = "benchmark_levels.pack";
+        std::vector<MazeFile::TileGrid> levels(count);
+        MazeGenerator generator;
+        const int algorithms = static_cast<int>(MazeGenerator::Algorithm::COUNT);
+        for (int i = 0; i < count; ++i) {
+            MazeFile::TileGrid& level = levels[i];
+            level.width = width;
+            level.height = height;
+            level.tiles.resize(static_cast<size_t>(width) * height);
+            generator.carve(static_cast<MazeGenerator::Algorithm>(i % algorithms), level.tiles.data(), width, height, i);
+            MazeGenerator::placeObjects(level.tiles.data(), width, height, i, GameConfig::MAX_ITEMS, GameConfig::MAX_ENEMIES);
+        }
+
+        std::string error;
+        auto start = Clock::now();
+        bool ok = LevelPack::write(path, levels, error);
+        double writeSeconds = secondsSince(start);
+
+        LevelPack pack;
+        start = Clock::now();
+        ok = ok && pack.open(path, error);
+        double openSeconds = secondsSince(start);
+        if (!ok) {
+            printf("    %s\n", error.c_str());
+            std::remove(path.c_str());
+            return;
+        }
+
+        // Random levels, each one timed on its own
+        std::mt19937 rng(9);
+        const int loads = 2000;
+        MazeFile::TileGrid loaded;
+        int mismatches = 0;
+        double totalSeconds = 0.0, slowestSeconds = 0.0;
+        for (int i = 0; i < loads; ++i) {
+            int index = static_cast<int>(rng() % count);
+            start = Clock::now();
+            ok = pack.load(index, loaded, error);
+            double seconds = secondsSince(start);
+            totalSeconds += seconds;
+            slowestSeconds = std::max(slowestSeconds, seconds);
+            if (!ok || loaded.tiles != levels[index].tiles) ++mismatches;
+        }
+
+        // A damaged copy: changed bytes in the levels' data must be noticed
+        std::vector<char> bytes;
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            bytes.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        const size_t dataStart = bytes.size() - static_cast<size_t>(pack.getCompressedBytes());
+        for (size_t i = dataStart; i < bytes.size(); i += 29) {
+            bytes[i] = static_cast<char>(bytes[i] ^ 0x11);
+        }
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        int caught = 0, damagedLevels = 0;
+        LevelPack damaged;
+        if (damaged.open(path, error)) {
+            for (int i = 0; i < count; i += 7) {
+                ++damagedLevels;
+                if (!damaged.load(i, loaded, error)) ++caught;
+            }
+        }
+        std::remove(path.c_str());
+
+        const double rawBytes = static_cast<double>(width) * height * count;
+        printf("    %5d levels of %4dx%-4d: %6.2f MB -> %6.2f MB (%4.1f%%), write %7.1f ms, open %6.3f ms\n",
+            count, width, height, rawBytes / 1e6, pack.getCompressedBytes() / 1e6,
+            pack.getCompressedBytes() * 100.0 / rawBytes, writeSeconds * 1000.0, openSeconds * 1000.0);
+        printf("        load %7.1f us on average, %7.1f us at most, %d mismatches; damaged copy: %d of %d checked levels refused\n",
+            totalSeconds / loads * 1e6, slowestSeconds * 1e6, mismatches, caught, damagedLevels);
+    }
+
+    void benchPack() {
+        printf("Level packs\n");
+        reportPack(10000, GameConfig::MAZE_WIDTH, GameConfig::MAZE_HEIGHT);
+        reportPack(10000, 101, 101);
+        reportPack(100, 1001, 1001);
+    }
+
+    void benchImage() {
+        const std::string path = "benchmark_maze.bmp";
+        const int size = 8193;      // 67 M tiles, a 201 MB image
+        printf("Maze images (%d x %d pixels, 24 bits per pixel)\n", size, size);
+
+        MazeFile::TileGrid grid;
+        grid.width = size;
+        grid.height = size;
+        grid.tiles.resize(static_cast<size_t>(size) * size);
+        TiledMazeGenerator::carve(MazeGenerator::Algorithm::BACKTRACKER, grid.tiles.data(), size, size, 8);
+        MazeGenerator::placeObjects(grid.tiles.data(), size, size, 8, 5000, 5000);
+
+        const std::vector<MazeImage::PaletteColor> palette = MazeImage::defaultPalette();
+        auto start = Clock::now();
+        if (!MazeImage::save(path, grid, palette)) {
+            printf("    can't write %s\n", path.c_str());
+            return;
+        }
+        double saveSeconds = secondsSince(start);
+
+        MazeFile::TileGrid loaded;
+        std::string error;
+        start = Clock::now();
+        bool ok = MazeImage::load(path, palette, loaded, error);
+        double loadSeconds = secondsSince(start);
+        std::remove(path.c_str());
+        if (!ok) {
+            printf("    load failed: %s\n", error.c_str());
+            return;
+        }
+
+        const double imageBytes = static_cast<double>((size * 3 + 3) / 4 * 4) * size;
+        printf("    save: %7.1f ms\n", saveSeconds * 1000.0);
+        printf("    load: %7.1f ms (%.0f MB/s of image, %.1f ns per pixel), %s\n",
+            loadSeconds * 1000.0, imageBytes / loadSeconds / 1e6, loadSeconds * 1e9 / grid.tiles.size(),
+            loaded.width == size && loaded.height == size && loaded.tiles == grid.tiles ? "same maze" : "DIFFERENT MAZE");
+    }
+
+    struct Entry {
+        const char* name;
+        void (*function)();
+    };
+
+    const Entry benchmarks[] = {
+        { "bfs", benchBfs },
+        { "junction", benchJunction },
+        { "landmarks", benchLandmarks },
+        { "hierarchy", benchHierarchy },
+        { "cooperative", benchCooperative },
+        { "incremental", benchIncremental },
+        { "visibility", benchVisibility },
+        { "components", benchComponents },
+        { "hint", benchHint },
+        { "mcts", benchMcts },
+        { "vecenv", benchVecEnv },
+        { "batch", benchBatch },
+        { "sessions", benchSessions },
+        { "flow", benchFlowField },
+        { "generate", benchGenerate },
+        { "tiled", benchTiled },
+        { "cave", benchCave },
+        { "mazefile", benchMazeFile },
+        { "mapped", benchMapped },
+        { "endless", benchEndless },
+        { "world", benchWorld },
+        { "levels", benchLevels },
+        { "pack", benchPack },
+        { "image", benchImage },
+    };
+}
+
+bool Benchmark::run(const std::string& name) {
+    bool found = false;
+    for (const Entry& entry : benchmarks) {
+        if (name == "all" || name == entry.name) {
+            entry.function();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        printf("Unknown benchmark '%s'. Available:", name.c_str());
+        for (const Entry& entry : benchmarks) {
+            printf(" %s", entry.name);
+        }
+        printf(" all\n");
+    }
+    return found;
+}
@@ -0,0 +1,11 @@
+// Benchmark.h
+#pragma once
+#include <string>
+
+// Performance measurements that run in the console without opening a window.
+// Start the game with "--bench <name>" (or "--bench all") to run them.
+namespace Benchmark {
+    // Run one benchmark by name and print the results.
+    // Returns false if there is no benchmark with that name.
+    bool run(const std::string& name);
+}
@@ -0,0 +1,170 @@
+// BitBfs.cpp
+#include "BitBfs.h"
+
+#include <algorithm>
+#include <utility>
+
+// Two strategies are used:
+//
+// - Without distances, only "which tiles are reachable" matters. A word is filled to
+//   its closure in one go (every run of walkable tiles that touches a reached tile),
+//   and the words next to it are queued again only if the new tiles can spread there.
+//
+// - With distances, the flood has to advance one step (layer) at a time, and every
+//   reached tile needs its own distance written anyway. The frontier is a list of tiles
+//   and each one looks at its four neighbors; the packed bits only serve as the "already
+//   reached" flags, which are 16 times smaller than the distances and stay in the cache.
+//   (Growing whole 256-tile blocks at once only pays when a block holds many frontier
+//   tiles, and a flood from one tile hardly ever has more than a couple per row.)
+
+namespace {
+    // Spread seeds toward lower bits through runs of walkable bits ("occluded fill")
+    uint64_t fillTowardLowBits(uint64_t seeds, uint64_t walk) {
+        uint64_t open = walk;
+        seeds |= open & (seeds >> 1);
+        open &= open >> 1;
+        seeds |= open & (seeds >> 2);
+        open &= open >> 2;
+        seeds |= open & (seeds >> 4);
+        open &= open >> 4;
+        seeds |= open & (seeds >> 8);
+        open &= open >> 8;
+        seeds |= open & (seeds >> 16);
+        open &= open >> 16;
+        seeds |= open & (seeds >> 32);
+        return seeds;
+    }
+
+    // Fill every run of walkable bits in a word that contains a seed
+    uint64_t fillRuns(uint64_t seeds, uint64_t walk) {
+        // Adding a seed to a run of 1s flips the part of the run above the seed
+        uint64_t up = (((walk + seeds) ^ walk) & walk) | seeds;
+        return fillTowardLowBits(up, walk);
+    }
+
+    int fillReachable(const BitGrid& walk, int startX, int startY, BitGrid& reached) {
+        const int height = walk.height;
+        const int wordsPerRow = walk.wordsPerRow;
+        const uint64_t* w = walk.words.data();
+        uint64_t* r = reached.words.data();
+
+        // Words that may be able to grow, with a flag so each is queued at most once
+        std::vector<size_t> work;
+        std::vector<uint8_t> queued(walk.words.size(), 0);
+        auto push = [&](size_t word) {
+            if (!queued[word]) {
+                queued[word] = 1;
+                work.push_back(word);
+            }
+        };
+
+        size_t startWord = static_cast<size_t>(startY) * wordsPerRow + startX / 64;
+        r[startWord] = fillRuns(uint64_t(1) << (startX % 64), w[startWord]);
+        if (startY > 0) push(startWord - wordsPerRow);
+        if (startY < height - 1) push(startWord + wordsPerRow);
+        if (startX / 64 > 0) push(startWord - 1);
+        if (startX / 64 < wordsPerRow - 1) push(startWord + 1);
+
+        while (!work.empty()) {
+            size_t word = work.back();
+            work.pop_back();
+            queued[word] = 0;
+
+            int y = static_cast<int>(word / wordsPerRow);
+            int col = static_cast<int>(word % wordsPerRow);
+            bool hasAbove = y > 0;
+            bool hasBelow = y < height - 1;
+            bool hasLeft = col > 0;
+            bool hasRight = col < wordsPerRow - 1;
+
+            // Everything reached next to this word can spread into it
+            uint64_t seeds = r[word];
+            if (hasAbove) seeds |= r[word - wordsPerRow];
+            if (hasBelow) seeds |= r[word + wordsPerRow];
+            if (hasLeft) seeds |= r[word - 1] >> 63;
+            if (hasRight) seeds |= r[word + 1] << 63;
+            seeds &= w[word];
+
+            uint64_t filled = fillRuns(seeds, w[word]);
+            uint64_t added = filled & ~r[word];
+            if (!added) continue;
+            r[word] = filled;
+
+            // Only queue neighbors the new tiles can actually spread into
+            if (hasAbove && (added & w[word - wordsPerRow] & ~r[word - wordsPerRow])) push(word - wordsPerRow);
+            if (hasBelow && (added & w[word + wordsPerRow] & ~r[word + wordsPerRow])) push(word + wordsPerRow);
+            if (hasLeft && (added & 1) && (w[word - 1] & ~r[word - 1]) >> 63) push(word - 1);
+            if (hasRight && (added >> 63) && (w[word + 1] & ~r[word + 1] & 1)) push(word + 1);
+        }
+
+        int count = 0;
+        for (uint64_t bits : reached.words) {
+            count += countBits(bits);
+        }
+        return count;
+    }
+}
+
+BitBfs::Result BitBfs::flood(const BitGrid& walk, int startX, int startY,
+    BitGrid& reached, std::vector<uint16_t>* distances) {
+    Result result;
+    const int width = walk.width;
+    const int height = walk.height;
+    const int wordsPerRow = walk.wordsPerRow;
+
+    reached = BitGrid(width, height);
+    if (distances) {
+        distances->assign(static_cast<size_t>(width) * height, UNREACHED);
+    }
+    if (!walk.get(startX, startY)) return result;
+
+    if (!distances) {
+        result.tilesReached = fillReachable(walk, startX, startY, reached);
+        return result;
+    }
+
+    struct Tile {
+        int x, y;
+    };
+    std::vector<Tile> tiles, nextTiles;
+    const uint64_t* walkWords = walk.words.data();
+    uint64_t* reachedWords = reached.words.data();
+    uint16_t* distance = distances->data();
+    uint16_t dist = 0;
+
+    // Every walkable, unreached neighbor of a frontier tile is in the next frontier
+    auto visit = [&](int x, int y) {
+        size_t w = static_cast<size_t>(y) * wordsPerRow + x / 64;
+        uint64_t bit = uint64_t(1) << (x % 64);
+        if (!(walkWords[w] & ~reachedWords[w] & bit)) return;
+
+        reachedWords[w] |= bit;
+        distance[static_cast<size_t>(y) * width + x] = dist;
+        nextTiles.push_back({ x, y });
+    };
+
+    reached.set(startX, startY, true);
+    distance[static_cast<size_t>(startY) * width + startX] = 0;
+    result.tilesReached = 1;
+    tiles.push_back({ startX, startY });
+
+    int layerIndex = 0;
+    while (!tiles.empty()) {
+        ++layerIndex;
+        dist = static_cast<uint16_t>(std::min(layerIndex, static_cast<int>(MAX_DISTANCE)));
+        nextTiles.clear();
+
+        for (const Tile& tile : tiles) {
+            if (tile.x > 0) visit(tile.x - 1, tile.y);
+            if (tile.x < width - 1) visit(tile.x + 1, tile.y);
+            if (tile.y > 0) visit(tile.x, tile.y - 1);
+            if (tile.y < height - 1) visit(tile.x, tile.y + 1);
+        }
+
+        if (!nextTiles.empty()) result.layers = layerIndex;
+        result.tilesReached += static_cast<int>(nextTiles.size());
+        std::swap(tiles, nextTiles);
+    }
+
+    return result;
+}
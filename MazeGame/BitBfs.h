@@ -0,0 +1,30 @@
+// BitBfs.h
+#pragma once
+#include "BitGrid.h"
+#include <cstdint>
+#include <vector>
+
+// Breadth-first flood fill over a packed walkability grid.
+// Reachability works on 64 tiles at a time: bit tricks fill whole runs of walkable tiles
+// in a word at once. Distance maps go tile by tile, layer after layer, with the packed
+// bits as the "already reached" flags.
+// Useful for reachability checks, distance maps and fog of war.
+namespace BitBfs {
+    // Distance value for tiles the flood never reached
+    const uint16_t UNREACHED = 0xFFFF;
+
+    // Distances larger than this are stored as this value
+    const uint16_t MAX_DISTANCE = 0xFFFE;
+
+    struct Result {
+        int tilesReached = 0;   // Number of tiles reached, including the start
+        int layers = 0;         // Steps to the farthest reached tile (only counted with distances)
+    };
+
+    // Flood from (startX, startY) over the 1-bits of `walk`.
+    // `reached` is overwritten with the tiles that were reached.
+    // If `distances` is not null it is resized to width * height (row by row) and filled
+    // with the number of steps from the start, or UNREACHED.
+    Result flood(const BitGrid& walk, int startX, int startY,
+        BitGrid& reached, std::vector<uint16_t>* distances = nullptr);
+}
@@ -0,0 +1,97 @@
+// BitGrid.h
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// A grid of on/off flags (for example "is this tile walkable"), packed 64 tiles per
+// 64-bit word. Tile x of a row is bit (x % 64) of word (x / 64).
+// Every row is padded to a multiple of 4 words (256 tiles) so SIMD code can always
+// read whole 256-bit blocks. Padding bits are always 0.
+struct BitGrid {
+    static constexpr int BLOCK_WORDS = 4;
+
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    std::vector<uint64_t> words;
+
+    BitGrid() = default;
+
+    BitGrid(int w, int h)
+        : width(w), height(h),
+        wordsPerRow((w + 64 * BLOCK_WORDS - 1) / (64 * BLOCK_WORDS) * BLOCK_WORDS),
+        words(static_cast<size_t>(wordsPerRow) * h, 0) {
+    }
+
+    bool get(int x, int y) const {
+        if (x < 0 || x >= width || y < 0 || y >= height) return false;
+        return (words[static_cast<size_t>(y) * wordsPerRow + x / 64] >> (x % 64)) & 1;
+    }
+
+    void set(int x, int y, bool on) {
+        uint64_t& word = words[static_cast<size_t>(y) * wordsPerRow + x / 64];
+        uint64_t bit = uint64_t(1) << (x % 64);
+        word = on ? (word | bit) : (word & ~bit);
+    }
+
+    const uint64_t* row(int y) const { return &words[static_cast<size_t>(y) * wordsPerRow]; }
+    uint64_t* row(int y) { return &words[static_cast<size_t>(y) * wordsPerRow]; }
+};
+
+// FNV-1a hash of a layout's size and walkable bits, used to tell layouts apart. Only the
+// words that hold tiles are mixed in, one row after the other, so any format that keeps a
+// row as 64-tile words (MappedMaze does) can work out the same hash while writing.
+struct LayoutHash {
+    uint64_t value = 1469598103934665603ull;
+
+    LayoutHash(int width, int height) {
+        mix(static_cast<uint64_t>(width));
+        mix(static_cast<uint64_t>(height));
+    }
+
+    void mix(uint64_t word) {
+        for (int i = 0; i < 8; ++i) {
+            value ^= (word >> (i * 8)) & 0xFF;
+            value *= 1099511628211ull;
+        }
+    }
+};
+
+inline uint64_t hashLayout(const BitGrid& walk) {
+    LayoutHash hash(walk.width, walk.height);
+    const int usedWords = (walk.width + 63) / 64;
+    for (int y = 0; y < walk.height; ++y) {
+        const uint64_t* row = walk.row(y);
+        for (int word = 0; word < usedWords; ++word) hash.mix(row[word]);
+    }
+    return hash.value;
+}
+
+// Number of 1-bits in a word
+inline int countBits(uint64_t word) {
+    return static_cast<int>(std::bitset<64>(word).count());
+}
+
+// Index of the lowest 1-bit in a word (word must not be 0)
+inline int lowestBit(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
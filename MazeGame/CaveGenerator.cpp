@@ -0,0 +1,286 @@
+// CaveGenerator.cpp
+#include "CaveGenerator.h"
+#include "BitBfs.h"
+#include "ComponentLabels.h"
+#include "GameConfig.h"
+#include "MazeGenerator.h"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <utility>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CAVE_AVX2_AVAILABLE 1
+#include <immintrin.h>
+#endif
+
+// MSVC allows AVX2 intrinsics in any function, GCC/Clang need the function marked
+#if defined(CAVE_AVX2_AVAILABLE) && (defined(__GNUC__) || defined(__clang__))
+#define CAVE_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CAVE_AVX2_TARGET
+#endif
+
+// How a step counts neighbors for 64 tiles at once: bit x of a word stands for tile x, so
+// a whole word of "is tile x floor" flags can be added to another word of flags with AND,
+// OR and XOR, just like adding two numbers bit by bit in school, only for 64 tiles side by
+// side. First each row adds every tile to its left and right neighbor (0..3, two bits).
+// Then the sums of three rows are added (0..9, four bits) and compared with 5.
+
+namespace {
+    const uint8_t GOAL = 4;
+
+    // Seeds generateLayout tries before it gives up looking for a big enough cave
+    const int MAX_LAYOUT_ATTEMPTS = 16;
+
+    // Adds three flag words: every bit position gets a + b + c as a low and a high bit
+    inline void add3(uint64_t a, uint64_t b, uint64_t c, uint64_t& low, uint64_t& high) {
+        uint64_t ab = a ^ b;
+        low = ab ^ c;
+        high = (a & b) | (ab & c);
+    }
+
+    // Bit x of the result: 1 if 5 or more of the 9 tiles around tile x are floor, given the
+    // row sums (low and high bit) of the row above, the row itself and the row below
+    inline uint64_t atLeastFive(uint64_t low1, uint64_t high1, uint64_t low2, uint64_t high2,
+        uint64_t low3, uint64_t high3) {
+        uint64_t ones, twosA, twosB, fours;
+        add3(low1, low2, low3, ones, twosA);
+        add3(high1, high2, high3, twosB, fours);
+        uint64_t twos = twosA ^ twosB;
+        uint64_t foursCarry = twosA & twosB;
+        uint64_t foursSum = fours ^ foursCarry;
+        uint64_t eights = fours & foursCarry;
+        return eights | (foursSum & (twos | ones));
+    }
+
+    // Every tile of word w plus its left and right neighbor
+    inline void rowSum(const uint64_t* row, int w, int words, uint64_t& low, uint64_t& high) {
+        uint64_t middle = row[w];
+        uint64_t left = (middle << 1) | (w > 0 ? row[w - 1] >> 63 : 0);
+        uint64_t right = (middle >> 1) | (w + 1 < words ? row[w + 1] << 63 : 0);
+        add3(left, middle, right, low, high);
+    }
+
+    // One row of a step. `mask` has the tiles that may become floor (not the wall ring).
+    void stepRowScalar(const uint64_t* above, const uint64_t* row, const uint64_t* below,
+        const uint64_t* mask, uint64_t* out, int words) {
+        for (int w = 0; w < words; ++w) {
+            uint64_t low1, high1, low2, high2, low3, high3;
+            rowSum(above, w, words, low1, high1);
+            rowSum(row, w, words, low2, high2);
+            rowSum(below, w, words, low3, high3);
+            out[w] = atLeastFive(low1, high1, low2, high2, low3, high3) & mask[w];
+        }
+    }
+
+#ifdef CAVE_AVX2_AVAILABLE
+    CAVE_AVX2_TARGET
+    inline void add3Avx2(__m256i a, __m256i b, __m256i c, __m256i& low, __m256i& high) {
+        __m256i ab = _mm256_xor_si256(a, b);
+        low = _mm256_xor_si256(ab, c);
+        high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(ab, c));
+    }
+
+    // Same as rowSum for a block of 4 words
+    CAVE_AVX2_TARGET
+    inline void rowSumAvx2(const uint64_t* row, int base, int words, __m256i& low, __m256i& high) {
+        __m256i middle = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + base));
+        uint64_t prevWord = base > 0 ? row[base - 1] : 0;
+        uint64_t nextWord = base + BitGrid::BLOCK_WORDS < words ? row[base + BitGrid::BLOCK_WORDS] : 0;
+
+        // Lanes shifted by one word: [prev, m0, m1, m2] and [m1, m2, m3, next]
+        __m256i wordsBefore = _mm256_blend_epi32(
+            _mm256_permute4x64_epi64(middle, _MM_SHUFFLE(2, 1, 0, 3)),
+            _mm256_set1_epi64x(static_cast<long long>(prevWord)), 0x03);
+        __m256i wordsAfter = _mm256_blend_epi32(
+            _mm256_permute4x64_epi64(middle, _MM_SHUFFLE(0, 3, 2, 1)),
+            _mm256_set1_epi64x(static_cast<long long>(nextWord)), 0xC0);
+
+        __m256i left = _mm256_or_si256(_mm256_slli_epi64(middle, 1), _mm256_srli_epi64(wordsBefore, 63));
+        __m256i right = _mm256_or_si256(_mm256_srli_epi64(middle, 1), _mm256_slli_epi64(wordsAfter, 63));
+        add3Avx2(left, middle, right, low, high);
+    }
+
+    // Same as stepRowScalar, a block of 4 words (256 tiles) at a time
+    CAVE_AVX2_TARGET
+    void stepRowAvx2(const uint64_t* above, const uint64_t* row, const uint64_t* below,
+        const uint64_t* mask, uint64_t* out, int words) {
+        for (int base = 0; base < words; base += BitGrid::BLOCK_WORDS) {
+            __m256i low1, high1, low2, high2, low3, high3;
+            rowSumAvx2(above, base, words, low1, high1);
+            rowSumAvx2(row, base, words, low2, high2);
+            rowSumAvx2(below, base, words, low3, high3);
+
+            __m256i ones, twosA, twosB, fours;
+            add3Avx2(low1, low2, low3, ones, twosA);
+            add3Avx2(high1, high2, high3, twosB, fours);
+            __m256i twos = _mm256_xor_si256(twosA, twosB);
+            __m256i foursCarry = _mm256_and_si256(twosA, twosB);
+            __m256i foursSum = _mm256_xor_si256(fours, foursCarry);
+            __m256i eights = _mm256_and_si256(fours, foursCarry);
+            __m256i isFloor = _mm256_or_si256(eights, _mm256_and_si256(foursSum, _mm256_or_si256(twos, ones)));
+
+            __m256i keep = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + base));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + base), _mm256_and_si256(isFloor, keep));
+        }
+    }
+#endif
+
+    using StepRowFn = void(*)(const uint64_t*, const uint64_t*, const uint64_t*, const uint64_t*, uint64_t*, int);
+
+    StepRowFn pickKernel() {
+#ifdef CAVE_AVX2_AVAILABLE
+        if (SDL_HasAVX2()) return stepRowAvx2;
+#endif
+        return stepRowScalar;
+    }
+
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Connect the top-left tile to the cave along the shortest way through the rock
+    void digToStart(BitGrid& walk) {
+        const int width = walk.width;
+        const int height = walk.height;
+        if (width < 3 || height < 3 || walk.get(1, 1)) return;
+
+        std::vector<int> cameFrom(static_cast<size_t>(width) * height, -1);
+        std::vector<int> queue = { width + 1 };
+        cameFrom[width + 1] = width + 1;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int tile = queue[head];
+            int x = tile % width;
+            int y = tile / width;
+            if (walk.get(x, y)) {
+                for (; tile != width + 1; tile = cameFrom[tile]) {
+                    walk.set(tile % width, tile / width, true);
+                }
+                break;
+            }
+
+            const int neighbors[4][2] = { { x, y - 1 }, { x + 1, y }, { x, y + 1 }, { x - 1, y } };
+            for (const auto& n : neighbors) {
+                if (n[0] < 1 || n[0] >= width - 1 || n[1] < 1 || n[1] >= height - 1) continue;
+                int next = n[1] * width + n[0];
+                if (cameFrom[next] >= 0) continue;
+                cameFrom[next] = tile;
+                queue.push_back(next);
+            }
+        }
+        walk.set(1, 1, true);
+    }
+}
+
+void CaveGenerator::fillRandom(BitGrid& walk, int wallPercent, uint32_t seed) {
+    std::fill(walk.words.begin(), walk.words.end(), 0);
+    uint32_t random = seed * 2654435761u + 0x7F4A7C15u;
+    if (random == 0) random = 1;
+
+    for (int y = 1; y < walk.height - 1; ++y) {
+        for (int x = 1; x < walk.width - 1; ++x) {
+            if (static_cast<int>(nextRandom(random) % 100) >= wallPercent) walk.set(x, y, true);
+        }
+    }
+}
+
+void CaveGenerator::step(const BitGrid& from, BitGrid& to) {
+    if (to.width != from.width || to.height != from.height) to = BitGrid(from.width, from.height);
+    std::fill(to.words.begin(), to.words.end(), 0);
+    if (from.width < 3 || from.height < 3) return;
+
+    // Tiles 1 .. width - 2 may become floor
+    const int words = from.wordsPerRow;
+    std::vector<uint64_t> mask(words, 0);
+    for (int x = 1; x < from.width - 1; ++x) {
+        mask[x / 64] |= uint64_t(1) << (x % 64);
+    }
+
+    static const StepRowFn stepRow = pickKernel();
+    for (int y = 1; y < from.height - 1; ++y) {
+        stepRow(from.row(y - 1), from.row(y), from.row(y + 1), mask.data(), to.row(y), words);
+    }
+}
+
+int CaveGenerator::keepLargestArea(BitGrid& walk) {
+    ComponentLabels areas;
+    areas.build(walk);
+    const int count = areas.getComponentCount();
+    if (count <= 1) return 0;
+
+    // Size of every area, and a tile of each to start a flood from
+    std::vector<int> sizes(count, 0);
+    std::vector<std::pair<int, int>> firstTile(count, { -1, -1 });
+    int floorTiles = 0;
+    for (int y = 0; y < walk.height; ++y) {
+        const uint64_t* row = walk.row(y);
+        for (int w = 0; w < walk.wordsPerRow; ++w) {
+            for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+                int x = w * 64 + lowestBit(bits);
+                int area = areas.componentAt(x, y);
+                if (sizes[area]++ == 0) firstTile[area] = { x, y };
+                ++floorTiles;
+            }
+        }
+    }
+
+    int largest = static_cast<int>(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    BitGrid reached;
+    BitBfs::flood(walk, firstTile[largest].first, firstTile[largest].second, reached);
+    walk = std::move(reached);
+    return floorTiles - sizes[largest];
+}
+
+void CaveGenerator::generate(BitGrid& walk, uint32_t seed, int wallPercent, int steps) {
+    fillRandom(walk, wallPercent, seed);
+    BitGrid next(walk.width, walk.height);
+    for (int i = 0; i < steps; ++i) {
+        step(walk, next);
+        std::swap(walk, next);
+    }
+    keepLargestArea(walk);
+}
+
+std::vector<std::vector<int>> CaveGenerator::generateLayout(int width, int height, uint32_t seed) {
+    BitGrid walk(width, height);
+    std::vector<uint8_t> tiles(static_cast<size_t>(width) * height);
+    const int minFloor = width * height * MIN_FLOOR_PERCENT / 100;
+    for (int attempt = 0; attempt < MAX_LAYOUT_ATTEMPTS; ++attempt, ++seed) {
+        generate(walk, seed);
+        digToStart(walk);
+
+        int floor = 0;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                tiles[static_cast<size_t>(y) * width + x] = walk.get(x, y) ? 1 : 0;
+                floor += walk.get(x, y) ? 1 : 0;
+            }
+        }
+        const bool lastAttempt = attempt + 1 == MAX_LAYOUT_ATTEMPTS;
+        if (floor < minFloor && !lastAttempt) continue;
+
+        MazeGenerator::placeObjects(tiles.data(), width, height, seed, GameConfig::MAX_ITEMS, GameConfig::MAX_ENEMIES);
+        if (std::find(tiles.begin(), tiles.end(), GOAL) != tiles.end()) break;
+    }
+
+    // After MAX_LAYOUT_ATTEMPTS bad seeds in a row the last cave is used however small it is
+    std::vector<std::vector<int>> layout(height, std::vector<int>(width));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            layout[y][x] = tiles[static_cast<size_t>(y) * width + x];
+        }
+    }
+    return layout;
+}
+
+bool CaveGenerator::usesAvx2() {
+#ifdef CAVE_AVX2_AVAILABLE
+    return SDL_HasAVX2();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,46 @@
+// CaveGenerator.h
+#pragma once
+#include "BitGrid.h"
+#include <cstdint>
+#include <vector>
+
+// Makes organic-looking caves instead of mazes, with a cellular automaton.
+//
+// The grid starts out as random noise. Then, a few times over, every tile looks at itself
+// and its 8 neighbors: with 5 or more floor tiles among those 9 it becomes floor, otherwise
+// wall (the "4-5 rule"). Noise clumps together into rounded caves this way. Afterwards only
+// the biggest connected cave is kept, so every floor tile can be reached from every other.
+//
+// Grids are BitGrids with 1 = floor. A step works on 64 tiles at a time: the neighbor counts
+// of a whole word are added up bit by bit with adder logic instead of tile by tile. The
+// outermost ring of tiles is always wall.
+namespace CaveGenerator {
+    // Start with this many percent walls, then run this many steps
+    const int DEFAULT_WALL_PERCENT = 45;
+    const int DEFAULT_STEPS = 4;
+
+    // generateLayout tries the next seed when the cave has less floor than this many percent
+    // of the grid (a few seeds leave only a tiny cave, or none at all)
+    const int MIN_FLOOR_PERCENT = 20;
+
+    // Random noise with about wallPercent percent walls (and a wall ring around it)
+    void fillRandom(BitGrid& walk, int wallPercent, uint32_t seed);
+
+    // One step of the 4-5 rule from `from` into `to` (resized to match if needed)
+    void step(const BitGrid& from, BitGrid& to);
+
+    // Turn every floor tile that isn't part of the biggest connected area into wall.
+    // Returns how many tiles were filled in.
+    int keepLargestArea(BitGrid& walk);
+
+    // Noise, steps and cleanup in one go; `walk` decides the size
+    void generate(BitGrid& walk, uint32_t seed, int wallPercent = DEFAULT_WALL_PERCENT, int steps = DEFAULT_STEPS);
+
+    // A complete layout for Maze::loadLayout: a cave with the player in the top-left tile,
+    // the goal as far away as possible, and GameConfig's item and enemy counts. If the cave is
+    // too small or has no room for a goal, seed + 1, seed + 2 and so on are tried instead.
+    std::vector<std::vector<int>> generateLayout(int width, int height, uint32_t seed);
+
+    // True when the build uses the AVX2 version of the step kernel
+    bool usesAvx2();
+}
@@ -0,0 +1,215 @@
+// ChunkWorld.cpp
+#include "ChunkWorld.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    // Carved one tile bigger than a chunk: the extra column and row are the next chunks'
+    // walls, so every cell of the chunk (odd coordinates up to CHUNK_SIZE - 1) fits
+    const int CARVE_SIZE = ChunkWorld::CHUNK_SIZE + 1;
+    const int CELLS = ChunkWorld::CHUNK_SIZE / 2;
+
+    // Random numbers for one chunk, worked out from the seed and the chunk coordinates alone
+    uint32_t chunkRandom(uint32_t seed, int64_t chunkX, int64_t chunkY) {
+        uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ (static_cast<uint64_t>(chunkX) * 0xD6E8FEB86659FD93ull)
+            ^ static_cast<uint64_t>(chunkY);
+        z += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        uint32_t state = static_cast<uint32_t>(z);
+        return state != 0 ? state : 1;
+    }
+
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    int64_t keyX(uint64_t key) { return static_cast<int32_t>(key >> 32); }
+    int64_t keyY(uint64_t key) { return static_cast<int32_t>(key & 0xFFFFFFFFu); }
+}
+
+ChunkWorld::ChunkWorld(uint32_t seed, size_t memoryBytes)
+    : seed(seed) {
+    // The chunks around the player must fit, or prefetching would throw out what it just made
+    const size_t aroundPlayer = static_cast<size_t>(GameConfig::WORLD_PREFETCH_RADIUS * 2 + 2)
+        * (GameConfig::WORLD_PREFETCH_RADIUS * 2 + 2);
+    const size_t chunkBytes = sizeof(Chunk) + sizeof(CacheEntry) + 4 * sizeof(void*);
+    maxChunks = std::max(memoryBytes / chunkBytes, aroundPlayer);
+}
+
+ChunkWorld::~ChunkWorld() {
+    stop();
+}
+
+void ChunkWorld::makeChunk(uint32_t seed, int64_t chunkX, int64_t chunkY, MazeGenerator& generator,
+    std::vector<uint8_t>& tiles, uint64_t* rows) {
+    uint32_t random = chunkRandom(seed, chunkX, chunkY);
+    tiles.resize(static_cast<size_t>(CARVE_SIZE) * CARVE_SIZE);
+    generator.carve(MazeGenerator::Algorithm::BACKTRACKER, tiles.data(), CARVE_SIZE, CARVE_SIZE, nextRandom(random));
+
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        const uint8_t* tile = &tiles[static_cast<size_t>(y) * CARVE_SIZE];
+        uint64_t row = 0;
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            row |= static_cast<uint64_t>(tile[x] != 0) << x;
+        }
+        rows[y] = row;
+    }
+
+    // Doors in the left wall and the top wall, each next to a cell on both sides
+    for (int door = 0; door < GameConfig::WORLD_CHUNK_DOORS; ++door) {
+        int left = 1 + 2 * static_cast<int>(nextRandom(random) % CELLS);
+        int top = 1 + 2 * static_cast<int>(nextRandom(random) % CELLS);
+        rows[left] |= 1;
+        rows[0] |= uint64_t(1) << top;
+    }
+}
+
+std::shared_ptr<const ChunkWorld::Chunk> ChunkWorld::make(uint64_t key, MazeGenerator& generator,
+    std::vector<uint8_t>& tiles) const {
+    auto chunk = std::make_shared<Chunk>();
+    makeChunk(seed, keyX(key), keyY(key), generator, tiles, chunk->rows);
+    return chunk;
+}
+
+std::shared_ptr<const ChunkWorld::Chunk> ChunkWorld::find(uint64_t key) {
+    auto found = cacheIndex.find(key);
+    if (found != cacheIndex.end()) {
+        // Mark as most recently used
+        cache.splice(cache.begin(), cache, found->second);
+        return found->second->chunk;
+    }
+
+    // A changed chunk that was thrown out of the cache comes back as it was changed
+    auto changed = edited.find(key);
+    if (changed != edited.end()) return insert(key, changed->second);
+    return nullptr;
+}
+
+std::shared_ptr<const ChunkWorld::Chunk> ChunkWorld::insert(uint64_t key, std::shared_ptr<const Chunk> chunk) {
+    auto found = cacheIndex.find(key);
+    if (found != cacheIndex.end()) return found->second->chunk;   // Someone else was faster
+
+    cache.push_front({ key, std::move(chunk) });
+    cacheIndex[key] = cache.begin();
+    while (cache.size() > maxChunks) {
+        cacheIndex.erase(cache.back().key);
+        cache.pop_back();
+        ++evicted;
+    }
+    return cache.front().chunk;
+}
+
+void ChunkWorld::useChunk(uint64_t key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = find(key);
+    }
+    currentKey = key;
+    if (current) return;
+
+    // Not made yet: make it right here, without holding the lock
+    std::shared_ptr<const Chunk> chunk = make(key, generator, tiles);
+    ++misses;
+    std::lock_guard<std::mutex> lock(mutex);
+    current = insert(key, std::move(chunk));
+}
+
+void ChunkWorld::setWalkable(int64_t x, int64_t y, bool walkable) {
+    uint64_t key = chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    if (key != currentKey || !current) useChunk(key);
+
+    // Chunks are shared with whoever looked at them, so the change goes into a copy
+    auto changed = std::make_shared<Chunk>(*current);
+    uint64_t bit = uint64_t(1) << (x & CHUNK_MASK);
+    uint64_t& row = changed->rows[y & CHUNK_MASK];
+    row = walkable ? (row | bit) : (row & ~bit);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    edited[key] = changed;
+    auto found = cacheIndex.find(key);
+    if (found != cacheIndex.end()) found->second->chunk = changed;
+    else insert(key, changed);
+    current = changed;
+}
+
+void ChunkWorld::prefetchAround(int64_t x, int64_t y) {
+    const int64_t centerX = x >> CHUNK_SHIFT;
+    const int64_t centerY = y >> CHUNK_SHIFT;
+    const uint64_t center = chunkKey(centerX, centerY);
+    if (hasPrefetchCenter && center == prefetchCenter) return;
+    hasPrefetchCenter = true;
+    prefetchCenter = center;
+
+    const int radius = GameConfig::WORLD_PREFETCH_RADIUS;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+
+        // Only the newest area matters; chunks still wanted for an old one are dropped.
+        // Farthest first, so the nearest chunks end up at the back and are made first.
+        wanted.clear();
+        for (int ring = radius; ring >= 0; --ring) {
+            for (int dy = -ring; dy <= ring; ++dy) {
+                for (int dx = -ring; dx <= ring; ++dx) {
+                    if (std::max(std::abs(dx), std::abs(dy)) != ring) continue;
+                    uint64_t key = chunkKey(centerX + dx, centerY + dy);
+                    if (!cacheIndex.count(key)) wanted.push_back(key);
+                }
+            }
+        }
+        if (wanted.empty()) return;
+
+        // The thread is only started once there is something to do
+        if (!thread.joinable()) thread = std::thread(&ChunkWorld::run, this);
+    }
+    wake.notify_one();
+}
+
+void ChunkWorld::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (thread.joinable()) thread.join();
+}
+
+int ChunkWorld::getCachedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(cache.size());
+}
+
+void ChunkWorld::run() {
+    // The background thread's own generator, so it never shares work buffers with the caller
+    MazeGenerator workerGenerator;
+    std::vector<uint8_t> workerTiles;
+
+    while (true) {
+        uint64_t key;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || !wanted.empty(); });
+            if (stopping) return;
+            key = wanted.back();
+            wanted.pop_back();
+            if (cacheIndex.count(key) || edited.count(key)) continue;
+        }
+
+        // The lock is only held to put the finished chunk in, never while making it
+        std::shared_ptr<const Chunk> chunk = make(key, workerGenerator, workerTiles);
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // The player may have changed this chunk while it was being made, and it may even
+        // have been thrown out of the cache since; the fresh copy must not hide the change
+        if (edited.count(key)) continue;
+        if (!cacheIndex.count(key)) ++prefetched;
+        insert(key, std::move(chunk));
+    }
+}
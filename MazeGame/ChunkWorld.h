@@ -0,0 +1,134 @@
+// ChunkWorld.h
+#pragma once
+#include "MazeGenerator.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A maze with no edges, split into square chunks of CHUNK_SIZE x CHUNK_SIZE tiles.
+//
+// A chunk is made the first time one of its tiles is looked at, from nothing but the seed
+// and its chunk coordinates, so it always comes out the same. Inside, every chunk is a
+// perfect maze (MazeGenerator). Its left column and top row are wall, except for a few
+// doors into the chunk on the left and the one above; the chunk decides those doors on
+// its own, so neighbors never have to be made together and the whole world is connected.
+//
+// Chunks are kept in a cache that throws away the one used longest ago once the memory cap
+// is reached; coming back later simply makes it again. Chunks around the player can be
+// made ahead of time on a background thread (prefetchAround), so walking into a new chunk
+// doesn't have to wait for it.
+//
+// isWalkable, setWalkable and prefetchAround must all be called from the same thread;
+// only the background thread runs next to it.
+class ChunkWorld {
+public:
+    // Fixed, so one row of a chunk is exactly one 64-bit word (bit x = tile x)
+    static constexpr int CHUNK_SIZE = 64;
+
+    // memoryBytes caps the cache (a chunk takes a bit more than 512 bytes)
+    ChunkWorld(uint32_t seed, size_t memoryBytes);
+    ~ChunkWorld();
+
+    ChunkWorld(const ChunkWorld&) = delete;
+    ChunkWorld& operator=(const ChunkWorld&) = delete;
+
+    // Tile (x, y) of the world; any coordinates work, negative ones too. Looking at the
+    // same chunk as last time is only a compare and a bit test.
+    bool isWalkable(int64_t x, int64_t y) {
+        uint64_t key = chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+        if (key != currentKey || !current) useChunk(key);
+        return (current->rows[y & CHUNK_MASK] >> (x & CHUNK_MASK)) & 1;
+    }
+
+    // Change a tile. Changed chunks are never thrown out of the cache, so the change stays.
+    void setWalkable(int64_t x, int64_t y, bool walkable);
+
+    // Have the chunks within GameConfig::WORLD_PREFETCH_RADIUS of the chunk holding tile
+    // (x, y) made on the background thread. Returns right away; cheap to call every frame.
+    void prefetchAround(int64_t x, int64_t y);
+
+    // Stop the background thread (also done by the destructor)
+    void stop();
+
+    // Chunks made on the calling thread because they weren't ready when looked at
+    int getMissCount() const { return misses; }
+    // Chunks made ahead of time on the background thread
+    int getPrefetchCount() const { return prefetched; }
+    // Chunks thrown out of the cache to stay under the memory cap
+    int getEvictedCount() const { return evicted; }
+    int getCachedCount();
+
+    // Carve chunk (chunkX, chunkY) of the world made from `seed` into `rows`
+    static void makeChunk(uint32_t seed, int64_t chunkX, int64_t chunkY, MazeGenerator& generator,
+        std::vector<uint8_t>& tiles, uint64_t* rows);
+
+private:
+    static constexpr int CHUNK_SHIFT = 6;
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+
+    struct Chunk {
+        uint64_t rows[CHUNK_SIZE];
+    };
+
+    // Chunk coordinates wrap around after 2^31 chunks in each direction
+    static uint64_t chunkKey(int64_t chunkX, int64_t chunkY) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+    }
+
+    struct CacheEntry {
+        uint64_t key;
+        std::shared_ptr<const Chunk> chunk;
+    };
+
+    const uint32_t seed;
+    size_t maxChunks;
+
+    // The chunk looked at last; only used by the calling thread, so it needs no lock.
+    // Holding it keeps it alive even if the cache throws it out meanwhile.
+    uint64_t currentKey = 0;
+    std::shared_ptr<const Chunk> current;
+
+    // Generator and buffer for chunks made on the calling thread
+    MazeGenerator generator;
+    std::vector<uint8_t> tiles;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    // Guarded by `mutex`. Most recently used chunks are at the front, the oldest gets
+    // evicted from the back. Changed chunks also live in `edited`, which is never trimmed.
+    std::list<CacheEntry> cache;
+    std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> cacheIndex;
+    std::unordered_map<uint64_t, std::shared_ptr<const Chunk>> edited;
+    std::vector<uint64_t> wanted;   // Chunks for the background thread, the one to make next at the back
+    bool stopping = false;
+
+    bool hasPrefetchCenter = false;
+    uint64_t prefetchCenter = 0;
+
+    std::atomic<int> misses{ 0 };
+    std::atomic<int> prefetched{ 0 };
+    std::atomic<int> evicted{ 0 };
+
+    // Slow path of isWalkable: find the chunk in the cache or make it now
+    void useChunk(uint64_t key);
+
+    // Put a chunk at the front of the cache (unless it is already there) and trim the
+    // cache to maxChunks; returns the cached chunk. Call with `mutex` held.
+    std::shared_ptr<const Chunk> insert(uint64_t key, std::shared_ptr<const Chunk> chunk);
+
+    // Look a chunk up and mark it as most recently used; null if it isn't cached.
+    // Call with `mutex` held.
+    std::shared_ptr<const Chunk> find(uint64_t key);
+
+    std::shared_ptr<const Chunk> make(uint64_t key, MazeGenerator& generator, std::vector<uint8_t>& tiles) const;
+
+    void run();
+};
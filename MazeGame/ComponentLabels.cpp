@@ -0,0 +1,128 @@
+// ComponentLabels.cpp
+#include "ComponentLabels.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    // Bits where a run of 1s starts / ends in word `index` of a row
+    uint64_t runStarts(const uint64_t* row, int index) {
+        uint64_t carry = index > 0 ? row[index - 1] >> 63 : 0;
+        return row[index] & ~((row[index] << 1) | carry);
+    }
+
+    // Bits 0 .. bit of a word
+    uint64_t bitsUpTo(int bit) {
+        return bit == 63 ? ~uint64_t(0) : (uint64_t(2) << bit) - 1;
+    }
+
+    // Runs function(firstRow, endRow) for `bands` slices of the rows, one thread each
+    template <typename Function>
+    void forEachBand(int bands, int height, Function function) {
+        std::vector<std::thread> workers;
+        for (int band = 1; band < bands; ++band) {
+            workers.emplace_back(function, height * band / bands, height * (band + 1) / bands);
+        }
+        function(0, height / bands);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+void ComponentLabels::build(const BitGrid& walkGrid, int threadCount) {
+    walk = walkGrid;
+    const int height = walk.height;
+    const int wordsPerRow = walk.wordsPerRow;
+
+    int bands = threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    bands = std::max(1, std::min(bands, height / 16));
+
+    // Count the runs starting in every word, then number them in reading order
+    wordFirstRun.assign(walk.words.size() + 1, 0);
+    forEachBand(bands, height, [&](int first, int end) {
+        for (int y = first; y < end; ++y) {
+            const uint64_t* row = walk.row(y);
+            int* counts = &wordFirstRun[static_cast<size_t>(y) * wordsPerRow + 1];
+            for (int i = 0; i < wordsPerRow; ++i) {
+                counts[i] = row[i] ? countBits(runStarts(row, i)) : 0;
+            }
+        }
+    });
+    for (size_t i = 1; i < wordFirstRun.size(); ++i) {
+        wordFirstRun[i] += wordFirstRun[i - 1];
+    }
+    runLabel.resize(wordFirstRun.back());
+
+    // Each band only joins runs inside its own rows, so the bands never touch the same ids
+    forEachBand(bands, height, [&](int first, int end) {
+        int firstRun = wordFirstRun[static_cast<size_t>(first) * wordsPerRow];
+        int endRun = wordFirstRun[static_cast<size_t>(end) * wordsPerRow];
+        for (int run = firstRun; run < endRun; ++run) {
+            runLabel[run] = run;
+        }
+        for (int y = first + 1; y < end; ++y) {
+            joinRows(y);
+        }
+    });
+
+    // Stitch the bands together along the rows where they meet
+    for (int band = 1; band < bands; ++band) {
+        joinRows(height * band / bands);
+    }
+
+    // A run's parent always has a smaller id, so going up in id order every parent
+    // already holds its final component number
+    componentCount = 0;
+    for (size_t run = 0; run < runLabel.size(); ++run) {
+        int parent = runLabel[run];
+        runLabel[run] = parent == static_cast<int>(run) ? componentCount++ : runLabel[parent];
+    }
+}
+
+int ComponentLabels::componentAt(int x, int y) const {
+    if (!walk.get(x, y)) return -1;
+
+    // The tile is on the last run that starts at or before it
+    int word = x / 64;
+    size_t index = static_cast<size_t>(y) * walk.wordsPerRow + word;
+    int startsBefore = countBits(runStarts(walk.row(y), word) & bitsUpTo(x % 64));
+    return runLabel[wordFirstRun[index] + startsBefore - 1];
+}
+
+void ComponentLabels::join(int a, int b) {
+    // Rem's union-find: walk up from both runs at once, always moving the one whose
+    // parent is larger and hooking it onto the other's parent on the way, until both
+    // reach the same parent
+    while (runLabel[a] != runLabel[b]) {
+        if (runLabel[a] < runLabel[b]) std::swap(a, b);
+        int next = runLabel[a];
+        runLabel[a] = runLabel[b];
+        if (next == a) return;
+        a = next;
+    }
+}
+
+void ComponentLabels::joinRows(int y) {
+    const int wordsPerRow = walk.wordsPerRow;
+    const uint64_t* above = walk.row(y - 1);
+    const uint64_t* row = walk.row(y);
+    const int* aboveFirstRun = &wordFirstRun[static_cast<size_t>(y - 1) * wordsPerRow];
+    const int* rowFirstRun = &wordFirstRun[static_cast<size_t>(y) * wordsPerRow];
+
+    // Tiles walkable in both rows connect the runs they are on. A stretch of such tiles
+    // always lies on the same two runs, so only the first tile of each stretch is needed.
+    uint64_t carry = 0;
+    for (int i = 0; i < wordsPerRow; ++i) {
+        uint64_t touching = above[i] & row[i];
+        uint64_t stretchStarts = touching & ~((touching << 1) | carry);
+        carry = touching >> 63;
+        if (!stretchStarts) continue;
+
+        uint64_t aboveStarts = runStarts(above, i);
+        uint64_t rowStarts = runStarts(row, i);
+        for (; stretchStarts; stretchStarts &= stretchStarts - 1) {
+            uint64_t upTo = bitsUpTo(lowestBit(stretchStarts));
+            join(aboveFirstRun[i] + countBits(aboveStarts & upTo) - 1, rowFirstRun[i] + countBits(rowStarts & upTo) - 1);
+        }
+    }
+}
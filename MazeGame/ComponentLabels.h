@@ -0,0 +1,42 @@
+// ComponentLabels.h
+#pragma once
+#include "BitGrid.h"
+#include <vector>
+
+// Splits the walkable tiles into connected areas ("components"): two tiles get the
+// same number exactly when you can walk from one to the other.
+//
+// Instead of labeling tiles one by one, each row is cut into runs of walkable tiles,
+// and runs that touch a run in the row above are joined with union-find. Both steps
+// work on 64 tiles at a time with bit tricks. Bands of rows are handled on separate threads and stitched together
+// at the end. Components are numbered in the order their first tile appears, so the
+// result is the same for any thread count.
+class ComponentLabels {
+public:
+    // Label all walkable tiles of `walk` using `threadCount` threads (0 = one per core)
+    void build(const BitGrid& walk, int threadCount = 0);
+
+    // Component number of a tile (0 .. getComponentCount() - 1), or -1 for walls
+    int componentAt(int x, int y) const;
+
+    int getComponentCount() const { return componentCount; }
+    int getRunCount() const { return static_cast<int>(runLabel.size()); }
+
+private:
+    BitGrid walk;
+    int componentCount = 0;
+
+    // Runs get ids in reading order; wordFirstRun[i] is the id of the first run that
+    // starts in word i of walk.words or later. Counting the run starts in front of a
+    // tile then gives the id of the run it is on, so run positions are never stored.
+    std::vector<int> wordFirstRun;
+
+    // While building: union-find parent of each run (always a run with a smaller id).
+    // Afterwards: the component of each run.
+    std::vector<int> runLabel;
+
+    void join(int a, int b);
+
+    // Join the runs of row y to the runs of row y - 1 they touch
+    void joinRows(int y);
+};
@@ -0,0 +1,601 @@
+// ContractionHierarchy.cpp
+#include "ContractionHierarchy.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace {
+    const char FILE_MAGIC[4] = { 'M', 'Z', 'C', 'H' };
+    const uint32_t FILE_VERSION = 2;
+
+    // Magic, version, width, height, layout hash, node, arc, shortcut and junction counts
+    const uint64_t FILE_HEADER_SIZE = 40;
+
+    const int WALL = -1;
+
+    // Witness searches give up after settling this many nodes and add the shortcut anyway.
+    // That never breaks queries, it only costs a few extra arcs.
+    const int WITNESS_SETTLE_LIMIT = 500;
+
+    const int STEP_X[4] = { 0, 1, 0, -1 };
+    const int STEP_Y[4] = { -1, 0, 1, 0 };
+
+    struct Shortcut {
+        int from, to;
+        int weight;
+    };
+
+    using Heap = std::greater<std::pair<int, int>>;
+
+    // Run function(begin, end, worker) over [0, count) split into one slice per thread
+    template <typename Function>
+    void parallelFor(int threadCount, size_t count, Function function) {
+        if (threadCount <= 1 || count < static_cast<size_t>(threadCount) * 16) {
+            function(size_t(0), count, 0);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (int worker = 1; worker < threadCount; ++worker) {
+            workers.emplace_back(function, count * worker / threadCount, count * (worker + 1) / threadCount, worker);
+        }
+        function(size_t(0), count / threadCount, 0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    template <typename T>
+    void writeValue(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
+
+void ContractionHierarchy::Search::begin(size_t nodeCount) {
+    if (dist.size() != nodeCount) {
+        dist.assign(nodeCount, 0);
+        stamp.assign(nodeCount, 0);
+        currentStamp = 0;
+    }
+    if (++currentStamp == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0u);
+        currentStamp = 1;
+    }
+    heap.clear();
+}
+
+bool ContractionHierarchy::Search::improve(int node, int distance) {
+    if (stamp[node] == currentStamp && dist[node] <= distance) return false;
+    stamp[node] = currentStamp;
+    dist[node] = distance;
+    heap.push_back({ distance, node });
+    std::push_heap(heap.begin(), heap.end(), Heap());
+    return true;
+}
+
+namespace {
+    // Keep only the shorter arc when two nodes get connected twice
+    template <typename ArcList, typename Arc>
+    void addArc(ArcList& list, Arc arc) {
+        for (Arc& existing : list) {
+            if (existing.to == arc.to) {
+                existing.weight = std::min(existing.weight, arc.weight);
+                return;
+            }
+        }
+        list.push_back(arc);
+    }
+
+    template <typename ArcList>
+    void removeArc(ArcList& list, int to) {
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (list[i].to == to) {
+                list[i] = list.back();
+                list.pop_back();
+                return;
+            }
+        }
+    }
+}
+
+void ContractionHierarchy::buildTileMap(const BitGrid& walk, std::vector<std::vector<Arc>>* graph) {
+    width = walk.width;
+    height = walk.height;
+    layoutHash = hashLayout(walk);
+
+    size_t tileCount = static_cast<size_t>(width) * height;
+    tileRef.assign(tileCount, WALL);
+    tileOffset.assign(tileCount, 0);
+    nodeTile.clear();
+    edgeA.clear();
+    edgeB.clear();
+    edgeLength.clear();
+
+    auto walkableNeighbors = [&](int x, int y) {
+        int count = 0;
+        for (int dir = 0; dir < 4; ++dir) {
+            if (walk.get(x + STEP_X[dir], y + STEP_Y[dir])) ++count;
+        }
+        return count;
+    };
+
+    // Every walkable tile that isn't in the middle of a corridor becomes a node
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (walk.get(x, y) && walkableNeighbors(x, y) != 2) {
+                tileRef[y * width + x] = static_cast<int>(nodeTile.size());
+                nodeTile.push_back(y * width + x);
+            }
+        }
+    }
+
+    std::vector<Shortcut> baseArcs;
+
+    // Follow every corridor leaving `node` until it reaches the next node
+    auto traceFrom = [&](int node) {
+        int x = nodeTile[node] % width;
+        int y = nodeTile[node] / width;
+        for (int dir = 0; dir < 4; ++dir) {
+            int nx = x + STEP_X[dir];
+            int ny = y + STEP_Y[dir];
+            if (!walk.get(nx, ny)) continue;
+
+            int neighbor = ny * width + nx;
+            if (tileRef[neighbor] >= 0) {
+                if (tileRef[neighbor] > node) baseArcs.push_back({ node, tileRef[neighbor], 1 });
+                continue;
+            }
+            if (tileRef[neighbor] != WALL) continue;    // Traced from the other end already
+
+            int edge = static_cast<int>(edgeA.size());
+            int previous = nodeTile[node];
+            int current = neighbor;
+            int offset = 1;
+            int end;
+            while (true) {
+                tileRef[current] = -2 - edge;
+                tileOffset[current] = offset;
+
+                int cx = current % width;
+                int cy = current / width;
+                int next = -1;
+                for (int d = 0; d < 4; ++d) {
+                    int tx = cx + STEP_X[d];
+                    int ty = cy + STEP_Y[d];
+                    if (walk.get(tx, ty) && ty * width + tx != previous) {
+                        next = ty * width + tx;
+                        break;
+                    }
+                }
+
+                if (tileRef[next] >= 0) {
+                    end = tileRef[next];
+                    break;
+                }
+                previous = current;
+                current = next;
+                ++offset;
+            }
+
+            edgeA.push_back(node);
+            edgeB.push_back(end);
+            edgeLength.push_back(offset + 1);
+            if (end != node) baseArcs.push_back({ node, end, offset + 1 });
+        }
+    };
+
+    junctionCount = static_cast<int>(nodeTile.size());
+    for (int node = 0; node < junctionCount; ++node) {
+        traceFrom(node);
+    }
+
+    // Whatever is left are loops made only of corridor tiles; give each one a node
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        int x = static_cast<int>(tile % width);
+        int y = static_cast<int>(tile / width);
+        if (tileRef[tile] == WALL && walk.get(x, y)) {
+            tileRef[tile] = static_cast<int>(nodeTile.size());
+            nodeTile.push_back(static_cast<int>(tile));
+            traceFrom(tileRef[tile]);
+        }
+    }
+
+    if (graph) {
+        graph->assign(nodeTile.size(), {});
+        for (const Shortcut& arc : baseArcs) {
+            addArc((*graph)[arc.from], Arc{ arc.to, arc.weight });
+            addArc((*graph)[arc.to], Arc{ arc.from, arc.weight });
+        }
+    }
+}
+
+void ContractionHierarchy::build(const BitGrid& walk, int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    std::vector<std::vector<Arc>> graph;
+    buildTileMap(walk, &graph);
+
+    const int nodeCount = static_cast<int>(nodeTile.size());
+    size_t baseArcCount = 0;
+    for (const auto& list : graph) baseArcCount += list.size();
+    baseArcCount /= 2;
+
+    std::vector<std::vector<Arc>> upward(nodeCount);
+    std::vector<std::vector<Shortcut>> shortcuts(nodeCount);
+    std::vector<std::vector<Shortcut>> trial(threadCount);
+    std::vector<int> priority(nodeCount, 0);
+    std::vector<int> depth(nodeCount, 0);
+    std::vector<int> removedNeighbors(nodeCount, 0);
+    std::vector<uint8_t> dirty(nodeCount, 1);
+    std::vector<uint8_t> contracted(nodeCount, 0);
+    std::vector<uint8_t> inRound(nodeCount, 0);
+    std::vector<Search> searches(threadCount);
+
+    std::vector<int> remaining(nodeCount);
+    for (int node = 0; node < nodeCount; ++node) remaining[node] = node;
+
+    // Shortcuts needed to remove `node`: one for each pair of neighbors whose
+    // shortest connection goes through it. Witness paths may not use any node
+    // removed in the same round, or two nodes could each rely on the other.
+    auto findShortcuts = [&](int node, Search& search, std::vector<Shortcut>& out) {
+        out.clear();
+        const std::vector<Arc>& neighbors = graph[node];
+        for (size_t i = 0; i + 1 < neighbors.size(); ++i) {
+            int from = neighbors[i].to;
+            int limit = 0;
+            for (size_t j = i + 1; j < neighbors.size(); ++j) {
+                limit = std::max(limit, neighbors[i].weight + neighbors[j].weight);
+            }
+
+            // Look for a "witness" path that avoids `node` and is no longer
+            search.begin(nodeCount);
+            search.improve(from, 0);
+            int settled = 0;
+            while (!search.heap.empty() && settled < WITNESS_SETTLE_LIMIT) {
+                std::pop_heap(search.heap.begin(), search.heap.end(), Heap());
+                std::pair<int, int> top = search.heap.back();
+                search.heap.pop_back();
+                if (top.first != search.dist[top.second]) continue;
+                if (top.first > limit) break;
+                ++settled;
+
+                for (const Arc& arc : graph[top.second]) {
+                    if (arc.to == node || inRound[arc.to] || top.first + arc.weight > limit) continue;
+                    search.improve(arc.to, top.first + arc.weight);
+                }
+            }
+
+            for (size_t j = i + 1; j < neighbors.size(); ++j) {
+                int to = neighbors[j].to;
+                int via = neighbors[i].weight + neighbors[j].weight;
+                if (!search.seen(to) || search.dist[to] > via) out.push_back({ from, to, via });
+            }
+        }
+    };
+
+    // Each round removes a set of nodes that aren't neighbors of each other.
+    // The expensive witness searches run in parallel; the graph is only changed
+    // afterwards, in node order, so every thread count gives the same result.
+    while (!remaining.empty()) {
+        parallelFor(threadCount, remaining.size(), [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; ++i) {
+                int node = remaining[i];
+                if (!dirty[node]) continue;
+                findShortcuts(node, searches[worker], trial[worker]);
+                int edgeDifference = static_cast<int>(trial[worker].size()) - static_cast<int>(graph[node].size());
+                priority[node] = 2 * edgeDifference + removedNeighbors[node] + depth[node];
+                dirty[node] = 0;
+            }
+        });
+
+        // A node goes this round if it is cheaper than all of its neighbors (ties go to the lower id)
+        std::vector<uint8_t> selected(remaining.size(), 0);
+        parallelFor(threadCount, remaining.size(), [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; ++i) {
+                int node = remaining[i];
+                bool smallest = true;
+                for (const Arc& arc : graph[node]) {
+                    int other = arc.to;
+                    if (priority[other] < priority[node] || (priority[other] == priority[node] && other < node)) {
+                        smallest = false;
+                        break;
+                    }
+                }
+                selected[i] = smallest ? 1 : 0;
+            }
+        });
+
+        std::vector<int> round;
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            if (!selected[i]) continue;
+            round.push_back(remaining[i]);
+            inRound[remaining[i]] = 1;
+        }
+        parallelFor(threadCount, round.size(), [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; ++i) {
+                findShortcuts(round[i], searches[worker], shortcuts[round[i]]);
+            }
+        });
+
+        for (int node : round) {
+            contracted[node] = 1;
+            inRound[node] = 0;
+            upward[node] = graph[node];
+
+            for (const Arc& arc : graph[node]) {
+                removeArc(graph[arc.to], node);
+                ++removedNeighbors[arc.to];
+                depth[arc.to] = std::max(depth[arc.to], depth[node] + 1);
+                dirty[arc.to] = 1;
+            }
+            for (const Shortcut& shortcut : shortcuts[node]) {
+                addArc(graph[shortcut.from], Arc{ shortcut.to, shortcut.weight });
+                addArc(graph[shortcut.to], Arc{ shortcut.from, shortcut.weight });
+            }
+            std::vector<Arc>().swap(graph[node]);
+            std::vector<Shortcut>().swap(shortcuts[node]);
+        }
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+            [&](int node) { return contracted[node] != 0; }), remaining.end());
+    }
+
+    // Pack the upward arcs, sorted so the saved file doesn't depend on arc order
+    firstArc.assign(nodeCount + 1, 0);
+    arcs.clear();
+    for (int node = 0; node < nodeCount; ++node) {
+        std::sort(upward[node].begin(), upward[node].end(),
+            [](const Arc& a, const Arc& b) { return a.to < b.to; });
+        firstArc[node] = static_cast<int>(arcs.size());
+        arcs.insert(arcs.end(), upward[node].begin(), upward[node].end());
+    }
+    firstArc[nodeCount] = static_cast<int>(arcs.size());
+    shortcutCount = static_cast<int>(arcs.size() - baseArcCount);
+}
+
+bool ContractionHierarchy::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    writeValue(out, FILE_VERSION);
+    writeValue(out, static_cast<int32_t>(width));
+    writeValue(out, static_cast<int32_t>(height));
+    writeValue(out, layoutHash);
+    writeValue(out, static_cast<int32_t>(nodeTile.size()));
+    writeValue(out, static_cast<int32_t>(arcs.size()));
+    writeValue(out, static_cast<int32_t>(shortcutCount));
+    writeValue(out, static_cast<int32_t>(junctionCount));
+    out.write(reinterpret_cast<const char*>(firstArc.data()), firstArc.size() * sizeof(int));
+    out.write(reinterpret_cast<const char*>(arcs.data()), arcs.size() * sizeof(Arc));
+    out.write(reinterpret_cast<const char*>(nodeTile.data()), nodeTile.size() * sizeof(int));
+    return static_cast<bool>(out);
+}
+
+bool ContractionHierarchy::read(const std::string& path, int mazeWidth, int mazeHeight, uint64_t mazeHash) {
+    firstArc.clear();
+    arcs.clear();
+    nodeTile.clear();
+    tileRef.clear();
+    tileOffset.clear();
+    edgeA.clear();
+    edgeB.clear();
+    edgeLength.clear();
+    isWalkable = nullptr;
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    char magic[4];
+    uint32_t version;
+    int32_t fileWidth, fileHeight, fileNodes, fileArcs, fileShortcuts, fileJunctions;
+    uint64_t fileHash;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, FILE_MAGIC)) return false;
+    if (!readValue(in, version) || version != FILE_VERSION) return false;
+    if (!readValue(in, fileWidth) || !readValue(in, fileHeight) || !readValue(in, fileHash)) return false;
+    if (fileWidth != mazeWidth || fileHeight != mazeHeight || fileHash != mazeHash) return false;
+    if (!readValue(in, fileNodes) || !readValue(in, fileArcs) || !readValue(in, fileShortcuts) ||
+        !readValue(in, fileJunctions)) return false;
+
+    // The counts decide how much is allocated, so they must fit the file before anything is
+    const uint64_t tileCount = static_cast<uint64_t>(fileWidth) * static_cast<uint64_t>(fileHeight);
+    if (fileNodes < 0 || static_cast<uint64_t>(fileNodes) > tileCount || fileArcs < 0 ||
+        fileJunctions < 0 || fileJunctions > fileNodes) return false;
+    const uint64_t expectedSize = FILE_HEADER_SIZE + (static_cast<uint64_t>(fileNodes) + 1) * sizeof(int)
+        + static_cast<uint64_t>(fileArcs) * sizeof(Arc) + static_cast<uint64_t>(fileNodes) * sizeof(int);
+    if (fileSize != expectedSize) return false;
+
+    firstArc.resize(static_cast<size_t>(fileNodes) + 1);
+    arcs.resize(static_cast<size_t>(fileArcs));
+    nodeTile.resize(static_cast<size_t>(fileNodes));
+    in.read(reinterpret_cast<char*>(firstArc.data()), firstArc.size() * sizeof(int));
+    in.read(reinterpret_cast<char*>(arcs.data()), arcs.size() * sizeof(Arc));
+    in.read(reinterpret_cast<char*>(nodeTile.data()), nodeTile.size() * sizeof(int));
+    width = fileWidth;
+    height = fileHeight;
+    layoutHash = fileHash;
+    shortcutCount = fileShortcuts;
+    junctionCount = fileJunctions;
+
+    // Reject damaged files instead of reading out of bounds later
+    bool valid = static_cast<bool>(in) && firstArc[0] == 0 && firstArc[fileNodes] == fileArcs;
+    for (int node = 0; valid && node < fileNodes; ++node) {
+        valid = firstArc[node] <= firstArc[node + 1];
+    }
+    for (size_t i = 0; valid && i < arcs.size(); ++i) {
+        valid = arcs[i].to >= 0 && arcs[i].to < fileNodes && arcs[i].weight > 0;
+    }
+    for (int node = 0; valid && node < fileNodes; ++node) {
+        bool sorted = node == 0 || node == junctionCount || nodeTile[node - 1] < nodeTile[node];
+        valid = sorted && nodeTile[node] >= 0 && static_cast<uint64_t>(nodeTile[node]) < tileCount;
+    }
+    if (!valid) {
+        firstArc.clear();
+        arcs.clear();
+        nodeTile.clear();
+    }
+    return valid;
+}
+
+bool ContractionHierarchy::load(const std::string& path, const BitGrid& walk) {
+    if (!read(path, walk.width, walk.height, hashLayout(walk))) return false;
+
+    // The saved nodes must be the ones the walls give
+    std::vector<int> savedNodes;
+    savedNodes.swap(nodeTile);
+    const int savedJunctions = junctionCount;
+    buildTileMap(walk, nullptr);
+    if (nodeTile != savedNodes || junctionCount != savedJunctions) {
+        firstArc.clear();
+        arcs.clear();
+        nodeTile.clear();
+        tileRef.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ContractionHierarchy::load(const std::string& path, int mazeWidth, int mazeHeight, uint64_t mazeHash,
+    std::function<bool(int, int)> lookup) {
+    if (!read(path, mazeWidth, mazeHeight, mazeHash)) return false;
+    isWalkable = std::move(lookup);
+    return true;
+}
+
+std::string ContractionHierarchy::sidecarPath(const std::string& mazePath) {
+    return mazePath + ".ch";
+}
+
+bool ContractionHierarchy::sameAs(const ContractionHierarchy& other) const {
+    if (nodeTile != other.nodeTile || firstArc != other.firstArc || arcs.size() != other.arcs.size()) return false;
+    for (size_t i = 0; i < arcs.size(); ++i) {
+        if (arcs[i].to != other.arcs[i].to || arcs[i].weight != other.arcs[i].weight) return false;
+    }
+    return true;
+}
+
+int ContractionHierarchy::findNode(int tile) const {
+    auto junctionsEnd = nodeTile.begin() + junctionCount;
+    auto found = std::lower_bound(nodeTile.begin(), junctionsEnd, tile);
+    if (found == junctionsEnd || *found != tile) {
+        found = std::lower_bound(junctionsEnd, nodeTile.end(), tile);
+        if (found == nodeTile.end() || *found != tile) return -1;
+    }
+    return static_cast<int>(found - nodeTile.begin());
+}
+
+int ContractionHierarchy::attach(int x, int y, std::pair<int, int> out[2], int alongX, int alongY, int& along) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) return 0;
+    int tile = y * width + x;
+
+    if (!tileRef.empty()) {
+        int ref = tileRef[tile];
+        if (ref == WALL) return 0;
+        if (ref >= 0) {
+            out[0] = { ref, 0 };
+            return 1;
+        }
+
+        int edge = -2 - ref;
+        out[0] = { edgeA[edge], tileOffset[tile] };
+        out[1] = { edgeB[edge], edgeLength[edge] - tileOffset[tile] };
+        if (alongX >= 0 && alongY >= 0 && alongX < width && alongY < height && tileRef[alongY * width + alongX] == ref) {
+            along = std::min(along, std::abs(tileOffset[tile] - tileOffset[alongY * width + alongX]));
+        }
+        return 2;
+    }
+
+    // No tile map: follow the corridor both ways until it reaches a node
+    if (!isWalkable(x, y)) return 0;
+    int node = findNode(tile);
+    if (node >= 0) {
+        out[0] = { node, 0 };
+        return 1;
+    }
+
+    int count = 0;
+    for (int dir = 0; dir < 4 && count < 2; ++dir) {
+        int cx = x + STEP_X[dir];
+        int cy = y + STEP_Y[dir];
+        if (!isWalkable(cx, cy)) continue;
+
+        int px = x, py = y;
+        int steps = 1;
+        while ((node = findNode(cy * width + cx)) < 0) {
+            if (cx == alongX && cy == alongY) along = std::min(along, steps);
+
+            // A corridor tile has exactly one way on; anything else means the sidecar doesn't fit
+            int nextX = -1, nextY = -1, ways = 0;
+            for (int d = 0; d < 4; ++d) {
+                int tx = cx + STEP_X[d];
+                int ty = cy + STEP_Y[d];
+                if ((tx != px || ty != py) && isWalkable(tx, ty)) {
+                    nextX = tx;
+                    nextY = ty;
+                    ++ways;
+                }
+            }
+            if (ways != 1 || steps > width * height) return 0;
+            px = cx;
+            py = cy;
+            cx = nextX;
+            cy = nextY;
+            ++steps;
+        }
+        out[count++] = { node, steps };
+    }
+    return count == 2 ? 2 : 0;
+}
+
+int ContractionHierarchy::distance(int ax, int ay, int bx, int by) const {
+    if (firstArc.empty()) return -1;
+
+    // Two tiles in the same corridor can also just walk along it
+    int best = INT_MAX;
+    std::pair<int, int> sources[2];
+    std::pair<int, int> targets[2];
+    int sourceCount = attach(ax, ay, sources, bx, by, best);
+    int targetCount = attach(bx, by, targets, -1, -1, best);
+    if (sourceCount == 0 || targetCount == 0) return -1;
+    if (ax == bx && ay == by) return 0;
+
+    // Search upward from both ends; the shortest path goes up and then down again,
+    // so it shows up as a node both searches reached
+    forward.begin(nodeTile.size());
+    backward.begin(nodeTile.size());
+    for (int i = 0; i < sourceCount; ++i) forward.improve(sources[i].first, sources[i].second);
+    for (int i = 0; i < targetCount; ++i) backward.improve(targets[i].first, targets[i].second);
+
+    while (!forward.heap.empty() || !backward.heap.empty()) {
+        int forwardTop = forward.heap.empty() ? INT_MAX : forward.heap.front().first;
+        int backwardTop = backward.heap.empty() ? INT_MAX : backward.heap.front().first;
+        if (std::min(forwardTop, backwardTop) >= best) break;
+
+        Search& side = forwardTop <= backwardTop ? forward : backward;
+        const Search& other = forwardTop <= backwardTop ? backward : forward;
+
+        std::pop_heap(side.heap.begin(), side.heap.end(), Heap());
+        std::pair<int, int> top = side.heap.back();
+        side.heap.pop_back();
+        int node = top.second;
+        if (top.first != side.dist[node]) continue;
+
+        if (other.seen(node)) best = std::min(best, top.first + other.dist[node]);
+        for (int i = firstArc[node]; i < firstArc[node + 1]; ++i) {
+            int next = top.first + arcs[i].weight;
+            if (next < best) side.improve(arcs[i].to, next);
+        }
+    }
+    return best == INT_MAX ? -1 : best;
+}
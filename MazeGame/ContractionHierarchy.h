@@ -0,0 +1,112 @@
+// ContractionHierarchy.h
+#pragma once
+#include "BitGrid.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Very fast distance queries for mazes that never change after loading.
+//
+// Corridors are first merged into weighted edges (like JunctionGraph). Then every
+// junction is "contracted" one by one: it is removed, and shortcut edges are added
+// between its neighbors wherever the route through it was the only shortest one.
+// A query only has to search upward from both ends through the added shortcuts,
+// which touches a few hundred nodes even on huge mazes.
+//
+// Building is slow, so the result can be saved to a sidecar file next to the maze
+// and loaded again on the next start. The sidecar holds the junctions but not which
+// corridor every tile belongs to: that map is made again by load() from the walls, or
+// left out entirely, in which case a query follows the corridors at both of its ends.
+//
+// Queries reuse internal buffers, so one hierarchy must not be queried from several threads at once.
+class ContractionHierarchy {
+public:
+    // Build the hierarchy for `walk`. Contraction runs on `threadCount` threads
+    // (0 = one per core); the result is the same for any thread count.
+    void build(const BitGrid& walk, int threadCount = 0);
+
+    // Write the hierarchy to a sidecar file. Returns false if the file can't be written.
+    bool save(const std::string& path) const;
+
+    // Read a sidecar file written for `walk`.
+    // Returns false if it is missing, damaged, or was made for a different layout.
+    bool load(const std::string& path, const BitGrid& walk);
+
+    // Read a sidecar file without the walls: it is checked against the size and
+    // hashLayout() of the maze it is meant for (see BitGrid.h), and queries look tiles up
+    // with `isWalkable`, only along the corridors at both ends. Nothing is made per tile,
+    // so this takes as long as reading the file, however big the maze is.
+    bool load(const std::string& path, int mazeWidth, int mazeHeight, uint64_t mazeHash,
+        std::function<bool(int, int)> isWalkable);
+
+    // Where the sidecar of a maze file goes: next to it, with ".ch" added to the name
+    static std::string sidecarPath(const std::string& mazePath);
+
+    // Shortest number of steps between two walkable tiles, or -1 if they aren't connected
+    int distance(int ax, int ay, int bx, int by) const;
+
+    int getNodeCount() const { return static_cast<int>(nodeTile.size()); }
+    int getArcCount() const { return static_cast<int>(arcs.size()); }
+    int getShortcutCount() const { return shortcutCount; }
+
+    // True if both hierarchies have exactly the same nodes and arcs
+    bool sameAs(const ContractionHierarchy& other) const;
+
+private:
+    struct Arc {
+        int to;
+        int weight;
+    };
+
+    // Per-thread Dijkstra buffers
+    struct Search {
+        std::vector<int> dist;
+        std::vector<uint32_t> stamp;
+        uint32_t currentStamp = 0;
+        std::vector<std::pair<int, int>> heap;  // (distance, node), smallest on top
+
+        void begin(size_t nodeCount);
+        bool seen(int node) const { return stamp[node] == currentStamp; }
+        bool improve(int node, int distance);   // Lower the distance of a node, true if it changed
+    };
+
+    int width = 0;
+    int height = 0;
+    uint64_t layoutHash = 0;
+    int shortcutCount = 0;
+
+    // Tile of each node: first the junctions and dead ends, then one tile of every loop
+    // made only of corridor tiles; both parts are sorted
+    std::vector<int> nodeTile;
+    int junctionCount = 0;
+
+    // Tile -> graph mapping (rebuilt from the layout, never saved; empty when loaded without the walls)
+    std::vector<int> tileRef;       // Node id, -1 for walls, or -2 - edge id for corridor tiles
+    std::vector<int> tileOffset;    // Steps from the edge's first node
+    std::vector<int> edgeA, edgeB, edgeLength;
+
+    // Used instead of tileRef when there is no tile map
+    std::function<bool(int, int)> isWalkable;
+
+    // Arcs from each node to the neighbors contracted after it, in CSR form
+    std::vector<int> firstArc;      // Arcs of node n are arcs[firstArc[n] .. firstArc[n + 1])
+    std::vector<Arc> arcs;
+
+    mutable Search forward;
+    mutable Search backward;
+
+    // Fills the tile mapping; if `graph` is not null it also gets the merged edges as arcs
+    void buildTileMap(const BitGrid& walk, std::vector<std::vector<Arc>>* graph);
+
+    // Reads everything but the tile map; false if the file doesn't fit the given maze
+    bool read(const std::string& path, int mazeWidth, int mazeHeight, uint64_t mazeHash);
+
+    // Node id of a tile, -1 if it isn't a node
+    int findNode(int tile) const;
+
+    // Nodes a tile connects to as (node, steps) pairs; returns how many (0 for walls).
+    // If (alongX, alongY) is in the same corridor, `along` is lowered to the steps to it.
+    int attach(int x, int y, std::pair<int, int> out[2], int alongX, int alongY, int& along) const;
+};
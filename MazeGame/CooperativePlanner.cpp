@@ -0,0 +1,388 @@
+// CooperativePlanner.cpp
+#include "CooperativePlanner.h"
+#include "BitBfs.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+    // An agent gives up searching after this many steps and takes the best route found so far
+    const int MAX_EXPANSIONS = 128;
+
+    // Wait, up, right, down, left
+    const int STEP_X[5] = { 0, 0, 1, 0, -1 };
+    const int STEP_Y[5] = { 0, -1, 0, 1, 0 };
+
+    const size_t VISITED_SLOTS = 1024;  // Power of two, well above MAX_EXPANSIONS
+
+
+    uint64_t makeKey(int tile, int tick) {
+        return (static_cast<uint64_t>(tick) << 32) | static_cast<uint32_t>(tile);
+    }
+
+    // Agents plan again once their route has only this many ticks left
+    const int REPLAN_MARGIN = 2;
+
+    // Room for this many ticks per tile before entries spill into the next tile's slots
+    const size_t SLOTS_PER_TILE = 16;
+
+    size_t hashKey(uint64_t key) {
+        key ^= key >> 29;
+        key *= 0xBF58476D1CE4E5B9ull;
+        return static_cast<size_t>(key ^ (key >> 32));
+    }
+
+    size_t reservationSlot(int tile, int tick) {
+        return static_cast<size_t>(tile) * SLOTS_PER_TILE + (static_cast<size_t>(tick) & (SLOTS_PER_TILE - 1));
+    }
+
+    uint32_t packTickAndOwner(int tick, int owner) {
+        return (static_cast<uint32_t>(tick) & 0xFF) | (static_cast<uint32_t>(owner + 1) << 8);
+    }
+}
+
+void CooperativePlanner::ReservationTable::clear(size_t expectedEntries) {
+    size_t size = 1024;
+    while (size < expectedEntries * 2) size *= 2;
+    if (slots.size() != size) slots.resize(size);
+    std::fill(slots.begin(), slots.end(), Slot{ -1, 0 });
+    mask = size - 1;
+}
+
+void CooperativePlanner::ReservationTable::reserve(int tile, int tick, int agent) {
+    size_t index = reservationSlot(tile, tick) & mask;
+    while (slots[index].tile >= 0 &&
+        (slots[index].tile != tile || ((slots[index].tickAndOwner ^ static_cast<uint32_t>(tick)) & 0xFF) != 0)) {
+        index = (index + 1) & mask;
+    }
+    slots[index] = { tile, packTickAndOwner(tick, agent) };
+}
+
+int CooperativePlanner::ReservationTable::owner(int tile, int tick) const {
+    size_t index = reservationSlot(tile, tick) & mask;
+    while (slots[index].tile >= 0) {
+        if (slots[index].tile == tile && ((slots[index].tickAndOwner ^ static_cast<uint32_t>(tick)) & 0xFF) == 0) {
+            return static_cast<int>(slots[index].tickAndOwner >> 8) - 1;
+        }
+        index = (index + 1) & mask;
+    }
+    return -1;
+}
+
+CooperativePlanner::CooperativePlanner(int window, int maxPlansPerTick)
+    : window(std::max(2, std::min(window, 255))),
+      replanInterval(std::max(1, this->window / 2)),
+      maxPlansPerTick(maxPlansPerTick) {
+    visitedKeys.assign(VISITED_SLOTS, 0);
+    visitedGeneration.assign(VISITED_SLOTS, 0);
+}
+
+void CooperativePlanner::setTarget(const BitGrid& walkGrid, int x, int y, const std::vector<uint16_t>* distances) {
+    walk = walkGrid;
+    if (distances && distances->size() == static_cast<size_t>(walk.width) * walk.height) {
+        goalDistance = *distances;
+    }
+    else {
+        BitGrid reached;
+        BitBfs::flood(walk, x, y, reached, &goalDistance);
+    }
+    targetX = x;
+    targetY = y;
+    targetTile = walk.get(x, y) ? y * walk.width + x : -1;
+    repairsReady = false;
+    if (parkedBy.size() != goalDistance.size()) {
+        parkedBy.assign(goalDistance.size(), 0);
+    }
+
+    // Routes toward the old target are no use any more
+    std::fill(routeStart.begin(), routeStart.end(), -1);
+}
+
+void CooperativePlanner::updateTile(const BitGrid& walkGrid, int x, int y) {
+    if (x < 0 || x >= walk.width || y < 0 || y >= walk.height || walk.get(x, y) == walkGrid.get(x, y)) return;
+
+    // A target inside a wall has no distances to repair; start over
+    if (targetTile < 0) {
+        setTarget(walkGrid, targetX, targetY);
+        return;
+    }
+
+    if (!repairsReady) {
+        repairs.setTarget(walk, targetX, targetY);
+        repairsReady = true;
+    }
+    walk.set(x, y, walkGrid.get(x, y));
+    repairs.updateTile(walk, x, y);
+
+    repairedTiles.clear();
+    repairs.repairAll(&repairedTiles);
+    for (int tile : repairedTiles) {
+        int steps = repairs.distance(tile % walk.width, tile / walk.width);
+        goalDistance[tile] = steps < 0 ? BitBfs::UNREACHED : static_cast<uint16_t>(std::min<int>(steps, BitBfs::MAX_DISTANCE));
+    }
+
+    // A route may run through the new wall, or miss the new shortcut
+    std::fill(routeStart.begin(), routeStart.end(), -1);
+}
+
+void CooperativePlanner::step(const std::vector<Agent>& agents, std::vector<Agent>& next) {
+    const int count = static_cast<int>(agents.size());
+    const int stride = window + 1;
+    const int now = tickCounter;
+    next = agents;
+    if (count == 0) return;
+
+    if (static_cast<int>(routeStart.size()) != count) {
+        routeStart.assign(count, -1);
+        routeEnd.assign(count, 0);
+        routeTiles.assign(static_cast<size_t>(count) * stride, -1);
+        parkedFrom.assign(count, 0);
+    }
+
+    reservations.clear(static_cast<size_t>(count) * (stride + 1));
+    if (++stepStamp == 0) {
+        std::fill(parkedBy.begin(), parkedBy.end(), 0ull);
+        stepStamp = 1;
+    }
+    reservationCount = 0;
+    hasRoute.assign(count, 0);
+    replanning.clear();
+
+    // Tick 0 holds where everyone stands right now
+    for (int i = 0; i < count; ++i) {
+        reservations.reserve(agents[i].y * walk.width + agents[i].x, now, i);
+        ++reservationCount;
+    }
+
+    // Keep routes that still line up with where the agent is and have a few ticks left.
+    // Agents that are stuck waiting retry every replanInterval ticks. Until an agent
+    // plans, it counts as parked where it stands.
+    for (int i = 0; i < count; ++i) {
+        int tile = agents[i].y * walk.width + agents[i].x;
+        int age = now - routeStart[i];
+        hasRoute[i] = routeStart[i] >= 0 && age >= 0 && age < window &&
+            routeTiles[static_cast<size_t>(i) * stride + age] == tile;
+        if (hasRoute[i]) {
+            reserveRoute(i, i);
+        }
+        else {
+            park(i, tile, now, i);
+        }
+        // The margin differs a little per agent so a crowd that started together
+        // doesn't keep planning on the same ticks
+        bool runningOut = routeEnd[i] - age <= REPLAN_MARGIN + i % replanInterval;
+        bool waiting = routeEnd[i] < window && (i + now) % replanInterval == 0;
+        if (!hasRoute[i] || runningOut || waiting) {
+            replanning.push_back(i);
+        }
+    }
+
+    // Plan in agent order starting at the cursor. If the budget runs out, the next tick
+    // continues where this one stopped; otherwise the starting agent moves up by one.
+    if (!replanning.empty()) {
+        size_t first = std::lower_bound(replanning.begin(), replanning.end(), nextToPlan % count) - replanning.begin();
+        size_t budget = maxPlansPerTick > 0 ? static_cast<size_t>(maxPlansPerTick) : replanning.size();
+        size_t planCount = std::min(budget, replanning.size());
+        int last = -1;
+        for (size_t k = 0; k < replanning.size(); ++k) {
+            int agent = replanning[(first + k) % replanning.size()];
+            if (k < planCount) {
+                planAgent(agent, agents[agent]);
+                last = agent;
+            }
+            else if (!hasRoute[agent]) {
+                waitInPlace(agent, agents[agent]);
+            }
+        }
+        nextToPlan = planCount < replanning.size() ? last + 1 : nextToPlan + 1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int tile = routeTiles[static_cast<size_t>(i) * stride + (now + 1 - routeStart[i])];
+        next[i] = { tile % walk.width, tile / walk.width };
+    }
+    ++tickCounter;
+}
+
+void CooperativePlanner::waitInPlace(int agent, const Agent& start) {
+    const int stride = window + 1;
+    int* route = &routeTiles[static_cast<size_t>(agent) * stride];
+    std::fill(route, route + stride, start.y * walk.width + start.x);
+    routeStart[agent] = tickCounter;
+    routeEnd[agent] = 0;
+}
+
+void CooperativePlanner::reserveRoute(int agent, int owner) {
+    const int stride = window + 1;
+    const int* route = &routeTiles[static_cast<size_t>(agent) * stride];
+    for (int k = tickCounter - routeStart[agent] + 1; k <= routeEnd[agent]; ++k) {
+        reservations.reserve(route[k], routeStart[agent] + k, owner);
+        reservationCount += owner >= 0 ? 1 : -1;
+    }
+    park(agent, route[routeEnd[agent]], routeStart[agent] + routeEnd[agent] + 1, owner);
+}
+
+void CooperativePlanner::park(int agent, int tile, int fromTick, int owner) {
+    parkedBy[tile] = (static_cast<uint64_t>(stepStamp) << 32) | static_cast<uint32_t>(owner);
+    parkedFrom[agent] = fromTick;
+}
+
+int CooperativePlanner::parkedOwner(int tile) const {
+    uint64_t slot = parkedBy[tile];
+    return (slot >> 32) == stepStamp ? static_cast<int>(static_cast<uint32_t>(slot)) : -1;
+}
+
+bool CooperativePlanner::isFree(int agent, int fromTile, int toTile, int tick) const {
+    tick += tickCounter;
+    int holder = reservations.owner(toTile, tick + 1);
+    if (holder >= 0 && holder != agent) return false;
+
+    int parked = parkedOwner(toTile);
+    if (parked >= 0 && parked != agent && tick + 1 >= parkedFrom[parked]) return false;
+
+    // Two agents walking through each other
+    if (fromTile != toTile) {
+        int other = reservations.owner(toTile, tick);
+        if (other >= 0 && other != agent && reservations.owner(fromTile, tick + 1) == other) return false;
+    }
+    return true;
+}
+
+bool CooperativePlanner::canStay(int agent, int tile, int tick) const {
+    for (int later = tick + 1; later <= window; ++later) {
+        int holder = reservations.owner(tile, tickCounter + later);
+        if (holder >= 0 && holder != agent) return false;
+    }
+    return true;
+}
+
+bool CooperativePlanner::markVisited(int tile, int tick) {
+    uint64_t key = makeKey(tile, tick);
+    size_t slot = hashKey(key) & (VISITED_SLOTS - 1);
+    while (visitedGeneration[slot] == visitedStamp) {
+        if (visitedKeys[slot] == key) return false;
+        slot = (slot + 1) & (VISITED_SLOTS - 1);
+    }
+    visitedGeneration[slot] = visitedStamp;
+    visitedKeys[slot] = key;
+    return true;
+}
+
+void CooperativePlanner::planAgent(int agent, const Agent& start) {
+    const int width = walk.width;
+    const int stride = window + 1;
+    const int startTile = start.y * width + start.x;
+    int* route = &routeTiles[static_cast<size_t>(agent) * stride];
+
+    auto estimate = [&](int tile) -> int {
+        return goalDistance.empty() ? 0 : goalDistance[tile];
+    };
+
+    // Reserve the first `length` tiles of `route` and park on the last one
+    auto finish = [&](int length) {
+        for (int k = length; k <= window; ++k) route[k] = route[length - 1];
+        routeStart[agent] = tickCounter;
+        routeEnd[agent] = length - 1;
+        reserveRoute(agent, agent);
+    };
+
+    // Take our own claims out of the table while searching
+    if (hasRoute[agent]) {
+        reserveRoute(agent, -1);
+    }
+    else {
+        park(agent, startTile, tickCounter, -1);
+    }
+
+    // Without a way to the target there is nothing to plan; just stay if that is allowed,
+    // or step aside for whoever claimed this tile
+    if (targetTile < 0 || goalDistance.empty() || goalDistance[startTile] == BitBfs::UNREACHED) {
+        route[0] = startTile;
+        route[1] = startTile;
+        for (int move = 0; move < 5; ++move) {
+            int nx = start.x + STEP_X[move];
+            int ny = start.y + STEP_Y[move];
+            if (walk.get(nx, ny) && isFree(agent, startTile, ny * width + nx, 0) &&
+                canStay(agent, ny * width + nx, 1)) {
+                route[1] = ny * width + nx;
+                break;
+            }
+        }
+        finish(2);
+        return;
+    }
+
+    if (++visitedStamp == 0) {
+        std::fill(visitedGeneration.begin(), visitedGeneration.end(), 0u);
+        visitedStamp = 1;
+    }
+    nodes.clear();
+    open.clear();
+
+    // Heap key: lowest estimate first, and on ties the node furthest ahead in time
+    auto push = [&](const Node& node) {
+        int key = (node.cost + estimate(node.tile)) * 256 - node.tick;
+        nodes.push_back(node);
+        open.push_back({ key, static_cast<int>(nodes.size()) - 1 });
+        std::push_heap(open.begin(), open.end(), std::greater<std::pair<int, int>>());
+    };
+
+    push({ startTile, 0, 0, -1 });
+    int best = 0;
+    int goal = -1;
+    int expansions = 0;
+
+    while (!open.empty() && expansions < MAX_EXPANSIONS) {
+        std::pop_heap(open.begin(), open.end(), std::greater<std::pair<int, int>>());
+        int index = open.back().second;
+        open.pop_back();
+
+        Node node = nodes[index];
+        if (!markVisited(node.tile, node.tick)) continue;
+        ++expansions;
+
+        // Fallback if the search runs out: the node furthest ahead, then closest to the target
+        const Node& bestNode = nodes[best];
+        if (node.tick > bestNode.tick ||
+            (node.tick == bestNode.tick && estimate(node.tile) < estimate(bestNode.tile))) {
+            best = index;
+        }
+
+        // Done at the end of the window, or at the target if we can wait there
+        if (node.tick == window || (node.tile == targetTile && canStay(agent, node.tile, node.tick))) {
+            goal = index;
+            break;
+        }
+
+        int x = node.tile % width;
+        int y = node.tile / width;
+        for (int move = 0; move < 5; ++move) {
+            int nx = x + STEP_X[move];
+            int ny = y + STEP_Y[move];
+            if (!walk.get(nx, ny)) continue;
+
+            int tile = ny * width + nx;
+            if (!isFree(agent, node.tile, tile, node.tick)) continue;
+            push({ tile, node.tick + 1, node.cost + 1, index });
+        }
+    }
+
+    if (goal < 0) {
+        // Rather keep a route that is already known to work than settle for part of one
+        if (hasRoute[agent]) {
+            reserveRoute(agent, agent);
+            return;
+        }
+        goal = best;
+    }
+
+    // Walk back from the goal; a search that found nothing at all still waits one tick
+    int length = nodes[goal].tick + 1;
+    for (int index = goal; index >= 0; index = nodes[index].parent) {
+        route[nodes[index].tick] = nodes[index].tile;
+    }
+    if (length < 2) {
+        route[1] = startTile;
+        length = 2;
+    }
+    finish(length);
+}
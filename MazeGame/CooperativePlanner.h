@@ -0,0 +1,127 @@
+// CooperativePlanner.h
+#pragma once
+#include "BitGrid.h"
+#include "IncrementalPlanner.h"
+#include <cstdint>
+#include <vector>
+
+// Moves a group of agents toward one target without them piling onto the same tile.
+//
+// Agents plan one after another. Each one searches a few steps ahead in space *and*
+// time ("where will I be on each of the next ticks?") and writes its route into a
+// reservation table of (tile, tick) pairs, which the agents after it must avoid.
+// The search is guided by the real walking distance to the target, so in an empty
+// corridor it goes straight there; it only explores when others are in the way.
+//
+// Routes are kept between ticks and an agent only plans again when its route is
+// nearly used up, it is stuck waiting, or it was moved by someone else, so a tick
+// only plans a fraction of the agents. The order agents plan in rotates every tick,
+// so no agent always gets the last pick. The result only depends on the inputs,
+// never on timing.
+class CooperativePlanner {
+public:
+    struct Agent {
+        int x, y;
+    };
+
+    // `window` = how many ticks ahead each agent plans (at most 255).
+    // `maxPlansPerTick` caps how many agents search per step (0 = no cap); the rest
+    // keep following their route or wait, and get their turn on the next step.
+    explicit CooperativePlanner(int window = 8, int maxPlansPerTick = 0);
+
+    // Aim all agents at (x, y) on `walk`. Recomputes the distance map and drops all
+    // routes, so call it only when the target or the layout changes.
+    // If the distances to (x, y) are already known (row by row, as BitBfs::flood makes
+    // them, for example from a flow field), pass them in and they are copied instead.
+    void setTarget(const BitGrid& walk, int x, int y, const std::vector<uint16_t>* distances = nullptr);
+
+    // The tile at (x, y) of `walk` was turned into a wall or a path since setTarget().
+    // Only the distances the change affects are worked out again (see IncrementalPlanner),
+    // and the agents plan new routes on their next step.
+    void updateTile(const BitGrid& walk, int x, int y);
+
+    // Plan one tick: next[i] is where agents[i] should be after it (its own tile = wait).
+    // No two agents end up on the same tile and no two swap places, unless an agent
+    // is boxed in completely. Pass the same agents in the same order every tick.
+    void step(const std::vector<Agent>& agents, std::vector<Agent>& next);
+
+    // Number of (tile, tick) reservations made during the last step
+    int getReservationCount() const { return reservationCount; }
+
+private:
+    // Open-addressing hash table from (tile, tick) to the agent that holds it.
+    // A tile's ticks sit next to each other, and so do neighboring tiles, so a search
+    // mostly touches memory it touched a moment ago. Released entries keep their key
+    // with owner -1.
+    struct ReservationTable {
+        struct Slot {
+            int tile;               // -1 = empty
+            uint32_t tickAndOwner;  // Low 8 bits of the tick, then owner + 1
+        };
+
+        std::vector<Slot> slots;
+        size_t mask = 0;
+
+        void clear(size_t expectedEntries);
+        void reserve(int tile, int tick, int agent);    // agent -1 releases the entry
+        int owner(int tile, int tick) const;    // -1 if free
+    };
+
+    struct Node {
+        int tile;
+        int tick;
+        int cost;
+        int parent;
+    };
+
+    int window;
+    int replanInterval;     // How often agents that are stuck waiting try again
+    int maxPlansPerTick;
+    int tickCounter = 0;
+    int nextToPlan = 0;     // Agent the next step starts planning at
+    int reservationCount = 0;
+
+    BitGrid walk;
+    int targetX = -1;
+    int targetY = -1;
+    int targetTile = -1;
+    std::vector<uint16_t> goalDistance;
+
+    // Keeps goalDistance up to date after wall edits. Only set up on the first edit after
+    // setTarget(), so a target that moves without any edits costs no more than before.
+    IncrementalPlanner repairs;
+    bool repairsReady = false;
+    std::vector<int> repairedTiles;
+
+    ReservationTable reservations;
+    std::vector<uint8_t> hasRoute;
+    std::vector<int> replanning;
+
+    // Route of each agent: tiles for ticks routeStart[i] .. routeStart[i] + window,
+    // stored at routeTiles[i * (window + 1) + k]. Only the ticks up to routeEnd[i] are
+    // reserved; after that the agent is "parked" on its last tile from parkedFrom[i] on,
+    // and nobody else may plan to enter that tile.
+    std::vector<int> routeStart;
+    std::vector<int> routeEnd;
+    std::vector<int> routeTiles;
+    std::vector<int> parkedFrom;
+    std::vector<uint64_t> parkedBy;     // Per tile: (stepStamp << 32) | agent parked there
+    uint32_t stepStamp = 0;
+
+    // Search buffers, reused for every agent
+    std::vector<Node> nodes;
+    std::vector<std::pair<int, int>> open;      // (estimate, node), see planAgent()
+    std::vector<uint64_t> visitedKeys;
+    std::vector<uint32_t> visitedGeneration;
+    uint32_t visitedStamp = 0;
+
+    // Ticks here are counted from the current tick (0 = now)
+    bool isFree(int agent, int fromTile, int toTile, int tick) const;
+    bool canStay(int agent, int tile, int tick) const;
+    bool markVisited(int tile, int tick);
+    void reserveRoute(int agent, int owner);    // owner -1 releases the route
+    void park(int agent, int tile, int fromTick, int owner);
+    void waitInPlace(int agent, const Agent& start);
+    int parkedOwner(int tile) const;    // -1 if nobody is parked there
+    void planAgent(int agent, const Agent& start);
+};
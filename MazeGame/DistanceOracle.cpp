@@ -0,0 +1,272 @@
+// DistanceOracle.cpp
+#include "DistanceOracle.h"
+#include "BitBfs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace {
+    // Batches smaller than this are answered on the calling thread
+    const size_t QUERIES_PER_THREAD = 64;
+
+    const int STEP_X[4] = { 0, 1, 0, -1 };
+    const int STEP_Y[4] = { -1, 0, 1, 0 };
+}
+
+DistanceOracle::DistanceOracle(int landmarkCount)
+    : landmarkCount(std::max(0, landmarkCount)) {
+}
+
+DistanceOracle::~DistanceOracle() {
+    // A background build holds its own copy of the grid; wait so no thread outlives us
+    cancelPending = true;
+    if (pending.valid()) pending.wait();
+}
+
+void DistanceOracle::build(const BitGrid& walkGrid) {
+    walk = std::make_shared<const BitGrid>(walkGrid);
+    tables = buildTables(walk, landmarkCount, nullptr);
+
+    // Whatever was still being built is for an older layout now
+    cancelPending = true;
+    queued.reset();
+}
+
+void DistanceOracle::rebuildAsync(const BitGrid& walkGrid) {
+    walk = std::make_shared<const BitGrid>(walkGrid);
+    if (!pending.valid()) {
+        startBuild(walk);
+        return;
+    }
+
+    // Replaces any layout that was waiting; it would be dropped when done anyway
+    cancelPending = true;
+    queued = walk;
+    collectPending();
+}
+
+void DistanceOracle::startBuild(std::shared_ptr<const BitGrid> grid) {
+    cancelPending = false;
+    pending = std::async(std::launch::async, buildTables, std::move(grid), landmarkCount, &cancelPending);
+}
+
+void DistanceOracle::collectPending() {
+    if (!pending.valid() || pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+    // Tables for older layouts, or none if the build gave up, are simply dropped
+    std::shared_ptr<const Tables> finished = pending.get();
+    if (finished && finished->source == walk) {
+        tables = finished;
+    }
+    if (queued) startBuild(std::move(queued));
+}
+
+bool DistanceOracle::hasLandmarks() {
+    collectPending();
+    return walk && tables && tables->source == walk;
+}
+
+int DistanceOracle::distance(int ax, int ay, int bx, int by) {
+    if (!walk) return -1;
+    const Tables* landmarks = hasLandmarks() ? tables.get() : nullptr;
+    return search(*walk, landmarks, scratch, ax, ay, bx, by);
+}
+
+void DistanceOracle::distances(const std::vector<Query>& queries, std::vector<int>& results) {
+    results.assign(queries.size(), -1);
+    if (!walk || queries.empty()) return;
+
+    // Hold our own references so the grid and tables stay alive while threads use them
+    std::shared_ptr<const BitGrid> grid = walk;
+    std::shared_ptr<const Tables> landmarks = hasLandmarks() ? tables : nullptr;
+
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, queries.size() / QUERIES_PER_THREAD);
+    if (threadCount <= 1) {
+        for (size_t i = 0; i < queries.size(); ++i) {
+            const Query& q = queries[i];
+            results[i] = search(*grid, landmarks.get(), scratch, q.ax, q.ay, q.bx, q.by);
+        }
+        return;
+    }
+
+    // Each worker answers a contiguous slice with its own buffers; slice 0 runs here
+    auto answerSlice = [&](size_t worker, Scratch& buffers) {
+        size_t begin = queries.size() * worker / threadCount;
+        size_t end = queries.size() * (worker + 1) / threadCount;
+        for (size_t i = begin; i < end; ++i) {
+            const Query& q = queries[i];
+            results[i] = search(*grid, landmarks.get(), buffers, q.ax, q.ay, q.bx, q.by);
+        }
+    };
+
+    std::vector<Scratch> workerBuffers(threadCount - 1);
+    std::vector<std::thread> workers;
+    for (size_t worker = 1; worker < threadCount; ++worker) {
+        workers.emplace_back(answerSlice, worker, std::ref(workerBuffers[worker - 1]));
+    }
+    answerSlice(0, scratch);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t DistanceOracle::getMemoryBytes() const {
+    size_t bytes = 0;
+    if (tables) {
+        bytes += tables->distances.capacity() * sizeof(uint16_t);
+        bytes += tables->landmarks.capacity() * sizeof(int);
+    }
+    if (walk) {
+        bytes += walk->words.capacity() * sizeof(uint64_t);
+    }
+    bytes += scratch.cost.capacity() * sizeof(int);
+    bytes += scratch.stamp.capacity() * sizeof(uint32_t);
+    bytes += scratch.open.capacity() * sizeof(OpenEntry);
+    return bytes;
+}
+
+std::shared_ptr<const DistanceOracle::Tables> DistanceOracle::buildTables(
+    std::shared_ptr<const BitGrid> walk, int landmarkCount, const std::atomic<bool>* cancel) {
+    auto result = std::make_shared<Tables>();
+    result->source = walk;
+
+    const int width = walk->width;
+    const int height = walk->height;
+    const size_t tileCount = static_cast<size_t>(width) * height;
+    result->distances.assign(tileCount * landmarkCount, BitBfs::UNREACHED);
+
+    // Steps from each tile to its nearest landmark so far; UNREACHED counts as "very far",
+    // so tiles in parts of the maze without a landmark are picked first
+    std::vector<uint16_t> nearest(tileCount, BitBfs::UNREACHED);
+    std::vector<uint16_t> flood;
+    BitGrid reached(width, height);
+
+    // Pick the walkable tile farthest from every landmark chosen so far
+    auto farthestTile = [&](const std::vector<uint16_t>& from) {
+        int best = -1;
+        int bestDistance = 0;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                if (!walk->get(x, y)) continue;
+                int tile = y * width + x;
+                int d = from[tile];
+                if (best < 0 || d > bestDistance) {
+                    best = tile;
+                    bestDistance = d;
+                }
+            }
+        }
+        return bestDistance > 0 ? best : -1;
+    };
+
+    // The first landmark is the tile farthest from some walkable tile, which tends to be
+    // out at the edge of the maze where landmarks give the best bounds
+    int candidate = farthestTile(nearest);
+    if (candidate >= 0) {
+        BitBfs::flood(*walk, candidate % width, candidate / width, reached, &flood);
+        for (uint16_t& d : flood) {
+            if (d == BitBfs::UNREACHED) d = 0;
+        }
+        int edgeTile = farthestTile(flood);
+        if (edgeTile >= 0) candidate = edgeTile;
+    }
+
+    for (int i = 0; i < landmarkCount && candidate >= 0; ++i) {
+        if (cancel && *cancel) return nullptr;     // Checked between floods, which take the time
+        result->landmarks.push_back(candidate);
+
+        BitBfs::flood(*walk, candidate % width, candidate / width, reached, &flood);
+        for (size_t tile = 0; tile < tileCount; ++tile) {
+            result->distances[tile * landmarkCount + i] = flood[tile];
+            nearest[tile] = std::min(nearest[tile], flood[tile]);
+        }
+
+        // Stops once every tile is a landmark
+        candidate = farthestTile(nearest);
+    }
+    return result;
+}
+
+int DistanceOracle::search(const BitGrid& grid, const Tables* landmarks, Scratch& buffers,
+    int ax, int ay, int bx, int by) const {
+    if (!grid.get(ax, ay) || !grid.get(bx, by)) return -1;
+    if (ax == bx && ay == by) return 0;
+
+    const int width = grid.width;
+    const int start = ay * width + ax;
+    const int target = by * width + bx;
+    const uint16_t* targetRow = landmarks && landmarkCount > 0
+        ? &landmarks->distances[static_cast<size_t>(target) * landmarkCount] : nullptr;
+
+    // A landmark that reaches exactly one of the two tiles proves they aren't connected
+    if (targetRow) {
+        const uint16_t* startRow = &landmarks->distances[static_cast<size_t>(start) * landmarkCount];
+        for (int i = 0; i < landmarkCount; ++i) {
+            if ((startRow[i] == BitBfs::UNREACHED) != (targetRow[i] == BitBfs::UNREACHED)) return -1;
+        }
+    }
+
+    // Lower bound on the steps from `tile` to the target
+    auto bound = [&](int tile) {
+        if (!targetRow) {
+            return std::abs(tile % width - bx) + std::abs(tile / width - by);
+        }
+        const uint16_t* row = &landmarks->distances[static_cast<size_t>(tile) * landmarkCount];
+        int best = std::abs(tile % width - bx) + std::abs(tile / width - by);
+        for (int i = 0; i < landmarkCount; ++i) {
+            if (row[i] == BitBfs::UNREACHED || targetRow[i] == BitBfs::UNREACHED) continue;
+            best = std::max(best, std::abs(static_cast<int>(row[i]) - static_cast<int>(targetRow[i])));
+        }
+        return best;
+    };
+
+    // Reset the buffers by bumping the stamp instead of clearing them
+    size_t tileCount = static_cast<size_t>(width) * grid.height;
+    if (buffers.cost.size() != tileCount) {
+        buffers.cost.assign(tileCount, 0);
+        buffers.stamp.assign(tileCount, 0);
+        buffers.currentStamp = 0;
+    }
+    if (++buffers.currentStamp == 0) {
+        std::fill(buffers.stamp.begin(), buffers.stamp.end(), 0u);
+        buffers.currentStamp = 1;
+    }
+    const uint32_t stamp = buffers.currentStamp;
+
+    std::vector<OpenEntry>& open = buffers.open;
+    open.clear();
+    buffers.cost[start] = 0;
+    buffers.stamp[start] = stamp;
+    open.push_back({ bound(start), 0, start });
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+        OpenEntry current = open.back();
+        open.pop_back();
+
+        if (current.tile == target) return current.cost;
+        if (current.cost != buffers.cost[current.tile]) continue;   // Already found a shorter way here
+
+        int x = current.tile % width;
+        int y = current.tile / width;
+        for (int dir = 0; dir < 4; ++dir) {
+            int nx = x + STEP_X[dir];
+            int ny = y + STEP_Y[dir];
+            if (!grid.get(nx, ny)) continue;
+
+            int next = ny * width + nx;
+            int cost = current.cost + 1;
+            if (buffers.stamp[next] == stamp && buffers.cost[next] <= cost) continue;
+
+            buffers.stamp[next] = stamp;
+            buffers.cost[next] = cost;
+            open.push_back({ cost + bound(next), cost, next });
+            std::push_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,94 @@
+// DistanceOracle.h
+#pragma once
+#include "BitGrid.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Answers "how many steps from A to B" quickly when there are many such questions.
+//
+// A few landmark tiles are picked, and the distance from each landmark to every tile
+// is stored (2 bytes per tile per landmark). Since A -> B can never be shorter than
+// |dist(landmark, A) - dist(landmark, B)|, the tables give a lower bound for any pair,
+// which lets an A* search skip most of the maze (the "ALT" technique).
+//
+// A single oracle must not be queried from several threads at once;
+// use distances() to spread a batch over several cores.
+class DistanceOracle {
+public:
+    struct Query {
+        int ax, ay;
+        int bx, by;
+    };
+
+    // With 0 landmarks every query is a plain A* search
+    explicit DistanceOracle(int landmarkCount = 8);
+    ~DistanceOracle();
+
+    // Build the landmark tables for `walk` and wait until they are done
+    void build(const BitGrid& walk);
+
+    // Switch to a new layout and build its tables on a background thread.
+    // Until they are ready, queries still give exact answers, just without the speed-up.
+    // Only one build runs at a time: a build for an older layout gives up, and the newest
+    // layout is built once it has (older ones that were never started are skipped).
+    void rebuildAsync(const BitGrid& walk);
+
+    // Shortest number of steps between two tiles, or -1 if they aren't connected
+    int distance(int ax, int ay, int bx, int by);
+
+    // Answer many queries at once; results[i] belongs to queries[i]
+    void distances(const std::vector<Query>& queries, std::vector<int>& results);
+
+    // True when the landmark tables match the current layout
+    bool hasLandmarks();
+
+    int getLandmarkCount() const { return landmarkCount; }
+
+    // Memory used by the landmark tables and search buffers, in bytes
+    size_t getMemoryBytes() const;
+
+private:
+    struct Tables {
+        std::shared_ptr<const BitGrid> source;  // Layout the tables were built for
+        std::vector<int> landmarks;         // Tile index of each landmark
+        std::vector<uint16_t> distances;    // [tile * landmarkCount + landmark]
+    };
+
+    struct OpenEntry {
+        int estimate;   // Steps so far + lower bound for the rest
+        int cost;       // Steps so far
+        int tile;
+
+        // Smallest estimate first; on ties, the one furthest along
+        bool operator>(const OpenEntry& other) const {
+            return estimate != other.estimate ? estimate > other.estimate : cost < other.cost;
+        }
+    };
+
+    // Per-thread search buffers
+    struct Scratch {
+        std::vector<int> cost;
+        std::vector<uint32_t> stamp;
+        uint32_t currentStamp = 0;
+        std::vector<OpenEntry> open;
+    };
+
+    int landmarkCount;
+    std::shared_ptr<const BitGrid> walk;        // Layout queries run on
+    std::shared_ptr<const Tables> tables;       // Landmarks, only used if they match `walk`
+    std::future<std::shared_ptr<const Tables>> pending;    // The build running, if any
+    std::shared_ptr<const BitGrid> queued;  // Layout to build once `pending` is done
+    std::atomic<bool> cancelPending{ false };   // Tells the running build to give up
+    Scratch scratch;
+
+    // Returns null if `cancel` was set before the tables were done
+    static std::shared_ptr<const Tables> buildTables(std::shared_ptr<const BitGrid> walk, int landmarkCount,
+        const std::atomic<bool>* cancel);
+    void startBuild(std::shared_ptr<const BitGrid> grid);
+    void collectPending();
+    int search(const BitGrid& grid, const Tables* landmarks, Scratch& buffers, int ax, int ay, int bx, int by) const;
+};
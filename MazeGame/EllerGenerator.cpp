@@ -0,0 +1,147 @@
+// EllerGenerator.cpp
+#include "EllerGenerator.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const int32_t NO_SET = -1;
+
+    // Random numbers for one cell row, worked out from the seed and the row number alone,
+    // so a row comes out the same however it was reached
+    uint32_t rowRandom(uint32_t seed, int64_t cellRow) {
+        uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ static_cast<uint64_t>(cellRow);
+        z += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        uint32_t state = static_cast<uint32_t>(z);
+        return state != 0 ? state : 1;
+    }
+
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    int randomBelow(uint32_t& state, int count) {
+        return static_cast<int>((static_cast<uint64_t>(nextRandom(state)) * static_cast<uint32_t>(count)) >> 32);
+    }
+}
+
+EllerGenerator::EllerGenerator(int width, uint32_t seed)
+    : width(std::max(1, width)),
+    cellsX(std::max(0, (width - 1) / 2)),
+    seed(seed),
+    sets(cellsX, NO_SET),
+    rightOpen(cellsX, 0),
+    downOpen(cellsX, 0),
+    setParent(cellsX * 2),
+    setDrops(cellsX * 2),
+    setSeen(cellsX * 2),
+    setChoice(cellsX * 2),
+    renumber(cellsX * 2) {
+}
+
+int32_t EllerGenerator::findSet(int32_t set) {
+    while (setParent[set] != set) {
+        setParent[set] = setParent[setParent[set]];
+        set = setParent[set];
+    }
+    return set;
+}
+
+void EllerGenerator::getRow(int64_t row, uint8_t* tiles) {
+    std::memset(tiles, 0, width);
+    if (row <= 0 || cellsX == 0) return;     // Top wall
+
+    int64_t cellRow = (row - 1) / 2;
+    if (cellRow != currentRow) {
+        if (cellRow == currentRow + 1) {
+            makeRow(cellRow);
+        }
+        else {
+            // The sets before a corridor row don't matter, so replaying can start there
+            const int64_t anchorInterval = GameConfig::ENDLESS_ANCHOR_INTERVAL;
+            for (int64_t r = cellRow - cellRow % anchorInterval; r <= cellRow; ++r) {
+                makeRow(r);
+            }
+        }
+    }
+
+    for (int cx = 0; cx < cellsX; ++cx) {
+        if (row % 2 == 1) {
+            tiles[cx * 2 + 1] = 1;
+            tiles[cx * 2 + 2] = rightOpen[cx];
+        }
+        else {
+            tiles[cx * 2 + 1] = downOpen[cx];
+        }
+    }
+}
+
+void EllerGenerator::makeRow(int64_t cellRow) {
+    uint32_t random = rowRandom(seed, cellRow);
+    bool corridor = cellRow % GameConfig::ENDLESS_ANCHOR_INTERVAL == 0;
+
+    // Cells nothing comes down into start a set of their own. Sets carried over from the
+    // row above are numbered below cellsX, so new numbers from cellsX up never clash.
+    for (int cx = 0; cx < cellsX; ++cx) {
+        if (corridor || sets[cx] == NO_SET) sets[cx] = cellsX + cx;
+    }
+
+    // Open some walls between neighbors that aren't connected yet (all of them in a corridor)
+    for (int32_t set = 0; set < cellsX * 2; ++set) {
+        setParent[set] = set;
+    }
+    for (int cx = 0; cx < cellsX; ++cx) {
+        rightOpen[cx] = 0;
+        if (cx + 1 == cellsX) break;
+
+        int32_t left = findSet(sets[cx]);
+        int32_t right = findSet(sets[cx + 1]);
+        if (corridor || (left != right && (nextRandom(random) & 1))) {
+            rightOpen[cx] = 1;
+            setParent[right] = left;
+        }
+    }
+    for (int cx = 0; cx < cellsX; ++cx) {
+        sets[cx] = findSet(sets[cx]);
+    }
+
+    // Every cell may continue down, and every set must continue down at least once:
+    // a set where no cell did gets one cell picked at random (reservoir sampling, so a
+    // single pass finds it)
+    std::fill(setDrops.begin(), setDrops.end(), 0);
+    std::fill(setSeen.begin(), setSeen.end(), 0);
+    for (int cx = 0; cx < cellsX; ++cx) {
+        downOpen[cx] = static_cast<uint8_t>(nextRandom(random) & 1);
+        setDrops[sets[cx]] += downOpen[cx];
+    }
+    for (int cx = 0; cx < cellsX; ++cx) {
+        int32_t set = sets[cx];
+        if (setDrops[set] == 0 && randomBelow(random, ++setSeen[set]) == 0) setChoice[set] = cx;
+    }
+    for (int cx = 0; cx < cellsX; ++cx) {
+        int32_t set = sets[cx];
+        if (setDrops[set] == 0 && setChoice[set] == cx) downOpen[cx] = 1;
+    }
+
+    // Sets of the next row, numbered 0, 1, 2, ... in the order they appear
+    std::fill(renumber.begin(), renumber.end(), NO_SET);
+    int32_t nextNumber = 0;
+    for (int cx = 0; cx < cellsX; ++cx) {
+        if (!downOpen[cx]) {
+            sets[cx] = NO_SET;
+            continue;
+        }
+        int32_t& number = renumber[sets[cx]];
+        if (number == NO_SET) number = nextNumber++;
+        sets[cx] = number;
+    }
+
+    currentRow = cellRow;
+}
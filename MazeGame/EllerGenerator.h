@@ -0,0 +1,55 @@
+// EllerGenerator.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// An endless maze made one row at a time with Eller's algorithm.
+//
+// Eller's algorithm only remembers which cells of the current row are already connected
+// to each other (through rows above), as "sets". For each new row it randomly opens walls
+// between neighboring cells of different sets, then lets every set continue down through
+// at least one cell, so no part of the maze is ever cut off. Memory stays the same however
+// many rows are made.
+//
+// Every ANCHOR_INTERVAL-th cell row (GameConfig::ENDLESS_ANCHOR_INTERVAL) is one open
+// corridor. After such a row all cells are connected no matter what came before, so any
+// row can be made again from the seed by replaying at most that many rows. This is what
+// makes replays and jumping back possible. The corridors are the only places with loops.
+//
+// Tile rows: row 0 is the top wall, row 2k + 1 holds cell row k with the openings between
+// its cells, and row 2k + 2 the openings down to cell row k + 1. Column 0 is wall and
+// cells sit on odd columns, like MazeGenerator.
+class EllerGenerator {
+public:
+    // width in tiles; the same width and seed always give the same maze
+    EllerGenerator(int width, uint32_t seed);
+
+    int getWidth() const { return width; }
+
+    // Write tile row `row` into `tiles` (width bytes, 0 = wall, 1 = path). Asking for the
+    // rows in order costs one cell row per two tile rows; anything else replays from the
+    // nearest corridor row at or before it.
+    void getRow(int64_t row, uint8_t* tiles);
+
+private:
+    int width;
+    int cellsX;
+    uint32_t seed;
+
+    // Cell row whose openings are in rightOpen/downOpen, and the sets of the row after it
+    int64_t currentRow = -1;
+    std::vector<int32_t> sets;          // Per cell: set of the next row, or NO_SET
+    std::vector<uint8_t> rightOpen;     // Per cell: opening to the cell on the right
+    std::vector<uint8_t> downOpen;      // Per cell: opening to the cell below
+
+    // Work space for one row, indexed by set number
+    std::vector<int32_t> setParent;     // Union-find for merging sets
+    std::vector<int32_t> setDrops;      // Cells of the set that continue down
+    std::vector<int32_t> setSeen;       // For picking a random cell of a set in one pass
+    std::vector<int32_t> setChoice;
+    std::vector<int32_t> renumber;
+
+    int32_t findSet(int32_t set);
+
+    void makeRow(int64_t cellRow);
+};
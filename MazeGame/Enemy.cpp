@@ -3,7 +3,11 @@
 #include "Maze.h"
 #include "Player.h"
 #include "GameConfig.h"
-#include <cstdlib>
+#include "FlowField.h"
+#include "CooperativePlanner.h"
+#include "Visibility.h"
+#include "GameSession.h"
+#include <algorithm>
 #include "Direction.h"
 namespace {
     struct EnemyData : Entity {
@@ -11,15 +15,12 @@ namespace {
 
         EnemyData(int x, int y)
             : Entity(x, y, ShapeType::TRIANGLE, GameConfig::COLOR_ENEMY_FILL, { 0, 0, 0, 255 }) {
-            direction = static_cast<Direction>(rand() % 4);
+            direction = static_cast<Direction>(GameSession::current().random() % 4);
             setDirection(direction);
             enableRotation(true); // Enable rotation
         }
     };
 
-    std::vector<EnemyData> enemies;
-    Uint64 lastMoveTime = 0;
-
     // Convert dx/dy to Direction
     Direction getDirectionFromDelta(int dx, int dy) {
         if (dx == 1) return Direction::RIGHT;
@@ -30,42 +31,185 @@ namespace {
     }
 }
 
+// Everything the enemies keep for one game
+struct Enemy::SessionState {
+    std::vector<EnemyData> enemies;
+    Uint64 lastMoveTime = 0;
+
+    // What each enemy can see, rebuilt when the walls change
+    VisibilityTable sight;
+    int sightRevision = -1;
+    std::vector<uint8_t> seesPlayer;
+
+    // Shared planner for chasing enemies, and what its distance map was made for
+    CooperativePlanner planner{ GameConfig::ENEMY_PLAN_WINDOW };
+    int plannerTargetX = -1;
+    int plannerTargetY = -1;
+    int plannerRevision = -1;
+};
+
+namespace {
+    // Fill seesPlayer for this move (everyone "sees" the player if sight isn't needed).
+    // Enemies that never chase don't look at all, so the sight table is never built for them.
+    void lookForPlayer(Enemy::SessionState& s, int px, int py) {
+        const auto& enemies = s.enemies;
+        auto& seesPlayer = s.seesPlayer;
+
+        if (!GameConfig::ENEMY_CHASE_PLAYER) {
+            seesPlayer.assign(enemies.size(), 0);
+            return;
+        }
+
+        if (!GameConfig::ENEMY_CHASE_NEEDS_SIGHT) {
+            seesPlayer.assign(enemies.size(), 1);
+            return;
+        }
+
+        if (s.sightRevision != Maze::getRevision()) {
+            s.sight.build(Maze::getWalkGrid(), GameConfig::ENEMY_SIGHT_RANGE);
+            s.sightRevision = Maze::getRevision();
+        }
+
+        std::vector<Visibility::Point> viewers;
+        for (const auto& enemy : enemies) {
+            viewers.push_back({ enemy.getX(), enemy.getY() });
+        }
+        s.sight.canSeeTarget(viewers, px, py, seesPlayer);
+    }
+
+    // Move all enemies one step toward the player without two of them ending up on the same tile
+    void moveTogether(Enemy::SessionState& s, int px, int py) {
+        auto& enemies = s.enemies;
+        if (px != s.plannerTargetX || py != s.plannerTargetY || Maze::getRevision() != s.plannerRevision) {
+            // The flow field toward the player already knows every distance once it is built
+            s.planner.setTarget(Maze::getWalkGrid(), px, py, FlowField::getDistances(px, py));
+            s.plannerTargetX = px;
+            s.plannerTargetY = py;
+            s.plannerRevision = Maze::getRevision();
+        }
+
+        std::vector<CooperativePlanner::Agent> agents;
+        for (const auto& enemy : enemies) {
+            agents.push_back({ enemy.getX(), enemy.getY() });
+        }
+
+        std::vector<CooperativePlanner::Agent> next;
+        s.planner.step(agents, next);
+
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            int dx = next[i].x - agents[i].x;
+            int dy = next[i].y - agents[i].y;
+            if (dx == 0 && dy == 0) continue;   // Waiting for someone to pass
+
+            enemies[i].direction = getDirectionFromDelta(dx, dy);
+            enemies[i].setPosition(next[i].x, next[i].y);
+            enemies[i].setDirection(enemies[i].direction);
+        }
+    }
+}
+
+std::shared_ptr<Enemy::SessionState> Enemy::createSessionState() {
+    return std::make_shared<SessionState>();
+}
+
 void Enemy::add(int x, int y) {
+    auto& enemies = GameSession::current().enemies->enemies;
     if (enemies.size() < GameConfig::MAX_ENEMIES) {
         enemies.emplace_back(x, y);
     }
 }
 
 void Enemy::clearAll() {
+    auto& enemies = GameSession::current().enemies->enemies;
     enemies.clear();
 }
 
 void Enemy::fillRandom() {
-    while (enemies.size() < GameConfig::MAX_ENEMIES) {
-        int x = rand() % GameConfig::MAZE_WIDTH;
-        int y = rand() % GameConfig::MAZE_HEIGHT;
-        if (Maze::isWalkable(x, y)) {
-            bool occupied = false;
-            for (auto& e : enemies) {
-                if (e.getX() == x && e.getY() == y) {
-                    occupied = true;
-                    break;
-                }
-            }
-            if (!occupied) {
-                add(x, y);
-            }
+    GameSession& session = GameSession::current();
+    auto& enemies = session.enemies->enemies;
+
+    auto occupied = [&](int x, int y) {
+        for (auto& e : enemies) {
+            if (e.getX() == x && e.getY() == y) return true;
+        }
+        return false;
+    };
+
+    // Not right next to the player, so a new enemy never hits them before they can react
+    const int px = Player::getX();
+    const int py = Player::getY();
+    auto canSpawn = [&](int x, int y) {
+        if (!Maze::isReachable(x, y) || occupied(x, y)) return false;
+        if (GameConfig::ENEMY_SPAWN_MIN_STEPS <= 0) return true;
+        int steps = Maze::getWalkingDistance(px, py, x, y);
+        return steps < 0 || steps >= GameConfig::ENEMY_SPAWN_MIN_STEPS;
+    };
+
+    // A small area may not have room for all of them: only try for as many as there are free
+    // tiles, or the loop below would never end
+    size_t target = enemies.size();
+    for (int y = 0; y < GameConfig::MAZE_HEIGHT && target < GameConfig::MAX_ENEMIES; ++y) {
+        for (int x = 0; x < GameConfig::MAZE_WIDTH && target < GameConfig::MAX_ENEMIES; ++x) {
+            if (canSpawn(x, y)) ++target;
+        }
+    }
+
+    while (enemies.size() < target) {
+        int x = session.random() % GameConfig::MAZE_WIDTH;
+        int y = session.random() % GameConfig::MAZE_HEIGHT;
+        if (canSpawn(x, y)) {
+            add(x, y);
         }
     }
 }
 
+void Enemy::onTileChanged(int x, int y) {
+    SessionState& s = *GameSession::current().enemies;
+
+    // Only a planner that was up to date right before this edit can be repaired; an older
+    // one is rebuilt on the next move anyway
+    if (s.plannerRevision != Maze::getRevision() - 1) return;
+    s.planner.updateTile(Maze::getWalkGrid(), x, y);
+    s.plannerRevision = Maze::getRevision();
+}
+
 void Enemy::updateAll() {
-    Uint64 now = SDL_GetTicks();
-    if (now - lastMoveTime < GameConfig::ENEMY_MOVE_INTERVAL) return;
+    GameSession& session = GameSession::current();
+    SessionState& s = *session.enemies;
+    auto& enemies = s.enemies;
+
+    int px = Player::getX();
+    int py = Player::getY();
+
+    // Start building the field toward the player early so it's ready when enemies move.
+    // Planning together uses it too, as the distance map that guides the search.
+    if (GameConfig::ENEMY_CHASE_PLAYER) {
+        FlowField::request(px, py);
+    }
 
-    for (auto& enemy : enemies) {
+    Uint64 now = session.now();
+    if (now - s.lastMoveTime < GameConfig::ENEMY_MOVE_INTERVAL) return;
+
+    lookForPlayer(s, px, py);
+
+    if (GameConfig::ENEMY_CHASE_PLAYER && GameConfig::ENEMY_COOPERATIVE_PATHS &&
+        std::find(s.seesPlayer.begin(), s.seesPlayer.end(), 1) != s.seesPlayer.end()) {
+        moveTogether(s, px, py);
+        s.lastMoveTime = now;
+        return;
+    }
+
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        EnemyData& enemy = enemies[i];
         int dx = 0, dy = 0;
 
+        // Steer toward the player; keeps the current direction until the field is ready
+        Direction chaseDir;
+        if (GameConfig::ENEMY_CHASE_PLAYER && !GameConfig::ENEMY_COOPERATIVE_PATHS && s.seesPlayer[i] &&
+            FlowField::getDirection(px, py, enemy.getX(), enemy.getY(), chaseDir)) {
+            enemy.direction = chaseDir;
+        }
+
         switch (enemy.direction) {
         case Direction::RIGHT: dx = 1; break;
         case Direction::DOWN: dy = 1; break;
@@ -78,7 +222,7 @@ void Enemy::updateAll() {
 
         if (!Maze::isWalkable(newX, newY)) {
             // Choose a new random direction
-            enemy.direction = static_cast<Direction>(rand() % 4);
+            enemy.direction = static_cast<Direction>(session.random() % 4);
         }
         else {
             // Move and update facing direction
@@ -87,16 +231,33 @@ void Enemy::updateAll() {
         }
     }
 
-    lastMoveTime = now;
+    s.lastMoveTime = now;
+}
+
+void Enemy::scroll(int dx, int dy) {
+    auto& enemies = GameSession::current().enemies->enemies;
+    for (size_t i = 0; i < enemies.size(); ) {
+        int x = enemies[i].getX() - dx;
+        int y = enemies[i].getY() - dy;
+        if (x < 0 || x >= GameConfig::MAZE_WIDTH || y < 0 || y >= GameConfig::MAZE_HEIGHT) {
+            enemies.erase(enemies.begin() + i);
+        }
+        else {
+            enemies[i].setPosition(x, y);
+            ++i;
+        }
+    }
 }
 
 void Enemy::renderAll() {
+    const auto& enemies = GameSession::current().enemies->enemies;
     for (const auto& enemy : enemies) {
         enemy.render();
     }
 }
 
 bool Enemy::checkCollisionWithPlayer() {
+    const auto& enemies = GameSession::current().enemies->enemies;
     int px = Player::getX();
     int py = Player::getY();
 
@@ -108,3 +269,12 @@ bool Enemy::checkCollisionWithPlayer() {
 
     return false;
 }
+
+std::vector<std::pair<int, int>> Enemy::getPositions() {
+    const auto& enemies = GameSession::current().enemies->enemies;
+    std::vector<std::pair<int, int>> positions;
+    for (const auto& enemy : enemies) {
+        positions.push_back({ enemy.getX(), enemy.getY() });
+    }
+    return positions;
+}
@@ -1,7 +1,9 @@
 // Enemy.h
 #pragma once
 #include "Entity.h"
+#include <utility>
 #include <vector>
+#include <memory>
 
 namespace Enemy {
     void add(int x, int y);
@@ -11,6 +13,21 @@ namespace Enemy {
     void updateAll();
     void renderAll();
 
+    // The maze view moved by (dx, dy) tiles (endless mode, open world): move every enemy
+    // the other way so it stays on its tile. Those that end up outside the view are removed.
+    void scroll(int dx, int dy);
+
+    // The tile at (x, y) just became a wall or a path (called by Maze::setWalkable): the
+    // chasing enemies repair their distances to the player instead of starting over
+    void onTileChanged(int x, int y);
+
     // Check if any enemy is at the player's position
     bool checkCollisionWithPlayer();
+
+    // Tile of every enemy (used by the autoplay bot)
+    std::vector<std::pair<int, int>> getPositions();
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+// FlowField.cpp
+#include "FlowField.h"
+#include "Maze.h"
+#include "GameConfig.h"
+#include "BitBfs.h"
+#include "BitGrid.h"
+#include "GameSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Fields are built with a breadth-first search that starts at the target and spreads
+// out over the maze. When the search reaches a new tile, that tile remembers the
+// direction back toward the tile it was reached from, which is one step closer to the target.
+
+namespace {
+    const int WIDTH = GameConfig::MAZE_WIDTH;
+    const int HEIGHT = GameConfig::MAZE_HEIGHT;
+    const int TILE_COUNT = WIDTH * HEIGHT;
+
+    // One Direction per tile at 2 bits each, so 4 tiles fit in a byte. All four values
+    // are real directions, so a second bit per tile says whether the tile has one at all:
+    // the target itself and tiles walled off from it have nowhere to go.
+    // The search also counts the steps to the target on the way; the cooperative planner
+    // uses those as its distance map (see getDistances).
+    struct PackedField {
+        std::vector<uint8_t> directions;
+        BitGrid hasWay;
+        std::vector<uint16_t> steps;
+    };
+
+    struct CacheEntry {
+        int target;         // Target tile index (y * WIDTH + x)
+        PackedField field;
+    };
+}
+
+// The fields of one game
+struct FlowField::SessionState {
+    // Most recently used fields are at the front, the oldest gets evicted from the back
+    std::list<CacheEntry> cache;
+    std::unordered_map<int, std::list<CacheEntry>::iterator> cacheIndex;
+
+    // Builds that are still running on a background thread
+    std::unordered_map<int, std::future<PackedField>> pending;
+
+    // Copy of the maze walls handed to background builds, so they never read the live maze
+    std::shared_ptr<const BitGrid> walkGrid;
+    int walkGridRevision = -1;
+};
+
+namespace {
+    void setDirection(PackedField& field, int tile, Direction dir) {
+        int shift = (tile % 4) * 2;
+        uint8_t& packed = field.directions[tile / 4];
+        packed = static_cast<uint8_t>((packed & ~(3 << shift)) | (static_cast<int>(dir) << shift));
+        field.hasWay.set(tile % WIDTH, tile / WIDTH, true);
+    }
+
+    // False for the target and for tiles that can't reach it
+    bool readDirection(const PackedField& field, int tile, Direction& dir) {
+        if (!field.hasWay.get(tile % WIDTH, tile / WIDTH)) return false;
+        int shift = (tile % 4) * 2;
+        dir = static_cast<Direction>((field.directions[tile / 4] >> shift) & 3);
+        return true;
+    }
+
+    PackedField buildField(std::shared_ptr<const BitGrid> walk, int target) {
+        PackedField field{ std::vector<uint8_t>((TILE_COUNT + 3) / 4, 0), BitGrid(WIDTH, HEIGHT),
+            std::vector<uint16_t>(TILE_COUNT, BitBfs::UNREACHED) };
+        std::vector<int> queue;
+        queue.reserve(TILE_COUNT);
+
+        field.steps[target] = 0;
+        queue.push_back(target);
+
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int tile = queue[head];
+            int x = tile % WIDTH;
+            int y = tile / WIDTH;
+
+            // "back" is the direction from the neighbor toward the current tile
+            auto visit = [&](int nx, int ny, Direction back) {
+                if (!walk->get(nx, ny)) return;
+                int next = ny * WIDTH + nx;
+                if (field.steps[next] != BitBfs::UNREACHED) return;
+                field.steps[next] = static_cast<uint16_t>(std::min<int>(field.steps[tile] + 1, BitBfs::MAX_DISTANCE));
+                setDirection(field, next, back);
+                queue.push_back(next);
+            };
+
+            visit(x, y - 1, Direction::DOWN);
+            visit(x + 1, y, Direction::LEFT);
+            visit(x, y + 1, Direction::UP);
+            visit(x - 1, y, Direction::RIGHT);
+        }
+
+        return field;
+    }
+
+    // Throw away everything if the maze was reloaded since the fields were built
+    void syncWithMaze(FlowField::SessionState& s) {
+        if (s.walkGridRevision == Maze::getRevision()) return;
+
+        // Waits for running builds to finish; their results are for the old maze
+        s.pending.clear();
+        s.cache.clear();
+        s.cacheIndex.clear();
+
+        s.walkGrid = std::make_shared<BitGrid>(Maze::getWalkGrid());
+        s.walkGridRevision = Maze::getRevision();
+    }
+
+    // Move finished background builds into the cache
+    void collectFinished(FlowField::SessionState& s) {
+        auto& cache = s.cache;
+        for (auto it = s.pending.begin(); it != s.pending.end(); ) {
+            if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+
+            cache.push_front({ it->first, it->second.get() });
+            s.cacheIndex[it->first] = cache.begin();
+
+            while (static_cast<int>(cache.size()) > GameConfig::FLOW_FIELD_CACHE_SIZE) {
+                s.cacheIndex.erase(cache.back().target);
+                cache.pop_back();
+            }
+
+            it = s.pending.erase(it);
+        }
+    }
+}
+
+std::shared_ptr<FlowField::SessionState> FlowField::createSessionState() {
+    return std::make_shared<SessionState>();
+}
+
+void FlowField::request(int targetX, int targetY) {
+    SessionState& s = *GameSession::current().flowFields;
+    syncWithMaze(s);
+    collectFinished(s);
+
+    if (!Maze::isWalkable(targetX, targetY)) return;
+
+    int target = targetY * WIDTH + targetX;
+    if (s.cacheIndex.count(target) || s.pending.count(target)) return;
+
+    s.pending[target] = std::async(std::launch::async, buildField, s.walkGrid, target);
+}
+
+bool FlowField::getDirection(int targetX, int targetY, int x, int y, Direction& dir) {
+    if (!Maze::isWalkable(targetX, targetY)) return false;
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return false;
+
+    request(targetX, targetY);
+
+    SessionState& s = *GameSession::current().flowFields;
+    auto found = s.cacheIndex.find(targetY * WIDTH + targetX);
+    if (found == s.cacheIndex.end()) return false;
+
+    // Mark as most recently used
+    s.cache.splice(s.cache.begin(), s.cache, found->second);
+
+    return readDirection(found->second->field, y * WIDTH + x, dir);
+}
+
+const std::vector<uint16_t>* FlowField::getDistances(int targetX, int targetY) {
+    if (!Maze::isWalkable(targetX, targetY)) return nullptr;
+
+    request(targetX, targetY);
+
+    SessionState& s = *GameSession::current().flowFields;
+    auto found = s.cacheIndex.find(targetY * WIDTH + targetX);
+    if (found == s.cacheIndex.end()) return nullptr;
+
+    // Mark as most recently used
+    s.cache.splice(s.cache.begin(), s.cache, found->second);
+    return &found->second->field.steps;
+}
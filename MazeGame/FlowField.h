@@ -0,0 +1,30 @@
+// FlowField.h
+#pragma once
+#include "Direction.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// A flow field stores, for every tile of the maze, which way to step to get one tile
+// closer to a target. Fields are cached per target tile, so many enemies chasing the
+// same target share one field and steering becomes a single table lookup.
+namespace FlowField {
+    // Make sure a field toward (targetX, targetY) exists.
+    // If it isn't cached yet, it is built on a background thread and becomes
+    // available on a later frame. Calling this again for a cached target is cheap.
+    void request(int targetX, int targetY);
+
+    // Look up which way to step from (x, y) to get closer to the target.
+    // Returns false if the field isn't ready yet (it is requested automatically),
+    // and for the target itself and tiles that can't reach it, which have no way to go.
+    bool getDirection(int targetX, int targetY, int x, int y, Direction& dir);
+
+    // Steps from every tile to the target (row by row, BitBfs::UNREACHED where there is no way),
+    // or nullptr if the field isn't ready yet (it is requested automatically).
+    // The pointer is only good until the next call into FlowField.
+    const std::vector<uint16_t>* getDistances(int targetX, int targetY);
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
+}
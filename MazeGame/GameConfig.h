@@ -60,6 +60,86 @@ namespace GameConfig {
 	inline const Uint64 INVULNERABLE_DURATION = 1000;
 
 
+	// --- Enemy AI ---
+
+	// If true, enemies walk toward the player along the shortest path instead of wandering.
+	inline const bool ENEMY_CHASE_PLAYER = false;
+
+	// How many flow fields (shortest-path maps toward one target tile) are kept in memory.
+	// When full, the one used longest ago is thrown away.
+	inline const int FLOW_FIELD_CACHE_SIZE = 8;
+
+	// If true, chasing enemies plan their moves together so they spread out through
+	// corridors instead of stacking on the same tile. The plans are guided by the flow
+	// field toward the player; if false, each enemy simply follows that field.
+	inline const bool ENEMY_COOPERATIVE_PATHS = true;
+
+	// How many moves ahead each chasing enemy plans when ENEMY_COOPERATIVE_PATHS is on.
+	inline const int ENEMY_PLAN_WINDOW = 8;
+
+	// If true, chasing enemies only go after the player while they can see them;
+	// otherwise they wander. Planning together, the whole group chases once one of them sees the player.
+	inline const bool ENEMY_CHASE_NEEDS_SIGHT = true;
+
+	// How many tiles away enemies can see (walls block the view). At most 7.
+	inline const int ENEMY_SIGHT_RANGE = 6;
+
+	// Random enemies never appear closer to the player than this many steps (0 = anywhere).
+	// Enemies placed by the layout itself stay where they are.
+	inline const int ENEMY_SPAWN_MIN_STEPS = 4;
+
+
+	// --- Hint Overlay ---
+
+	// If true, the shortest way from the player to the goal is shown from the start.
+	// Press H during the game to turn it on or off.
+	inline const bool HINT_START_ENABLED = false;
+
+
+	// --- Autoplay ---
+
+	// If true, a bot plays the game from the start. Press A during the game to turn it on or off.
+	inline const bool AUTOPLAY_START_ENABLED = false;
+
+	// How often the bot moves the player (ms).
+	inline const Uint64 AUTOPLAY_STEP_INTERVAL = 150;
+
+	// How long the bot thinks about each move (ms). Keep this below AUTOPLAY_STEP_INTERVAL.
+	inline const Uint64 AUTOPLAY_THINK_TIME = 100;
+
+
+	// --- Endless Mode --- (start the game with "--endless [seed]")
+
+	// The maze scrolls up as soon as the player is this many rows from the bottom.
+	inline const int ENDLESS_SCROLL_MARGIN = 4;
+
+	// Points and extra seconds for every new row that scrolls into view.
+	inline const int ENDLESS_ROW_SCORE = 1;
+	inline const int ENDLESS_ROW_TIME_BONUS = 1;
+
+	// Every this many rows of cells the endless maze has one long open corridor.
+	// Smaller values make jumping back to an old row faster, but the maze gets more open.
+	inline const int ENDLESS_ANCHOR_INTERVAL = 64;
+
+
+	// --- Open World --- (start the game with "--world [seed]")
+
+	// The view moves as soon as the player is this many tiles from one of its edges.
+	inline const int WORLD_SCROLL_MARGIN = 5;
+
+	// How many openings each 64x64 chunk of the world has into the chunk on its left
+	// and into the one above. More openings make fewer long detours.
+	inline const int WORLD_CHUNK_DOORS = 2;
+
+	// How much memory (in KB) the chunks made so far may take. When it is full, the chunk
+	// used longest ago is thrown away; it is made again, the same way, if the player comes back.
+	inline const int WORLD_CACHE_KB = 512;
+
+	// Chunks up to this many chunks away from the player's one are made in the background
+	// before the player gets there.
+	inline const int WORLD_PREFETCH_RADIUS = 1;
+
+
 	// --- Displays ---
 
 	// Number of decimal places to show for time played in the end-of-game popup.
@@ -86,6 +166,9 @@ namespace GameConfig {
 	inline const SDL_Color COLOR_ITEM_FILL = { 255, 255, 0, 255 };
 	inline const SDL_Color COLOR_GOAL_FILL = { 0, 0, 255, 255 };
 
+	// Color of the dots showing the way to the goal when the hint is on.
+	inline const SDL_Color COLOR_HINT = { 0, 160, 255, 255 };
+
 	// Text color used for UI labels (score, time, lives).
 	inline const SDL_Color COLOR_TEXT = { 255, 255, 255, 255 };
 
@@ -0,0 +1,209 @@
+// GameSession.cpp
+#include "GameSession.h"
+#include "GameConfig.h"
+#include "Maze.h"
+#include "Player.h"
+#include "Goal.h"
+#include "Item.h"
+#include "Enemy.h"
+#include "FlowField.h"
+#include "LevelProgression.h"
+#include "VisualEffect.h"
+#include "HintPath.h"
+#include "AutoPlay.h"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+    // The session set by GameSession::Use on this thread, if any
+    thread_local GameSession* active = nullptr;
+}
+
+GameSession::GameSession(unsigned seed, bool manualClock)
+    : maze(Maze::createSessionState()),
+    player(Player::createSessionState()),
+    goal(Goal::createSessionState()),
+    items(Item::createSessionState()),
+    enemies(Enemy::createSessionState()),
+    flowFields(FlowField::createSessionState()),
+    effects(VisualEffect::createSessionState()),
+    progression(LevelProgression::createSessionState()),
+    hints(HintPath::createSessionState()),
+    autoPlay(AutoPlay::createSessionState()),
+    manualClock(manualClock),
+    randomEngine(seed) {
+    resetStats();
+}
+
+// Waits for flow field builds, level preparation, hint searches and bot moves still
+// running on background threads
+GameSession::~GameSession() = default;
+
+GameSession& GameSession::current() {
+    if (active) return *active;
+
+    // The windowed game's session, made on first use
+    static GameSession defaultSession(1, false);
+    return defaultSession;
+}
+
+GameSession::Use::Use(GameSession& session) : previous(active) {
+    active = &session;
+}
+
+GameSession::Use::~Use() {
+    active = previous;
+}
+
+void GameSession::start(const std::vector<std::vector<int>>& layout) {
+    Use use(*this);
+    Maze::loadLayout(layout);
+    resetStats();
+}
+
+void GameSession::startEndless(uint32_t seed) {
+    Use use(*this);
+    Maze::loadEndless(seed);
+    resetStats();
+}
+
+void GameSession::startWorld(uint32_t seed) {
+    Use use(*this);
+    Maze::loadWorld(seed);
+    resetStats();
+}
+
+void GameSession::startNextLevel(const std::vector<std::vector<int>>& layout) {
+    Use use(*this);
+    Maze::loadLayout(layout);
+
+    int keptScore = score;
+    int keptLives = playerLives;
+    Uint64 firstStartTime = gameStartTime;
+    resetStats();
+    score = keptScore;
+    playerLives = keptLives;
+    gameStartTime = firstStartTime;     // Play time counts all levels
+}
+
+void GameSession::restart() {
+    Use use(*this);
+    Maze::reload();
+    resetStats();
+}
+
+void GameSession::resetStats() {
+    gameOver = false;
+    gameWon = false;
+    timeRemaining = 100;
+    playerLives = GameConfig::PLAYER_LIVES;
+    score = 0;
+    invulnerable = false;
+    gameStartTime = now();
+    lastTimeDecrease = gameStartTime;
+}
+
+void GameSession::movePlayer(int dx, int dy) {
+    Use use(*this);
+    Player::move(dx, dy);
+}
+
+Uint64 GameSession::now() const {
+    return manualClock ? clock : SDL_GetTicks();
+}
+
+void GameSession::advanceTime(Uint64 ms) {
+    clock += ms;
+}
+
+int GameSession::random() {
+    // minstd_rand never returns more than 2^31 - 2, so this always fits
+    return static_cast<int>(randomEngine());
+}
+
+void GameSession::seedRandom(unsigned seed) {
+    randomEngine.seed(seed);
+}
+
+Uint64 GameSession::getPlayTime() const {
+    return now() - gameStartTime;
+}
+
+Uint64 GameSession::getInvulnerableLeft() const {
+    return invulnerable ? GameConfig::INVULNERABLE_DURATION - (now() - invulnerableStartTime) : 0;
+}
+
+Uint64 GameSession::getNextSecondIn() const {
+    return GameConfig::TIME_DECREASE_INTERVAL - (now() - lastTimeDecrease);
+}
+
+void GameSession::update() {
+    if (gameOver) return;
+
+    Use use(*this);
+    Uint64 time = now();
+
+    // Handle invulnerability timer
+    if (invulnerable && time - invulnerableStartTime >= GameConfig::INVULNERABLE_DURATION) {
+        invulnerable = false;
+    }
+
+    // Decrease timer every second
+    if (time - lastTimeDecrease >= GameConfig::TIME_DECREASE_INTERVAL) {
+        timeRemaining--;
+        lastTimeDecrease = time;
+    }
+
+    // Update game objects
+    Player::update();
+
+    // Endless mode: keep some rows below the player, with a point and a second for each new one
+    while (Maze::isEndless() && Player::getY() >= GameConfig::MAZE_HEIGHT - GameConfig::ENDLESS_SCROLL_MARGIN) {
+        Maze::scrollEndless();
+        score += GameConfig::ENDLESS_ROW_SCORE;
+        timeRemaining += GameConfig::ENDLESS_ROW_TIME_BONUS;
+    }
+    // Open world: move the view so the player stays a few tiles away from its edges
+    if (Maze::isWorld()) {
+        const int margin = GameConfig::WORLD_SCROLL_MARGIN;
+        int x = Player::getX(), y = Player::getY();
+        int dx = std::min(0, x - margin) + std::max(0, x - (GameConfig::MAZE_WIDTH - 1 - margin));
+        int dy = std::min(0, y - margin) + std::max(0, y - (GameConfig::MAZE_HEIGHT - 1 - margin));
+        Maze::scrollWorld(dx, dy);
+    }
+    Enemy::updateAll();
+    Item::updateAll();
+    VisualEffect::updateAll();
+
+    // Check for item pickup
+    Item::checkCollection(score);
+
+    // Check for enemy collision
+    if (!invulnerable && Enemy::checkCollisionWithPlayer()) {
+        playerLives -= GameConfig::LIFE_LOSS_ON_HIT;
+        invulnerable = true;
+        invulnerableStartTime = time;
+
+        VisualEffect::EffectConfig config;
+        config.color = { 255, 0, 0, 255 }; // Red for damage
+        config.fontSize = 28;
+        config.riseSpeed = 0.08f;
+        config.duration = 1200;
+
+        VisualEffect::add("-" + std::to_string(GameConfig::LIFE_LOSS_ON_HIT) + " Life",
+            Player::getX(), Player::getY(), config);
+    }
+
+    // Win condition
+    if (Goal::checkReached()) {
+        gameWon = true;
+        gameOver = true;
+    }
+
+    // Lose condition
+    if (timeRemaining <= 0 || playerLives <= 0) {
+        gameWon = false;
+        gameOver = true;
+    }
+}
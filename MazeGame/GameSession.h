@@ -0,0 +1,133 @@
+// GameSession.h
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// What each module keeps for one game; the structs are defined in the modules' .cpp files
+namespace Maze { struct SessionState; }
+namespace Player { struct SessionState; }
+namespace Goal { struct SessionState; }
+namespace Item { struct SessionState; }
+namespace Enemy { struct SessionState; }
+namespace FlowField { struct SessionState; }
+namespace LevelProgression { struct SessionState; }
+namespace VisualEffect { struct SessionState; }
+namespace HintPath { struct SessionState; }
+namespace AutoPlay { struct SessionState; }
+
+// One complete game: the maze, the player, the goal, items, enemies, floating texts,
+// score, lives and timers. Nothing about a game lives outside its session, so any
+// number of sessions can run side by side.
+//
+// The Maze, Player, Enemy, ... functions always work on the "current" session of the
+// thread that calls them. The windowed game never picks one and uses the default
+// session, which runs on SDL's clock. A server or test harness creates its own
+// sessions and drives them from any thread with start(), movePlayer() and update();
+// those make the session current while they run. A session must not be used by two
+// threads at the same time, but different sessions can be used on different threads.
+class GameSession {
+public:
+    // manualClock = true: time stands still until advanceTime() is called, which keeps a
+    // headless game independent of how fast it is simulated. false: the clock is SDL_GetTicks().
+    explicit GameSession(unsigned seed = 1, bool manualClock = true);
+    ~GameSession();
+
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
+
+    // The session the module functions use on this thread
+    static GameSession& current();
+
+    // Makes a session current on this thread until the Use goes out of scope
+    class Use {
+    public:
+        explicit Use(GameSession& session);
+        ~Use();
+
+        Use(const Use&) = delete;
+        Use& operator=(const Use&) = delete;
+
+    private:
+        GameSession* previous;
+    };
+
+    // Load a layout (see main.cpp for the tile values) and start a fresh game on it
+    void start(const std::vector<std::vector<int>>& layout);
+
+    // Start a fresh game in endless mode (see Maze::loadEndless)
+    void startEndless(uint32_t seed);
+
+    // Start a fresh game in the open world (see Maze::loadWorld)
+    void startWorld(uint32_t seed);
+
+    // Load the next level's layout, keeping score and lives; the timer starts over
+    void startNextLevel(const std::vector<std::vector<int>>& layout);
+
+    // Start again on the same layout
+    void restart();
+
+    // Score, lives and timers back to the start of a game; the maze is left alone
+    void resetStats();
+
+    // Move the player one tile if there is no wall in the way
+    void movePlayer(int dx, int dy);
+
+    // Run everything that happens over time (enemies, items, timers, hits, win/lose)
+    void update();
+
+    // Time in milliseconds
+    Uint64 now() const;
+    void advanceTime(Uint64 ms);
+
+    // Random numbers for this game only (never negative, like rand())
+    int random();
+    void seedRandom(unsigned seed);
+
+    int getScore() const { return score; }
+    int getTimeRemaining() const { return timeRemaining; }
+    int getLives() const { return playerLives; }
+    bool isOver() const { return gameOver; }
+    bool hasWon() const { return gameWon; }
+    bool isInvulnerable() const { return invulnerable; }
+
+    // How long the game has been running (ms)
+    Uint64 getPlayTime() const;
+
+    // How long until the player can be hit again / the timer goes down again (ms)
+    Uint64 getInvulnerableLeft() const;
+    Uint64 getNextSecondIn() const;
+
+    // Per-module data. Only the modules themselves look inside.
+    std::shared_ptr<Maze::SessionState> maze;
+    std::shared_ptr<Player::SessionState> player;
+    std::shared_ptr<Goal::SessionState> goal;
+    std::shared_ptr<Item::SessionState> items;
+    std::shared_ptr<Enemy::SessionState> enemies;
+    std::shared_ptr<FlowField::SessionState> flowFields;
+    std::shared_ptr<VisualEffect::SessionState> effects;
+    std::shared_ptr<LevelProgression::SessionState> progression;
+    std::shared_ptr<HintPath::SessionState> hints;
+    std::shared_ptr<AutoPlay::SessionState> autoPlay;
+
+private:
+    const bool manualClock;
+    Uint64 clock = 0;
+    std::minstd_rand randomEngine;
+
+    bool gameOver = false;
+    bool gameWon = false;
+
+    int score = 0;
+    int timeRemaining = 100;
+    int playerLives = 0;
+
+    Uint64 gameStartTime = 0;
+    Uint64 lastTimeDecrease = 0;
+
+    // For invulnerability after being hit
+    bool invulnerable = false;
+    Uint64 invulnerableStartTime = 0;
+};
@@ -0,0 +1,276 @@
+// GameSim.cpp
+#include "GameSim.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+
+namespace {
+    // Same tile numbers as in the layout passed to Maze::loadLayout
+    const int PATH = 1;
+    const int ITEM = 2;
+    const int PLAYER_START = 3;
+    const int GOAL = 4;
+    const int ENEMY = 5;
+
+    // Items number their directions differently: right, down, left, up
+    const int ITEM_STEP_X[4] = { 1, 0, -1, 0 };
+    const int ITEM_STEP_Y[4] = { 0, 1, 0, -1 };
+
+    // Spawn tiles and goal distances, once the walls, start and goal are known
+    void finishLevel(GameSim::Level& level) {
+        std::vector<int> queue;
+        std::vector<int> fromPlayer;
+        GameSim::distancesFrom(level, level.playerY * level.width + level.playerX, fromPlayer, queue);
+        for (size_t tile = 0; tile < fromPlayer.size(); ++tile) {
+            if (fromPlayer[tile] < 0) continue;
+            level.spawnTiles.push_back(static_cast<int>(tile));
+            if (fromPlayer[tile] >= GameConfig::ENEMY_SPAWN_MIN_STEPS) level.enemySpawnTiles.push_back(static_cast<int>(tile));
+        }
+
+        int goalTile = level.goalX >= 0 ? level.goalY * level.width + level.goalX : -1;
+        GameSim::distancesFrom(level, goalTile, level.goalDistance, queue);
+    }
+
+    // Fill `movers` up to `count` with random free tiles of `spawnTiles`, like Item/Enemy::fillRandom
+    void fillRandom(const GameSim::Level& level, const std::vector<int>& spawnTiles, GameSim::State& state,
+        GameSim::Mover* movers, int& moverCount, int count) {
+        if (spawnTiles.empty()) return;
+        int attempts = 0;
+        while (moverCount < count && attempts++ < 100000) {
+            int tile = spawnTiles[GameSim::nextRandom(state) % spawnTiles.size()];
+            int x = tile % level.width;
+            int y = tile / level.width;
+            bool occupied = false;
+            for (int i = 0; i < moverCount; ++i) {
+                if (movers[i].x == x && movers[i].y == y) occupied = true;
+            }
+            if (!occupied) movers[moverCount++] = { x, y, static_cast<int>(GameSim::nextRandom(state) % 4) };
+        }
+    }
+}
+
+GameSim::Rules::Rules()
+    : enemyMoveInterval(GameConfig::ENEMY_MOVE_INTERVAL),
+    maxEnemies(GameConfig::MAX_ENEMIES),
+    playerLives(GameConfig::PLAYER_LIVES),
+    timeLimit(100),
+    playerStepInterval(150) {
+}
+
+GameSim::Level GameSim::makeLevel(const std::vector<std::vector<int>>& layout, const Rules& rules) {
+    Level level;
+    level.rules = rules;
+    level.height = static_cast<int>(layout.size());
+    for (const auto& row : layout) {
+        level.width = std::max(level.width, static_cast<int>(row.size()));
+    }
+    level.walkable.assign(static_cast<size_t>(level.width) * level.height, 0);
+
+    for (int y = 0; y < level.height; ++y) {
+        for (int x = 0; x < static_cast<int>(layout[y].size()); ++x) {
+            int cell = layout[y][x];
+            if (cell < PATH || cell > ENEMY) continue;  // Walls and unknown tiles
+            level.walkable[y * level.width + x] = 1;
+
+            if (cell == ITEM) level.items.push_back({ x, y });
+            if (cell == ENEMY) level.enemies.push_back({ x, y });
+            if (cell == PLAYER_START) {
+                level.playerX = x;
+                level.playerY = y;
+            }
+            if (cell == GOAL) {
+                level.goalX = x;
+                level.goalY = y;
+            }
+        }
+    }
+
+    finishLevel(level);
+    return level;
+}
+
+GameSim::Level GameSim::makeLevel(const BitGrid& walk, int playerX, int playerY, int goalX, int goalY, const Rules& rules) {
+    Level level;
+    level.rules = rules;
+    level.width = walk.width;
+    level.height = walk.height;
+    level.walkable.assign(static_cast<size_t>(level.width) * level.height, 0);
+    for (int y = 0; y < level.height; ++y) {
+        for (int x = 0; x < level.width; ++x) {
+            level.walkable[y * level.width + x] = walk.get(x, y) ? 1 : 0;
+        }
+    }
+    level.playerX = playerX;
+    level.playerY = playerY;
+    level.goalX = goalX;
+    level.goalY = goalY;
+
+    finishLevel(level);
+    return level;
+}
+
+uint32_t GameSim::nextRandom(State& state) {
+    // xorshift: tiny, fast, and its whole state is one number that is copied with the game
+    uint32_t x = state.random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state.random = x;
+    return x;
+}
+
+GameSim::State GameSim::newGame(const Level& level, uint32_t seed) {
+    State state = {};
+    state.random = seed != 0 ? seed : 1;    // xorshift never leaves 0
+    state.playerX = level.playerX;
+    state.playerY = level.playerY;
+    state.lives = level.rules.playerLives;
+    state.timeRemaining = level.rules.timeLimit;
+
+    const int maxItems = std::min(GameConfig::MAX_ITEMS, MAX_SIM_ITEMS);
+    for (const auto& item : level.items) {
+        if (state.itemCount < maxItems) state.items[state.itemCount++] = { item.first, item.second, static_cast<int>(nextRandom(state) % 4) };
+    }
+    fillRandom(level, level.spawnTiles, state, state.items, state.itemCount, maxItems);
+
+    const int maxEnemies = std::min(level.rules.maxEnemies, MAX_SIM_ENEMIES);
+    for (const auto& enemy : level.enemies) {
+        if (state.enemyCount < maxEnemies) state.enemies[state.enemyCount++] = { enemy.first, enemy.second, static_cast<int>(nextRandom(state) % 4) };
+    }
+    fillRandom(level, level.enemySpawnTiles, state, state.enemies, state.enemyCount, maxEnemies);
+
+    // The player's first move comes one step interval in, like every later one
+    state.nextStep = level.rules.playerStepInterval;
+    state.nextSecond = GameConfig::TIME_DECREASE_INTERVAL;
+    state.nextEnemyMove = level.rules.enemyMoveInterval;
+    state.nextItemMove = GameConfig::ITEM_MOVE_INTERVAL;
+    return state;
+}
+
+void GameSim::step(const Level& level, State& state, int dir, Scratch& scratch) {
+    bool moved = false;
+
+    // Jump from one event to the next instead of simulating every frame
+    while (!state.over) {
+        Uint64 now = std::min({ state.nextStep, state.nextSecond, state.nextEnemyMove, state.nextItemMove });
+
+        if (now == state.nextStep) {
+            if (moved) return;  // The player's next move is up to the caller
+            if (dir >= 0 && level.isWalkable(state.playerX + STEP_X[dir], state.playerY + STEP_Y[dir])) {
+                state.playerX += STEP_X[dir];
+                state.playerY += STEP_Y[dir];
+            }
+            moved = true;
+            state.nextStep += level.rules.playerStepInterval;
+        }
+        state.now = now;
+
+        if (now == state.nextSecond) {
+            --state.timeRemaining;
+            state.nextSecond += GameConfig::TIME_DECREASE_INTERVAL;
+        }
+
+        if (now == state.nextEnemyMove) {
+            if (GameConfig::ENEMY_CHASE_PLAYER) {
+                distancesFrom(level, state.playerY * level.width + state.playerX, scratch.distance, scratch.queue);
+            }
+            for (int i = 0; i < state.enemyCount; ++i) {
+                Mover& enemy = state.enemies[i];
+                if (GameConfig::ENEMY_CHASE_PLAYER) {
+                    int chase = stepDownhill(level, scratch.distance, enemy.x, enemy.y);
+                    if (chase != STAY) enemy.dir = chase;
+                }
+                int nx = enemy.x + STEP_X[enemy.dir];
+                int ny = enemy.y + STEP_Y[enemy.dir];
+                if (!level.isWalkable(nx, ny)) {
+                    enemy.dir = static_cast<int>(nextRandom(state) % 4);
+                }
+                else {
+                    enemy.x = nx;
+                    enemy.y = ny;
+                }
+            }
+            state.nextEnemyMove += level.rules.enemyMoveInterval;
+        }
+
+        if (now == state.nextItemMove) {
+            for (int i = 0; i < state.itemCount; ++i) {
+                Mover& item = state.items[i];
+                int nx = item.x + ITEM_STEP_X[item.dir];
+                int ny = item.y + ITEM_STEP_Y[item.dir];
+                if (!level.isWalkable(nx, ny)) {
+                    item.dir = static_cast<int>(nextRandom(state) % 4);
+                }
+                else {
+                    item.x = nx;
+                    item.y = ny;
+                }
+            }
+            state.nextItemMove += GameConfig::ITEM_MOVE_INTERVAL;
+        }
+
+        // Collected items are replaced by the last one, so the array stays packed
+        for (int i = 0; i < state.itemCount; ) {
+            if (state.items[i].x == state.playerX && state.items[i].y == state.playerY) {
+                state.score += GameConfig::ITEM_SCORE;
+                state.items[i] = state.items[--state.itemCount];
+            }
+            else {
+                ++i;
+            }
+        }
+
+        if (now >= state.invulnerableUntil) {
+            for (int i = 0; i < state.enemyCount; ++i) {
+                if (state.enemies[i].x == state.playerX && state.enemies[i].y == state.playerY) {
+                    state.lives -= GameConfig::LIFE_LOSS_ON_HIT;
+                    state.invulnerableUntil = now + GameConfig::INVULNERABLE_DURATION;
+                    break;
+                }
+            }
+        }
+
+        if (state.playerX == level.goalX && state.playerY == level.goalY) {
+            state.won = true;
+            state.over = true;
+        }
+        else if (state.timeRemaining <= 0 || state.lives <= 0) {
+            state.over = true;
+        }
+    }
+}
+
+void GameSim::distancesFrom(const Level& level, int tile, std::vector<int>& distance, std::vector<int>& queue) {
+    distance.assign(level.walkable.size(), -1);
+    queue.clear();
+    if (tile < 0 || !level.walkable[tile]) return;
+
+    distance[tile] = 0;
+    queue.push_back(tile);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int current = queue[head];
+        int x = current % level.width;
+        int y = current / level.width;
+        for (int dir = 0; dir < 4; ++dir) {
+            int nx = x + STEP_X[dir];
+            int ny = y + STEP_Y[dir];
+            if (!level.isWalkable(nx, ny)) continue;
+
+            int next = ny * level.width + nx;
+            if (distance[next] >= 0) continue;
+            distance[next] = distance[current] + 1;
+            queue.push_back(next);
+        }
+    }
+}
+
+int GameSim::stepDownhill(const Level& level, const std::vector<int>& distance, int x, int y) {
+    int here = distance[y * level.width + x];
+    if (here <= 0) return STAY;
+    for (int dir = 0; dir < 4; ++dir) {
+        int nx = x + STEP_X[dir];
+        int ny = y + STEP_Y[dir];
+        if (level.isWalkable(nx, ny) && distance[ny * level.width + nx] == here - 1) return dir;
+    }
+    return STAY;
+}
@@ -0,0 +1,113 @@
+// GameSim.h
+#pragma once
+#include "BitGrid.h"
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A copy of the game's rules that runs without a window, for bots that play or plan ahead.
+//
+// Everything that changes during a game lives in State, which only holds plain values
+// and fixed-size arrays (no pointers, no vectors). Copying a State with `=` is a single
+// block copy of a few hundred bytes, so a bot can clone the game thousands of times per
+// move to try out different futures. The parts that never change (walls, goal, rules)
+// live in Level and are shared by all copies.
+namespace GameSim {
+    // Most items and enemies a State can hold
+    const int MAX_SIM_ITEMS = 16;
+    const int MAX_SIM_ENEMIES = 16;
+
+    // Player moves; 0-3 follow the Direction enum (up, right, down, left)
+    const int STAY = -1;
+    inline const int STEP_X[4] = { 0, 1, 0, -1 };
+    inline const int STEP_Y[4] = { -1, 0, 1, 0 };
+
+    // The settings a game is played with (defaults come from GameConfig)
+    struct Rules {
+        Uint64 enemyMoveInterval;
+        int maxEnemies;
+        int playerLives;
+        int timeLimit;              // Seconds on the clock at the start
+        Uint64 playerStepInterval;  // How often the player gets to move (ms)
+
+        Rules();
+    };
+
+    // Everything about a game that stays the same while it is played
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> walkable;
+        int playerX = 1, playerY = 1;
+        int goalX = -1, goalY = -1;
+        std::vector<std::pair<int, int>> items;     // Placed by the layout
+        std::vector<std::pair<int, int>> enemies;
+        std::vector<int> spawnTiles;    // Where random items may go (the player's area)
+        std::vector<int> enemySpawnTiles;   // The same without the tiles near the player's start
+        std::vector<int> goalDistance;  // Steps from every tile to the goal (-1 = can't get there)
+        Rules rules;
+
+        bool isWalkable(int x, int y) const {
+            return x >= 0 && x < width && y >= 0 && y < height && walkable[y * width + x];
+        }
+    };
+
+    // Build a level from a layout in the same format as Maze::loadLayout
+    Level makeLevel(const std::vector<std::vector<int>>& layout, const Rules& rules);
+
+    // Build a level from walls only (items and enemies are all placed randomly)
+    Level makeLevel(const BitGrid& walk, int playerX, int playerY, int goalX, int goalY, const Rules& rules);
+
+    struct Mover {
+        int x, y;
+        int dir;
+    };
+
+    // One moment of a game. Safe to copy: it has no pointers into anything else.
+    struct State {
+        int playerX, playerY;
+        int lives;
+        int score;
+        int timeRemaining;
+        bool won;
+        bool over;
+
+        // Times (ms since the start) of the next event of each kind
+        Uint64 now;
+        Uint64 nextStep;
+        Uint64 nextSecond;
+        Uint64 nextEnemyMove;
+        Uint64 nextItemMove;
+        Uint64 invulnerableUntil;
+
+        uint32_t random;    // Random number state; change it to try a different future
+
+        int itemCount;
+        int enemyCount;
+        Mover items[MAX_SIM_ITEMS];
+        Mover enemies[MAX_SIM_ENEMIES];
+    };
+
+    // Work buffers for the searches inside step(); one per thread, reused between calls
+    struct Scratch {
+        std::vector<int> distance;
+        std::vector<int> queue;
+    };
+
+    // A fresh game with items and enemies placed like Item/Enemy::fillRandom do
+    State newGame(const Level& level, uint32_t seed);
+
+    // Move the player (a direction or STAY) and run the game until the player's next move
+    // or the end of the game, in the same order as Game::handleInput and Game::update
+    void step(const Level& level, State& state, int dir, Scratch& scratch);
+
+    // Random number from the state's own generator
+    uint32_t nextRandom(State& state);
+
+    // Steps from `tile` to every tile (-1 if it can't be reached)
+    void distancesFrom(const Level& level, int tile, std::vector<int>& distance, std::vector<int>& queue);
+
+    // Direction that gets one step closer according to `distance`, or STAY if none does
+    int stepDownhill(const Level& level, const std::vector<int>& distance, int x, int y);
+}
@@ -3,19 +3,39 @@
 #include "Player.h"
 #include "Entity.h"
 #include "GameConfig.h"
+#include "GameSession.h"
+
+struct Goal::SessionState {
+    Entity goal{ 0, 0, ShapeType::DIAMOND, GameConfig::COLOR_GOAL_FILL, { 0, 0, 0, 255 } };
+};
 
 namespace {
-    Entity goal(0, 0, ShapeType::DIAMOND, GameConfig::COLOR_GOAL_FILL, { 0, 0, 0, 255 });
+    Entity& goal() {
+        return GameSession::current().goal->goal;
+    }
+}
+
+std::shared_ptr<Goal::SessionState> Goal::createSessionState() {
+    return std::make_shared<SessionState>();
 }
 
 void Goal::setPosition(int x, int y) {
-    goal.setPosition(x, y);
+    goal().setPosition(x, y);
 }
 
 void Goal::render() {
-    goal.render();
+    if (goal().getX() < 0) return;  // No goal (endless mode)
+    goal().render();
 }
 
 bool Goal::checkReached() {
-    return Player::getX() == goal.getX() && Player::getY() == goal.getY();
-}
\ No newline at end of file
+    return Player::getX() == goal().getX() && Player::getY() == goal().getY();
+}
+
+int Goal::getX() {
+    return goal().getX();
+}
+
+int Goal::getY() {
+    return goal().getY();
+}
@@ -1,7 +1,15 @@
 // Goal.h
 #pragma once
+#include <memory>
 namespace Goal {
 	void setPosition(int x, int y);
 	void render();
 	bool checkReached();
+
+	int getX();
+	int getY();
+
+	// What this module keeps for one game (see GameSession.h)
+	struct SessionState;
+	std::shared_ptr<SessionState> createSessionState();
 }
@@ -0,0 +1,170 @@
+// HintPath.cpp
+#include "HintPath.h"
+#include "DistanceOracle.h"
+#include "PathWorker.h"
+#include "Maze.h"
+#include "Player.h"
+#include "Goal.h"
+#include "GameConfig.h"
+#include "GameSession.h"
+#include "Game.h"
+#include "Renderer.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The overlay of one game
+struct HintPath::SessionState {
+    bool enabled = GameConfig::HINT_START_ENABLED;
+    PathWorker worker;
+
+    // Copy of the maze walls handed to the worker, so it never reads the live maze
+    std::shared_ptr<const BitGrid> walkGrid;
+    int walkGridRevision = -1;
+
+    // What the newest request was for; a new one is sent when any of it changes
+    int requestedPlayerX = -1, requestedPlayerY = -1;
+    int requestedGoalX = -1, requestedGoalY = -1;
+    int requestedRevision = -1;
+
+    std::vector<std::pair<int, int>> path;
+
+    // Steps to the goal, shown above the maze. The oracle's landmark tables are rebuilt in
+    // the background when the walls change; until then it still answers, just slower.
+    DistanceOracle oracle;
+    int oracleRevision = -1;
+    int goalSteps = -1;
+
+    // The oracle is only asked on a background thread, one question at a time, so the frame
+    // never waits for an A* search; the last answer stays on screen until the next one is in.
+    // Nothing else touches the oracle while a question is running. Declared after the oracle
+    // so it is waited for first.
+    std::future<int> pendingSteps;
+    int stepsPlayerX = -1, stepsPlayerY = -1;
+    int stepsGoalX = -1, stepsGoalY = -1;
+    int stepsRevision = -1;
+};
+
+namespace {
+    HintPath::SessionState& state() {
+        return *GameSession::current().hints;
+    }
+}
+
+namespace {
+    // Picks up the oracle's answer if it is in, and asks again if anything moved since
+    void updateGoalSteps(HintPath::SessionState& s, int px, int py, int gx, int gy, int revision) {
+        if (s.pendingSteps.valid()) {
+            if (s.pendingSteps.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+            s.goalSteps = s.pendingSteps.get();
+        }
+        if (px == s.stepsPlayerX && py == s.stepsPlayerY && gx == s.stepsGoalX && gy == s.stepsGoalY &&
+            revision == s.stepsRevision) return;
+
+        // Safe here: no question is running, so the oracle is all ours
+        if (s.oracleRevision != revision) {
+            s.oracle.rebuildAsync(Maze::getWalkGrid());
+            s.oracleRevision = revision;
+        }
+        DistanceOracle* oracle = &s.oracle;
+        s.pendingSteps = std::async(std::launch::async, [oracle, px, py, gx, gy] {
+            return oracle->distance(px, py, gx, gy);
+        });
+
+        s.stepsPlayerX = px;
+        s.stepsPlayerY = py;
+        s.stepsGoalX = gx;
+        s.stepsGoalY = gy;
+        s.stepsRevision = revision;
+    }
+}
+
+std::shared_ptr<HintPath::SessionState> HintPath::createSessionState() {
+    return std::make_shared<SessionState>();
+}
+
+void HintPath::toggle() {
+    SessionState& s = state();
+    s.enabled = !s.enabled;
+    if (!s.enabled) {
+        s.path.clear();
+        s.requestedRevision = -1;   // Ask again when turned back on
+    }
+}
+
+bool HintPath::isEnabled() {
+    return state().enabled;
+}
+
+void HintPath::update() {
+    SessionState& s = state();
+    if (!s.enabled) return;
+
+    int px = Player::getX();
+    int py = Player::getY();
+    int gx = Goal::getX();
+    int gy = Goal::getY();
+    int revision = Maze::getRevision();
+
+    if (px != s.requestedPlayerX || py != s.requestedPlayerY || gx != s.requestedGoalX || gy != s.requestedGoalY ||
+        revision != s.requestedRevision) {
+        if (s.walkGridRevision != revision) {
+            s.walkGrid = std::make_shared<BitGrid>(Maze::getWalkGrid());
+            s.walkGridRevision = revision;
+        }
+        s.worker.request(s.walkGrid, px, py, gx, gy);
+
+        // A mapped maze's goal is usually far outside the view; only its sidecar knows the way.
+        // Its hierarchy answers in a few microseconds, so it is asked right here.
+        if (Maze::isMapped()) {
+            s.goalSteps = Maze::getMappedGoalSteps(px, py);
+        }
+
+        s.requestedPlayerX = px;
+        s.requestedPlayerY = py;
+        s.requestedGoalX = gx;
+        s.requestedGoalY = gy;
+        s.requestedRevision = revision;
+    }
+
+    // Keeps the old path if the new one isn't ready yet
+    s.worker.takeResult(s.path);
+
+    if (!Maze::isMapped()) updateGoalSteps(s, px, py, gx, gy, revision);
+}
+
+void HintPath::render() {
+    const SessionState& s = state();
+    if (!s.enabled) return;
+    if (s.goalSteps >= 0) {
+        Renderer::renderText("Goal: " + std::to_string(s.goalSteps) + " steps", GameConfig::WINDOW_WIDTH - 220, 0,
+            GameConfig::COLOR_HINT);
+    }
+    if (s.path.size() < 3) return;
+
+    SDL_Renderer* renderer = Game::getRenderer();
+    SDL_Color color = GameConfig::COLOR_HINT;
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+
+    // A small dot in the middle of every tile between the player and the goal
+    const float dotSize = GameConfig::TILE_SIZE / 5.0f;
+    for (size_t i = 1; i + 1 < s.path.size(); ++i) {
+        SDL_FRect dot = {
+            s.path[i].first * GameConfig::TILE_SIZE + (GameConfig::TILE_SIZE - dotSize) / 2.0f,
+            s.path[i].second * GameConfig::TILE_SIZE + GameConfig::UI_OFFSET_Y + (GameConfig::TILE_SIZE - dotSize) / 2.0f,
+            dotSize,
+            dotSize
+        };
+        SDL_RenderFillRect(renderer, &dot);
+    }
+}
+
+void HintPath::shutdown() {
+    SessionState& s = state();
+    s.worker.stop();
+    if (s.pendingSteps.valid()) s.pendingSteps.wait();
+}
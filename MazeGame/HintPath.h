@@ -0,0 +1,27 @@
+// HintPath.h
+#pragma once
+#include <memory>
+
+// Optional overlay showing the shortest way from the player to the goal.
+// The path is searched on a background thread every time the player moves, so
+// drawing never waits for it; until a new path arrives the last one stays on screen.
+// The number of steps to the goal is shown above the maze too (see DistanceOracle); it is
+// worked out in the background as well, and the last number stays until the next is in.
+namespace HintPath {
+    // Turn the overlay on or off (the H key)
+    void toggle();
+    bool isEnabled();
+
+    // Call once per frame: asks for a new path when something moved and picks up finished ones
+    void update();
+
+    // Draw the path on top of the maze tiles
+    void render();
+
+    // Stop the background search thread
+    void shutdown();
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
+}
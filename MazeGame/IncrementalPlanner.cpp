@@ -0,0 +1,165 @@
+// IncrementalPlanner.cpp
+#include "IncrementalPlanner.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+namespace {
+    // Distance of tiles that can't reach the target. Small enough that adding 1 can't overflow.
+    const int UNREACHABLE = INT_MAX / 2;
+
+    const int STEP_X[4] = { 0, 1, 0, -1 };
+    const int STEP_Y[4] = { -1, 0, 1, 0 };
+}
+
+void IncrementalPlanner::setTarget(const BitGrid& walkGrid, int targetX, int targetY) {
+    walk = walkGrid;
+    width = walk.width;
+    height = walk.height;
+    targetTile = walk.get(targetX, targetY) ? targetY * width + targetX : -1;
+
+    size_t tileCount = static_cast<size_t>(width) * height;
+    g.assign(tileCount, UNREACHABLE);
+    rhs.assign(tileCount, UNREACHABLE);
+    queue.clear();
+    repairCount = 0;
+    if (targetTile < 0) return;
+
+    // Plain breadth-first search for the starting distances; every tile agrees with its neighbors afterwards
+    std::vector<int> frontier;
+    frontier.reserve(tileCount);
+    frontier.push_back(targetTile);
+    g[targetTile] = rhs[targetTile] = 0;
+
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        int tile = frontier[head];
+        int x = tile % width;
+        int y = tile / width;
+        for (int dir = 0; dir < 4; ++dir) {
+            int nx = x + STEP_X[dir];
+            int ny = y + STEP_Y[dir];
+            if (!walk.get(nx, ny)) continue;
+
+            int next = ny * width + nx;
+            if (g[next] != UNREACHABLE) continue;
+            g[next] = rhs[next] = g[tile] + 1;
+            frontier.push_back(next);
+        }
+    }
+}
+
+void IncrementalPlanner::updateTile(const BitGrid& walkGrid, int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    bool walkable = walkGrid.get(x, y);
+    if (walkable == walk.get(x, y)) return;
+    walk.set(x, y, walkable);
+
+    // Only the tile itself and its neighbors can have a different rhs now
+    refresh(y * width + x);
+    for (int dir = 0; dir < 4; ++dir) {
+        int nx = x + STEP_X[dir];
+        int ny = y + STEP_Y[dir];
+        if (nx >= 0 && nx < width && ny >= 0 && ny < height) refresh(ny * width + nx);
+    }
+}
+
+int IncrementalPlanner::distance(int x, int y) {
+    if (!walk.get(x, y) || targetTile < 0) return -1;
+
+    int tile = y * width + x;
+    repairUntil(tile);
+    return g[tile] == UNREACHABLE ? -1 : g[tile];
+}
+
+bool IncrementalPlanner::nextStep(int x, int y, Direction& dir) {
+    int steps = distance(x, y);
+    if (steps <= 0) return false;
+
+    // After the repair every neighbor one step closer has its final distance
+    for (int d = 0; d < 4; ++d) {
+        int nx = x + STEP_X[d];
+        int ny = y + STEP_Y[d];
+        if (walk.get(nx, ny) && g[ny * width + nx] == steps - 1) {
+            dir = static_cast<Direction>(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+void IncrementalPlanner::repairAll(std::vector<int>* changedTiles) {
+    repairUntil(-1, changedTiles);
+}
+
+int IncrementalPlanner::bestNeighbor(int tile) const {
+    int x = tile % width;
+    int y = tile / width;
+    if (!walk.get(x, y)) return UNREACHABLE;
+    if (tile == targetTile) return 0;
+
+    int best = UNREACHABLE;
+    for (int dir = 0; dir < 4; ++dir) {
+        int nx = x + STEP_X[dir];
+        int ny = y + STEP_Y[dir];
+        if (walk.get(nx, ny)) best = std::min(best, g[ny * width + nx]);
+    }
+    return best == UNREACHABLE ? UNREACHABLE : best + 1;
+}
+
+void IncrementalPlanner::refresh(int tile) {
+    rhs[tile] = bestNeighbor(tile);
+    if (g[tile] != rhs[tile]) push(tile);
+}
+
+void IncrementalPlanner::push(int tile) {
+    queue.push_back({ std::min(g[tile], rhs[tile]), tile });
+    std::push_heap(queue.begin(), queue.end(), std::greater<std::pair<int, int>>());
+}
+
+void IncrementalPlanner::repairUntil(int stopTile, std::vector<int>* changedTiles) {
+    while (!queue.empty()) {
+        // Every tile closer than the smallest key in the queue already has its final distance
+        if (stopTile >= 0 && g[stopTile] == rhs[stopTile] && queue.front().first >= g[stopTile]) return;
+
+        std::pop_heap(queue.begin(), queue.end(), std::greater<std::pair<int, int>>());
+        std::pair<int, int> entry = queue.back();
+        queue.pop_back();
+
+        int tile = entry.second;
+        if (g[tile] == rhs[tile] || std::min(g[tile], rhs[tile]) != entry.first) continue;  // Outdated entry
+        ++repairCount;
+        if (changedTiles) changedTiles->push_back(tile);
+
+        int x = tile % width;
+        int y = tile / width;
+        if (g[tile] > rhs[tile]) {
+            // Got closer: neighbors may now be reachable in fewer steps through this tile
+            g[tile] = rhs[tile];
+            for (int dir = 0; dir < 4; ++dir) {
+                int nx = x + STEP_X[dir];
+                int ny = y + STEP_Y[dir];
+                if (!walk.get(nx, ny)) continue;
+
+                int next = ny * width + nx;
+                if (next == targetTile || rhs[next] <= g[tile] + 1) continue;
+                rhs[next] = g[tile] + 1;
+                if (g[next] != rhs[next]) push(next);
+            }
+        }
+        else {
+            // Got farther (or cut off): forget the old distance, and recheck the neighbors
+            // that were counting on it
+            int old = g[tile];
+            g[tile] = UNREACHABLE;
+            refresh(tile);
+            for (int dir = 0; dir < 4; ++dir) {
+                int nx = x + STEP_X[dir];
+                int ny = y + STEP_Y[dir];
+                if (!walk.get(nx, ny)) continue;
+
+                int next = ny * width + nx;
+                if (next != targetTile && rhs[next] == old + 1) refresh(next);
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// IncrementalPlanner.h
+#pragma once
+#include "BitGrid.h"
+#include "Direction.h"
+#include <utility>
+#include <vector>
+
+// Distances from every tile to one target that stay correct while walls are added
+// and removed, without searching the whole maze again after each change.
+//
+// This is the idea behind LPA* / D* Lite: every tile remembers its distance `g`
+// and a second value `rhs` = "1 + the smallest distance of my neighbors". When a
+// wall changes, only the tiles around it get a new rhs, and a tile whose two values
+// disagree goes into a queue. Working through the queue (closest tiles first) fixes
+// exactly the tiles whose distance really changed and nothing else.
+//
+// The queue is only worked through as far as a question needs: asking about an
+// enemy near the target stays cheap even if an edit far away changed half the maze.
+//
+// Queries can repair the tree, so one planner must not be used from several threads at once.
+class IncrementalPlanner {
+public:
+    // Measure distances to (targetX, targetY) over the walkable tiles of `walk`.
+    // This is one full search; after it only edits cost extra work.
+    void setTarget(const BitGrid& walk, int targetX, int targetY);
+
+    // Tell the planner the tile at (x, y) was changed in `walk`. Cheap: the actual
+    // repair happens in the next query or in repairAll().
+    void updateTile(const BitGrid& walk, int x, int y);
+
+    // Steps from (x, y) to the target, or -1 if the target can't be reached from there
+    int distance(int x, int y);
+
+    // Which way to step from (x, y) to get one tile closer to the target.
+    // Returns false if (x, y) is the target or can't reach it.
+    bool nextStep(int x, int y, Direction& dir);
+
+    // Finish all pending repairs now (for example before copying the distances out).
+    // If `changedTiles` is not null, every tile whose distance was recomputed is added to it.
+    void repairAll(std::vector<int>* changedTiles = nullptr);
+
+    // Tiles whose distance had to be recomputed since setTarget()
+    long long getRepairCount() const { return repairCount; }
+
+private:
+    int width = 0;
+    int height = 0;
+    int targetTile = -1;
+    BitGrid walk;
+
+    std::vector<int> g;     // Current distance of each tile
+    std::vector<int> rhs;   // Distance its neighbors suggest; the tile is fine when both agree
+
+    // (key, tile) pairs, smallest key on top. Entries are never removed when a tile
+    // changes again; outdated ones are skipped when they come out.
+    std::vector<std::pair<int, int>> queue;
+    long long repairCount = 0;
+
+    int bestNeighbor(int tile) const;   // rhs a tile should have
+    void refresh(int tile);             // Recompute rhs and queue the tile if it is off
+    void push(int tile);
+    void repairUntil(int tile, std::vector<int>* changedTiles = nullptr);  // -1 = until nothing is left
+};
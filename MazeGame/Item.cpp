@@ -4,8 +4,7 @@
 #include "Player.h"
 #include "GameConfig.h"
 #include "VisualEffect.h"
-
-#include <cstdlib>
+#include "GameSession.h"
 
 namespace {
     struct ItemData : Entity {
@@ -13,48 +12,69 @@ namespace {
 
         ItemData(int x, int y)
             : Entity(x, y, ShapeType::CIRCLE, GameConfig::COLOR_ITEM_FILL, { 0, 0, 0, 255 }),
-            direction(rand() % 4) {
+            direction(GameSession::current().random() % 4) {
         }
     };
+}
 
+struct Item::SessionState {
     std::vector<ItemData> items;
     Uint64 lastMoveTime = 0;
+};
+
+std::shared_ptr<Item::SessionState> Item::createSessionState() {
+    return std::make_shared<SessionState>();
 }
 
 void Item::add(int x, int y) {
+    auto& items = GameSession::current().items->items;
     if (items.size() < GameConfig::MAX_ITEMS) {
         items.emplace_back(x, y);
     }
 }
 
 void Item::clearAll() {
+    auto& items = GameSession::current().items->items;
     items.clear();
 }
 
 void Item::fillRandom() {
-    while (items.size() < GameConfig::MAX_ITEMS) {
-        int x = rand() % GameConfig::MAZE_WIDTH;
-        int y = rand() % GameConfig::MAZE_HEIGHT;
-        if (Maze::isWalkable(x, y)) {
-            bool occupied = false;
-            for (auto& i : items) {
-                if (i.getX() == x && i.getY() == y) {
-                    occupied = true;
-                    break;
-                }
-            }
-            if (!occupied) {
-                add(x, y);
-            }
+    GameSession& session = GameSession::current();
+    auto& items = session.items->items;
+
+    auto occupied = [&](int x, int y) {
+        for (auto& i : items) {
+            if (i.getX() == x && i.getY() == y) return true;
+        }
+        return false;
+    };
+
+    // A small area may not have room for all of them: only try for as many as there are free
+    // tiles, or the loop below would never end
+    size_t target = items.size();
+    for (int y = 0; y < GameConfig::MAZE_HEIGHT && target < GameConfig::MAX_ITEMS; ++y) {
+        for (int x = 0; x < GameConfig::MAZE_WIDTH && target < GameConfig::MAX_ITEMS; ++x) {
+            if (Maze::isReachable(x, y) && !occupied(x, y)) ++target;
+        }
+    }
+
+    while (items.size() < target) {
+        int x = session.random() % GameConfig::MAZE_WIDTH;
+        int y = session.random() % GameConfig::MAZE_HEIGHT;
+        if (Maze::isReachable(x, y) && !occupied(x, y)) {
+            add(x, y);
         }
     }
 }
 
 void Item::updateAll() {
-    Uint64 now = SDL_GetTicks();
-    if (now - lastMoveTime < GameConfig::ITEM_MOVE_INTERVAL) return;
+    GameSession& session = GameSession::current();
+    SessionState& s = *session.items;
+
+    Uint64 now = session.now();
+    if (now - s.lastMoveTime < GameConfig::ITEM_MOVE_INTERVAL) return;
 
-    for (auto& item : items) {
+    for (auto& item : s.items) {
         int newX = item.getX();
         int newY = item.getY();
 
@@ -66,23 +86,40 @@ void Item::updateAll() {
         }
 
         if (!Maze::isWalkable(newX, newY)) {
-            item.direction = rand() % 4;
+            item.direction = session.random() % 4;
         }
         else {
             item.setPosition(newX, newY);
         }
     }
 
-    lastMoveTime = now;
+    s.lastMoveTime = now;
+}
+
+void Item::scroll(int dx, int dy) {
+    auto& items = GameSession::current().items->items;
+    for (size_t i = 0; i < items.size(); ) {
+        int x = items[i].getX() - dx;
+        int y = items[i].getY() - dy;
+        if (x < 0 || x >= GameConfig::MAZE_WIDTH || y < 0 || y >= GameConfig::MAZE_HEIGHT) {
+            items.erase(items.begin() + i);
+        }
+        else {
+            items[i].setPosition(x, y);
+            ++i;
+        }
+    }
 }
 
 void Item::renderAll() {
+    const auto& items = GameSession::current().items->items;
     for (const auto& item : items) {
         item.render();
     }
 }
 
 void Item::checkCollection(int& score) {
+    auto& items = GameSession::current().items->items;
     int px = Player::getX();
     int py = Player::getY();
 
@@ -107,3 +144,12 @@ void Item::checkCollection(int& score) {
         }
     }
 }
+
+std::vector<std::pair<int, int>> Item::getPositions() {
+    const auto& items = GameSession::current().items->items;
+    std::vector<std::pair<int, int>> positions;
+    for (const auto& item : items) {
+        positions.push_back({ item.getX(), item.getY() });
+    }
+    return positions;
+}
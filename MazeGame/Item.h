@@ -1,7 +1,9 @@
 // Item.h
 #pragma once
 #include "Entity.h"
+#include <utility>
 #include <vector>
+#include <memory>
 
 namespace Item {
     void add(int x, int y);
@@ -11,5 +13,16 @@ namespace Item {
     void updateAll();
     void renderAll();
 
+    // The maze view moved by (dx, dy) tiles (endless mode, open world): move every item
+    // the other way so it stays on its tile. Those that end up outside the view are removed.
+    void scroll(int dx, int dy);
+
     void checkCollection(int& score);
+
+    // Tile of every item (used by the autoplay bot)
+    std::vector<std::pair<int, int>> getPositions();
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
 }
\ No newline at end of file
@@ -0,0 +1,401 @@
+// JunctionGraph.cpp
+#include "JunctionGraph.h"
+
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+// Directions use the same numbering as the Direction enum: 0 = up, 1 = right, 2 = down, 3 = left
+
+namespace {
+    const int DX[4] = { 0, 1, 0, -1 };
+    const int DY[4] = { -1, 0, 1, 0 };
+
+    int opposite(int dir) {
+        return (dir + 2) % 4;
+    }
+}
+
+bool JunctionGraph::isJunction(const BitGrid& walk, int x, int y) const {
+    if (!walk.get(x, y)) return false;
+
+    int neighbors = 0;
+    for (int d = 0; d < 4; ++d) {
+        if (walk.get(x + DX[d], y + DY[d])) ++neighbors;
+    }
+    return neighbors != 2;
+}
+
+int JunctionGraph::addNode(int tile) {
+    int id;
+    if (!freeNodes.empty()) {
+        id = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[id] = Node();
+    }
+    else {
+        id = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    nodes[id].tile = tile;
+    nodes[id].alive = true;
+    tileNode[tile] = id;
+    ++liveNodes;
+    return id;
+}
+
+void JunctionGraph::removeNode(int node) {
+    tileNode[nodes[node].tile] = -1;
+    nodes[node].alive = false;
+    freeNodes.push_back(node);
+    --liveNodes;
+}
+
+void JunctionGraph::removeEdge(int edge, std::vector<int>& touchedNodes, std::vector<int>& freedTiles) {
+    Edge& e = edges[edge];
+    for (int tile : e.tiles) {
+        tileEdge[tile] = -1;
+        freedTiles.push_back(tile);
+    }
+
+    nodes[e.a].edges[e.dirA] = -1;
+    nodes[e.b].edges[e.dirB] = -1;
+    touchedNodes.push_back(e.a);
+    touchedNodes.push_back(e.b);
+
+    e.tiles.clear();
+    e.alive = false;
+    freeEdges.push_back(edge);
+    --liveEdges;
+}
+
+// Follow the corridor leaving `node` in direction `dir` until it reaches another node
+void JunctionGraph::traceEdge(const BitGrid& walk, int node, int dir) {
+    int x = nodes[node].tile % width + DX[dir];
+    int y = nodes[node].tile / width + DY[dir];
+    int cameFrom = opposite(dir);
+
+    std::vector<int> corridor;
+    while (tileNode[y * width + x] < 0) {
+        corridor.push_back(y * width + x);
+
+        // A corridor tile has exactly two exits: the one we came from and the next one
+        int nextDir = 0;
+        for (int d = 0; d < 4; ++d) {
+            if (d != cameFrom && walk.get(x + DX[d], y + DY[d])) {
+                nextDir = d;
+                break;
+            }
+        }
+        x += DX[nextDir];
+        y += DY[nextDir];
+        cameFrom = opposite(nextDir);
+    }
+
+    int id;
+    if (!freeEdges.empty()) {
+        id = freeEdges.back();
+        freeEdges.pop_back();
+    }
+    else {
+        id = static_cast<int>(edges.size());
+        edges.emplace_back();
+    }
+
+    Edge& e = edges[id];
+    e.a = node;
+    e.b = tileNode[y * width + x];
+    e.dirA = dir;
+    e.dirB = cameFrom;
+    e.tiles = std::move(corridor);
+    e.alive = true;
+    ++liveEdges;
+
+    nodes[e.a].edges[e.dirA] = id;
+    nodes[e.b].edges[e.dirB] = id;
+    for (size_t i = 0; i < e.tiles.size(); ++i) {
+        tileEdge[e.tiles[i]] = id;
+        tileOffset[e.tiles[i]] = static_cast<int>(i) + 1;
+    }
+}
+
+void JunctionGraph::traceAllFrom(const BitGrid& walk, int node) {
+    int x = nodes[node].tile % width;
+    int y = nodes[node].tile / width;
+    for (int d = 0; d < 4; ++d) {
+        if (nodes[node].edges[d] < 0 && walk.get(x + DX[d], y + DY[d])) {
+            traceEdge(walk, node, d);
+        }
+    }
+}
+
+void JunctionGraph::build(const BitGrid& walk) {
+    width = walk.width;
+    height = walk.height;
+    liveNodes = 0;
+    liveEdges = 0;
+    nodes.clear();
+    edges.clear();
+    freeNodes.clear();
+    freeEdges.clear();
+
+    size_t tileCount = static_cast<size_t>(width) * height;
+    tileNode.assign(tileCount, -1);
+    tileEdge.assign(tileCount, -1);
+    tileOffset.assign(tileCount, 0);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (isJunction(walk, x, y)) addNode(y * width + x);
+        }
+    }
+
+    for (int node = 0; node < static_cast<int>(nodes.size()); ++node) {
+        traceAllFrom(walk, node);
+    }
+
+    // Loops made only of corridor tiles have no junction, so one of their tiles becomes a node
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int tile = y * width + x;
+            if (walk.get(x, y) && tileNode[tile] < 0 && tileEdge[tile] < 0) {
+                traceAllFrom(walk, addNode(tile));
+            }
+        }
+    }
+}
+
+void JunctionGraph::updateTile(const BitGrid& walk, int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+
+    // Only the changed tile and its neighbors can change between corridor and junction
+    std::vector<int> area = { y * width + x };
+    for (int d = 0; d < 4; ++d) {
+        int nx = x + DX[d];
+        int ny = y + DY[d];
+        if (nx >= 0 && nx < width && ny >= 0 && ny < height) area.push_back(ny * width + nx);
+    }
+
+    // Remove every edge running through or ending in the area
+    std::vector<int> touchedNodes, freedTiles;
+    for (int tile : area) {
+        if (tileEdge[tile] >= 0) removeEdge(tileEdge[tile], touchedNodes, freedTiles);
+
+        int node = tileNode[tile];
+        if (node < 0) continue;
+        for (int d = 0; d < 4; ++d) {
+            if (nodes[node].edges[d] >= 0) removeEdge(nodes[node].edges[d], touchedNodes, freedTiles);
+        }
+    }
+
+    // Make the nodes in the area match the new layout
+    for (int tile : area) {
+        bool junction = isJunction(walk, tile % width, tile / width);
+        if (tileNode[tile] >= 0 && !junction) removeNode(tileNode[tile]);
+        if (tileNode[tile] < 0 && junction) touchedNodes.push_back(addNode(tile));
+    }
+
+    // Trace the corridors again from every node that lost an edge
+    for (int node : touchedNodes) {
+        if (nodes[node].alive) traceAllFrom(walk, node);
+    }
+
+    // Corridor tiles that weren't reached belong to a loop without a junction
+    freedTiles.insert(freedTiles.end(), area.begin(), area.end());
+    for (int tile : freedTiles) {
+        if (walk.get(tile % width, tile / width) && tileNode[tile] < 0 && tileEdge[tile] < 0) {
+            traceAllFrom(walk, addNode(tile));
+        }
+    }
+}
+
+int JunctionGraph::otherEnd(const Edge& edge, int node, int dir) const {
+    return (edge.a == node && edge.dirA == dir) ? edge.b : edge.a;
+}
+
+bool JunctionGraph::getAttachments(int x, int y, std::vector<Attach>& out) const {
+    out.clear();
+    if (x < 0 || x >= width || y < 0 || y >= height) return false;
+
+    int tile = y * width + x;
+    if (tileNode[tile] >= 0) {
+        out.push_back({ tileNode[tile], 0, false });
+        return true;
+    }
+    if (tileEdge[tile] < 0) return false;
+
+    const Edge& e = edges[tileEdge[tile]];
+    int offset = tileOffset[tile];
+    out.push_back({ e.a, offset, true });
+    out.push_back({ e.b, e.length() - offset, false });
+    return true;
+}
+
+// Dijkstra over the nodes, starting from all sources at once.
+// Returns the best distance (-1 if none) and which target it ended at (-1 for directCost).
+// Source nodes store -1 - (index into sources) as their parent edge.
+int JunctionGraph::search(const std::vector<Attach>& sources, const std::vector<Attach>& targets,
+    int directCost, int& bestTarget) const {
+    if (searchStamp.size() < nodes.size()) {
+        searchDist.resize(nodes.size());
+        searchParentEdge.resize(nodes.size());
+        searchStamp.resize(nodes.size(), 0);
+    }
+    ++currentStamp;
+
+    using Entry = std::pair<int, int>;  // (distance, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    auto relax = [&](int node, int dist, int parentEdge) {
+        if (searchStamp[node] == currentStamp && searchDist[node] <= dist) return;
+        searchStamp[node] = currentStamp;
+        searchDist[node] = dist;
+        searchParentEdge[node] = parentEdge;
+        open.push({ dist, node });
+    };
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        relax(sources[i].node, sources[i].cost, -1 - static_cast<int>(i));
+    }
+
+    int best = directCost >= 0 ? directCost : INT_MAX;
+    bestTarget = -1;
+
+    while (!open.empty()) {
+        Entry top = open.top();
+        open.pop();
+
+        int dist = top.first;
+        int node = top.second;
+        if (dist > searchDist[node]) continue;
+        if (dist >= best) break;
+
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (targets[i].node == node && dist + targets[i].cost < best) {
+                best = dist + targets[i].cost;
+                bestTarget = static_cast<int>(i);
+            }
+        }
+
+        for (int d = 0; d < 4; ++d) {
+            int edge = nodes[node].edges[d];
+            if (edge < 0) continue;
+            relax(otherEnd(edges[edge], node, d), dist + edges[edge].length(), edge);
+        }
+    }
+
+    return best == INT_MAX ? -1 : best;
+}
+
+int JunctionGraph::distance(int ax, int ay, int bx, int by) const {
+    std::vector<Attach> sources, targets;
+    if (!getAttachments(ax, ay, sources) || !getAttachments(bx, by, targets)) return -1;
+
+    int a = ay * width + ax;
+    int b = by * width + bx;
+    if (a == b) return 0;
+
+    // Two tiles on the same corridor can also walk straight to each other
+    int direct = -1;
+    if (tileEdge[a] >= 0 && tileEdge[a] == tileEdge[b]) {
+        direct = std::abs(tileOffset[a] - tileOffset[b]);
+    }
+
+    int bestTarget;
+    return search(sources, targets, direct, bestTarget);
+}
+
+void JunctionGraph::appendTile(int tile, std::vector<std::pair<int, int>>& path) const {
+    path.push_back({ tile % width, tile / width });
+}
+
+// Add the tiles of an edge walked starting at fromNode, including the node at the far end
+void JunctionGraph::appendEdge(int edge, int fromNode, std::vector<std::pair<int, int>>& path) const {
+    const Edge& e = edges[edge];
+    if (e.a == fromNode) {
+        for (int tile : e.tiles) appendTile(tile, path);
+        appendTile(nodes[e.b].tile, path);
+    }
+    else {
+        for (auto it = e.tiles.rbegin(); it != e.tiles.rend(); ++it) appendTile(*it, path);
+        appendTile(nodes[e.a].tile, path);
+    }
+}
+
+bool JunctionGraph::findPath(int ax, int ay, int bx, int by, std::vector<std::pair<int, int>>& path) const {
+    path.clear();
+
+    std::vector<Attach> sources, targets;
+    if (!getAttachments(ax, ay, sources) || !getAttachments(bx, by, targets)) return false;
+
+    int a = ay * width + ax;
+    int b = by * width + bx;
+    appendTile(a, path);
+    if (a == b) return true;
+
+    int direct = -1;
+    if (tileEdge[a] >= 0 && tileEdge[a] == tileEdge[b]) {
+        direct = std::abs(tileOffset[a] - tileOffset[b]);
+    }
+
+    int bestTarget;
+    if (search(sources, targets, direct, bestTarget) < 0) {
+        path.clear();
+        return false;
+    }
+
+    // Straight along the shared corridor
+    if (bestTarget < 0) {
+        const Edge& e = edges[tileEdge[a]];
+        int step = tileOffset[b] > tileOffset[a] ? 1 : -1;
+        for (int offset = tileOffset[a] + step; offset != tileOffset[b] + step; offset += step) {
+            appendTile(e.tiles[offset - 1], path);
+        }
+        return true;
+    }
+
+    // Walk the parent edges back from the target node to the source node
+    const Attach& target = targets[bestTarget];
+    std::vector<int> chain;
+    int node = target.node;
+    while (searchParentEdge[node] >= 0) {
+        int edge = searchParentEdge[node];
+        chain.push_back(edge);
+        node = edges[edge].a == node ? edges[edge].b : edges[edge].a;
+    }
+    const Attach& source = sources[-1 - searchParentEdge[node]];
+
+    // From a to the first node
+    if (tileNode[a] < 0) {
+        const Edge& e = edges[tileEdge[a]];
+        if (source.towardA) {
+            for (int offset = tileOffset[a] - 1; offset >= 1; --offset) appendTile(e.tiles[offset - 1], path);
+            appendTile(nodes[e.a].tile, path);
+        }
+        else {
+            for (int offset = tileOffset[a] + 1; offset < e.length(); ++offset) appendTile(e.tiles[offset - 1], path);
+            appendTile(nodes[e.b].tile, path);
+        }
+    }
+
+    // Node to node
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        appendEdge(*it, node, path);
+        node = edges[*it].a == node ? edges[*it].b : edges[*it].a;
+    }
+
+    // From the last node to b
+    if (tileNode[b] < 0) {
+        const Edge& e = edges[tileEdge[b]];
+        if (target.towardA) {
+            for (int offset = 1; offset <= tileOffset[b]; ++offset) appendTile(e.tiles[offset - 1], path);
+        }
+        else {
+            for (int offset = e.length() - 1; offset >= tileOffset[b]; --offset) appendTile(e.tiles[offset - 1], path);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,93 @@
+// JunctionGraph.h
+#pragma once
+#include "BitGrid.h"
+#include <utility>
+#include <vector>
+
+// A compressed version of the maze for fast searching.
+// Corridor tiles (exactly two walkable neighbors) are merged into weighted edges,
+// so only junctions and dead ends are left as nodes. Every tile still knows which
+// node or edge it belongs to, so queries take and return normal tile positions.
+//
+// This pays off where most tiles are corridors, as in generated mazes. In open areas
+// with scattered walls few tiles merge, and a query is slower than a plain BFS over
+// the tiles (see "--bench junction").
+//
+// Queries reuse internal buffers, so one graph must not be queried from several threads at once.
+class JunctionGraph {
+public:
+    // Build the graph for all walkable tiles of `walk`
+    void build(const BitGrid& walk);
+
+    // Update the graph after the tile at (x, y) was changed in `walk`.
+    // Only the corridors around that tile are traced again.
+    void updateTile(const BitGrid& walk, int x, int y);
+
+    // Shortest number of steps between two walkable tiles, or -1 if they aren't connected
+    int distance(int ax, int ay, int bx, int by) const;
+
+    // Shortest path from a to b (both included) as a list of (x, y) tiles.
+    // Returns false if they aren't connected.
+    bool findPath(int ax, int ay, int bx, int by, std::vector<std::pair<int, int>>& path) const;
+
+    int getNodeCount() const { return liveNodes; }
+    int getEdgeCount() const { return liveEdges; }
+
+private:
+    struct Node {
+        int tile = -1;
+        int edges[4] = { -1, -1, -1, -1 };  // Edge leaving in each Direction, or -1
+        bool alive = false;
+    };
+
+    struct Edge {
+        int a = -1, b = -1;             // End nodes
+        int dirA = 0, dirB = 0;         // Direction the edge leaves a and b in
+        std::vector<int> tiles;         // Corridor tiles from a to b (ends not included)
+        bool alive = false;
+
+        int length() const { return static_cast<int>(tiles.size()) + 1; }
+    };
+
+    // How a tile connects to the graph: it is a node, or it sits on an edge
+    // `cost` steps away from one of its ends
+    struct Attach {
+        int node;
+        int cost;
+        bool towardA;   // Reached by walking toward edge end a (only used for tiles on edges)
+    };
+
+    int width = 0;
+    int height = 0;
+    int liveNodes = 0;
+    int liveEdges = 0;
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::vector<int> freeNodes;
+    std::vector<int> freeEdges;
+
+    std::vector<int> tileNode;      // Node at each tile, or -1
+    std::vector<int> tileEdge;      // Edge running through each tile, or -1
+    std::vector<int> tileOffset;    // Position along that edge (1 = first tile after a)
+
+    // Search buffers, reused between queries
+    mutable std::vector<int> searchDist;
+    mutable std::vector<int> searchParentEdge;
+    mutable std::vector<int> searchStamp;
+    mutable int currentStamp = 0;
+
+    bool isJunction(const BitGrid& walk, int x, int y) const;
+    int addNode(int tile);
+    void removeNode(int node);
+    void removeEdge(int edge, std::vector<int>& touchedNodes, std::vector<int>& freedTiles);
+    void traceEdge(const BitGrid& walk, int node, int dir);
+    void traceAllFrom(const BitGrid& walk, int node);
+    int otherEnd(const Edge& edge, int node, int dir) const;
+
+    bool getAttachments(int x, int y, std::vector<Attach>& out) const;
+    int search(const std::vector<Attach>& sources, const std::vector<Attach>& targets,
+        int directCost, int& bestTarget) const;
+    void appendEdge(int edge, int fromNode, std::vector<std::pair<int, int>>& path) const;
+    void appendTile(int tile, std::vector<std::pair<int, int>>& path) const;
+};
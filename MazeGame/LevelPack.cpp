@@ -0,0 +1,282 @@
+// LevelPack.cpp
+#include "LevelPack.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+    const char MAGIC[8] = { 'M', 'A', 'Z', 'E', 'P', 'A', 'C', 'K' };
+    const uint32_t VERSION = 1;
+
+    // Header: magic, version, level count and 8 spare bytes; the directory follows it
+    const size_t HEADER_SIZE = 24;
+    const size_t ENTRY_SIZE = 24;
+
+    // More tiles than this in one level means the directory is damaged
+    const uint64_t MAX_LEVEL_TILES = uint64_t(1) << 30;
+
+    // The byte in front of every run or copy:
+    //   0ttt llll  run of tile t, l + 1 tiles long (1..16)
+    //   10ll llll  copy l + 1 tiles (1..64) from one row up
+    //   11ll llll  copy l + 1 tiles (1..64) from two rows up
+    const uint8_t COPY_ONE_ROW = 0x80;
+    const uint8_t COPY_TWO_ROWS = 0xC0;
+    const size_t MAX_RUN = 16;
+    const size_t MAX_COPY = 64;
+    const uint8_t HIGHEST_TILE = 5;
+
+    // CRC-32 tables for 8 bytes at a time: table k tells what a byte does to the CRC when
+    // k more bytes follow it. Table 0 alone is the usual byte-by-byte table.
+    using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+    CrcTables makeCrcTables() {
+        CrcTables tables;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320u : 0);
+            }
+            tables[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                uint32_t previous = tables[k - 1][i];
+                tables[k][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+            }
+        }
+        return tables;
+    }
+
+    const CrcTables CRC_TABLES = makeCrcTables();
+
+    // How many tiles from `i` on match the tiles `distance` back (at most MAX_COPY)
+    size_t matchLength(const uint8_t* tiles, size_t i, size_t count, size_t distance) {
+        if (distance == 0 || i < distance) return 0;
+        size_t length = 0;
+        while (i + length < count && length < MAX_COPY && tiles[i + length] == tiles[i + length - distance]) {
+            ++length;
+        }
+        return length;
+    }
+
+    template <typename T>
+    void put(std::vector<uint8_t>& out, T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    T get(const uint8_t* bytes) {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+}
+
+uint32_t LevelPack::checksum(const uint8_t* data, size_t size) {
+    const CrcTables& t = CRC_TABLES;
+    uint32_t crc = 0xFFFFFFFFu;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint32_t low = crc ^ get<uint32_t>(data + i);
+        uint32_t high = get<uint32_t>(data + i + 4);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+            t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+    for (; i < size; ++i) {
+        crc = (crc >> 8) ^ t[0][(crc ^ data[i]) & 0xFF];
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void LevelPack::compress(const MazeFile::TileGrid& grid, std::vector<uint8_t>& out) {
+    const uint8_t* tiles = grid.tiles.data();
+    const size_t count = grid.tiles.size();
+    const size_t width = static_cast<size_t>(grid.width);
+
+    // Always take whichever of run, copy from one row up and copy from two rows up goes furthest
+    for (size_t i = 0; i < count; ) {
+        size_t run = 1;
+        while (i + run < count && run < MAX_RUN && tiles[i + run] == tiles[i]) ++run;
+        const size_t oneRow = matchLength(tiles, i, count, width);
+        const size_t twoRows = matchLength(tiles, i, count, width * 2);
+
+        if (oneRow >= run && oneRow >= twoRows) {
+            out.push_back(static_cast<uint8_t>(COPY_ONE_ROW | (oneRow - 1)));
+            i += oneRow;
+        }
+        else if (twoRows > run) {
+            out.push_back(static_cast<uint8_t>(COPY_TWO_ROWS | (twoRows - 1)));
+            i += twoRows;
+        }
+        else {
+            out.push_back(static_cast<uint8_t>((tiles[i] << 4) | (run - 1)));
+            i += run;
+        }
+    }
+}
+
+bool LevelPack::decompress(const uint8_t* data, size_t size, int width, uint8_t* tiles, size_t tileCount) {
+    uint8_t* out = tiles;
+    uint8_t* const end = tiles + tileCount;
+    for (const uint8_t* next = data; next < data + size; ++next) {
+        const uint8_t code = *next;
+        if (code < COPY_ONE_ROW) {
+            const size_t length = (code & 0x0F) + 1u;
+            if (length > static_cast<size_t>(end - out)) return false;
+
+            // Writing the longest run every time is quicker than working out how much to
+            // write; whatever is too much gets overwritten by the next run or copy
+            if (static_cast<size_t>(end - out) >= MAX_RUN) std::memset(out, code >> 4, MAX_RUN);
+            else std::memset(out, code >> 4, length);
+            out += length;
+        }
+        else {
+            const size_t distance = static_cast<size_t>(width) * (code >= COPY_TWO_ROWS ? 2 : 1);
+            const size_t length = (code & 0x3F) + 1u;
+            if (distance > static_cast<size_t>(out - tiles) || length > static_cast<size_t>(end - out)) return false;
+
+            // Same for copies, as long as the copy can't overlap the tiles it is writing
+            if (distance >= MAX_COPY && static_cast<size_t>(end - out) >= MAX_COPY) {
+                std::memcpy(out, out - distance, MAX_COPY);
+                out += length;
+                continue;
+            }
+
+            // Tile by tile: with a narrow maze the copy may overlap the tiles it is writing
+            for (size_t i = 0; i < length; ++i) {
+                out[i] = out[i - distance];
+            }
+            out += length;
+        }
+    }
+    return out == end;
+}
+
+bool LevelPack::open(const std::string& packPath, std::string& error) {
+    static_assert(sizeof(Entry) == ENTRY_SIZE, "entries must have the same layout everywhere");
+    file.close();
+    file.clear();
+    directory.clear();
+    path = packPath;
+
+    file.open(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        error = "can't open " + path;
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    uint8_t header[HEADER_SIZE];
+    if (fileSize < HEADER_SIZE || !file.read(reinterpret_cast<char*>(header), HEADER_SIZE) ||
+        std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        error = path + " is not a level pack";
+        return false;
+    }
+    if (get<uint32_t>(header + 8) != VERSION) {
+        error = path + " was written by a different version of the game";
+        return false;
+    }
+
+    const uint32_t count = get<uint32_t>(header + 12);
+    const uint64_t dataStart = HEADER_SIZE + static_cast<uint64_t>(count) * ENTRY_SIZE;
+    if (count > static_cast<uint32_t>(INT32_MAX) || dataStart > fileSize) {
+        error = path + " is damaged (the directory doesn't fit in the file)";
+        return false;
+    }
+    directory.resize(count);
+    file.read(reinterpret_cast<char*>(directory.data()), static_cast<std::streamsize>(count * ENTRY_SIZE));
+
+    for (const Entry& entry : directory) {
+        if (entry.offset < dataStart || entry.offset > fileSize || entry.size > fileSize - entry.offset ||
+            entry.width <= 0 || entry.height <= 0 ||
+            static_cast<uint64_t>(entry.width) * static_cast<uint64_t>(entry.height) > MAX_LEVEL_TILES) {
+            directory.clear();
+            error = path + " is damaged (the directory doesn't match the file)";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LevelPack::load(int index, MazeFile::TileGrid& grid, std::string& error) {
+    if (index < 0 || index >= getLevelCount()) {
+        error = "there is no level " + std::to_string(index + 1) + " in " + path;
+        return false;
+    }
+    const Entry& entry = directory[index];
+
+    buffer.resize(entry.size);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(entry.offset));
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(entry.size))) {
+        error = "can't read level " + std::to_string(index + 1) + " of " + path;
+        return false;
+    }
+
+    grid.width = entry.width;
+    grid.height = entry.height;
+    grid.tiles.resize(static_cast<size_t>(entry.width) * entry.height);
+    if (!decompress(buffer.data(), buffer.size(), grid.width, grid.tiles.data(), grid.tiles.size()) ||
+        checksum(grid.tiles.data(), grid.tiles.size()) != entry.checksum) {
+        error = "level " + std::to_string(index + 1) + " of " + path + " is damaged (wrong checksum)";
+        return false;
+    }
+    return true;
+}
+
+uint64_t LevelPack::getCompressedBytes() const {
+    uint64_t bytes = 0;
+    for (const Entry& entry : directory) {
+        bytes += entry.size;
+    }
+    return bytes;
+}
+
+bool LevelPack::write(const std::string& packPath, const std::vector<MazeFile::TileGrid>& levels, std::string& error) {
+    // Compress everything first, so the directory can be written before the data
+    std::vector<uint8_t> data;
+    std::vector<Entry> entries;
+    const uint64_t dataStart = HEADER_SIZE + static_cast<uint64_t>(levels.size()) * ENTRY_SIZE;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const MazeFile::TileGrid& level = levels[i];
+        if (level.width <= 0 || level.height <= 0 ||
+            level.tiles.size() != static_cast<size_t>(level.width) * level.height ||
+            std::any_of(level.tiles.begin(), level.tiles.end(), [](uint8_t tile) { return tile > HIGHEST_TILE; })) {
+            error = "level " + std::to_string(i + 1) + " isn't a valid maze";
+            return false;
+        }
+
+        Entry entry;
+        entry.offset = dataStart + data.size();
+        entry.width = level.width;
+        entry.height = level.height;
+        entry.checksum = checksum(level.tiles.data(), level.tiles.size());
+        compress(level, data);
+        entry.size = static_cast<uint32_t>(dataStart + data.size() - entry.offset);
+        entries.push_back(entry);
+    }
+
+    std::vector<uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+    put<uint32_t>(header, VERSION);
+    put<uint32_t>(header, static_cast<uint32_t>(levels.size()));
+    put<uint64_t>(header, 0);
+
+    std::ofstream out(packPath, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * ENTRY_SIZE));
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!out) {
+        error = "can't write " + packPath;
+        return false;
+    }
+    return true;
+}
+
+bool LevelPack::isPackFile(const std::string& packPath) {
+    std::ifstream in(packPath, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
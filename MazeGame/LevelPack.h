@@ -0,0 +1,70 @@
+// LevelPack.h
+#pragma once
+#include "MazeFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Many levels in one file, each compressed on its own so any of them can be loaded
+// without touching the others.
+//
+// What is in the file (all numbers little-endian):
+//   - a 24-byte header: "MAZEPACK", version, number of levels
+//   - the directory: 24 bytes per level with where its data starts, how long it is, its
+//     size in tiles and a checksum. Entries have a fixed size, so the entry of level n is
+//     found by multiplying instead of searching.
+//   - the compressed levels, one after another
+//
+// Levels are compressed with runs and copies, a small LZ-style scheme made for mazes: a
+// run is one tile repeated (a long wall), a copy repeats the tiles one or two rows up
+// (corridors and walls that continue downwards). One byte says which and how many, so a
+// level decompresses straight into its tile buffer with simple loops.
+//
+// The checksum (CRC-32) is worked out from the decompressed tiles, so a damaged file is
+// noticed when the level is loaded instead of playing a broken maze.
+//
+// A LevelPack keeps its file open; use one from one thread at a time.
+class LevelPack {
+public:
+    // Open a pack and read its directory. On failure returns false and explains why in `error`.
+    bool open(const std::string& path, std::string& error);
+
+    int getLevelCount() const { return static_cast<int>(directory.size()); }
+
+    // Load level `index` (0 = first) into `grid`; its buffer is reused when it is big enough.
+    // On failure returns false and explains why in `error`.
+    bool load(int index, MazeFile::TileGrid& grid, std::string& error);
+
+    // Bytes the levels take up in the file, without header and directory
+    uint64_t getCompressedBytes() const;
+
+    // Write `levels` as a pack; returns false and explains why in `error` on failure
+    static bool write(const std::string& path, const std::vector<MazeFile::TileGrid>& levels, std::string& error);
+
+    // True if the file starts like a pack written by write()
+    static bool isPackFile(const std::string& path);
+
+    // The compression on its own: append a compressed level to `out`, and turn compressed
+    // bytes back into exactly `tileCount` tiles (false if they don't fit together)
+    static void compress(const MazeFile::TileGrid& grid, std::vector<uint8_t>& out);
+    static bool decompress(const uint8_t* data, size_t size, int width, uint8_t* tiles, size_t tileCount);
+
+    // CRC-32 as used by zip files
+    static uint32_t checksum(const uint8_t* data, size_t size);
+
+private:
+    struct Entry {
+        uint64_t offset;
+        uint32_t size;
+        int32_t width;
+        int32_t height;
+        uint32_t checksum;
+    };
+
+    std::ifstream file;
+    std::string path;
+    std::vector<Entry> directory;
+    std::vector<uint8_t> buffer;    // Compressed bytes of the level being loaded
+};
@@ -0,0 +1,262 @@
+// LevelProgression.cpp
+#include "LevelProgression.h"
+#include "BitGrid.h"
+#include "ComponentLabels.h"
+#include "Game.h"
+#include "GameConfig.h"
+#include "GameSession.h"
+#include "Maze.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+
+// The progression of one game
+struct LevelProgression::SessionState {
+    bool active = false;
+    MazeGenerator::Algorithm algorithm = MazeGenerator::Algorithm::BACKTRACKER;
+    uint32_t firstSeed = 0;
+    int levelNumber = 1;
+
+    // Levels come from this pack instead of the generator when it is set
+    std::shared_ptr<LevelPack> pack;
+
+    // The level being played: its pre-drawn tiles, and the maze revision they show
+    SDL_Texture* currentTexture = nullptr;
+    int currentRevision = -1;
+
+    // The next level: still being made, or made and waiting
+    std::future<LevelProgression::PreparedLevel> pending;
+    LevelProgression::PreparedLevel next;
+    bool nextReady = false;
+    SDL_Texture* nextTexture = nullptr;
+};
+
+namespace {
+    // Tile values of main.cpp's layout
+    const int PATH = 1;
+    const int ITEM = 2;
+    const int PLAYER = 3;
+    const int GOAL = 4;
+
+    // Mazes tried for one level before taking the last one anyway
+    const int MAX_ATTEMPTS = 16;
+
+    // Pack levels that can't be loaded or won are replaced by a maze of this kind
+    const MazeGenerator::Algorithm FALLBACK_ALGORITHM = MazeGenerator::Algorithm::BACKTRACKER;
+
+    // Can the player get to the goal and every item?
+    bool isPlayable(const std::vector<std::vector<int>>& layout) {
+        const int height = static_cast<int>(layout.size());
+        const int width = height > 0 ? static_cast<int>(layout[0].size()) : 0;
+        BitGrid walk(width, height);
+        int playerX = -1, playerY = -1;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                walk.set(x, y, layout[y][x] != 0);
+                if (layout[y][x] == PLAYER) {
+                    playerX = x;
+                    playerY = y;
+                }
+            }
+        }
+        if (playerX < 0) return false;
+
+        ComponentLabels areas;
+        areas.build(walk);
+        int playerArea = areas.componentAt(playerX, playerY);
+        bool hasGoal = false;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int tile = layout[y][x];
+                if (tile != GOAL && tile != ITEM) continue;
+                if (areas.componentAt(x, y) != playerArea) return false;
+                hasGoal = hasGoal || tile == GOAL;
+            }
+        }
+        return hasGoal;
+    }
+
+    // The maze tiles as Maze::render draws them, without the UI area above
+    SDL_Surface* drawBackground(const std::vector<std::vector<int>>& layout) {
+        const int tile = GameConfig::TILE_SIZE;
+        SDL_Surface* surface = SDL_CreateSurface(GameConfig::MAZE_WIDTH * tile, GameConfig::MAZE_HEIGHT * tile,
+            SDL_PIXELFORMAT_RGBA32);
+        if (!surface) return nullptr;
+
+        const SDL_Color wall = GameConfig::COLOR_WALL;
+        const SDL_Color path = GameConfig::COLOR_PATH;
+        Uint32 wallColor = SDL_MapSurfaceRGBA(surface, wall.r, wall.g, wall.b, wall.a);
+        Uint32 pathColor = SDL_MapSurfaceRGBA(surface, path.r, path.g, path.b, path.a);
+        for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+            for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
+                SDL_Rect rect = { x * tile, y * tile, tile, tile };
+                SDL_FillSurfaceRect(surface, &rect, layout[y][x] != 0 ? pathColor : wallColor);
+            }
+        }
+        return surface;
+    }
+
+    LevelProgression::SessionState& state() {
+        return *GameSession::current().progression;
+    }
+
+    void requestLevel(LevelProgression::SessionState& s, int number) {
+        s.nextReady = false;
+        if (s.pack) {
+            if (number > s.pack->getLevelCount()) return;  // That was the last one
+            s.pending = std::async(std::launch::async, [levels = s.pack, number] {
+                return LevelProgression::prepare(*levels, number);
+            });
+            return;
+        }
+        s.pending = std::async(std::launch::async, [levelAlgorithm = s.algorithm, seed = s.firstSeed, number] {
+            return LevelProgression::prepare(levelAlgorithm, seed, number);
+        });
+    }
+
+    // Take the finished level from the background thread; waits if it isn't finished
+    void takeNext(LevelProgression::SessionState& s) {
+        s.next = s.pending.get();
+        s.nextReady = true;
+
+        // Textures belong to the renderer, so only this thread may make them
+        if (s.next.background) {
+            s.nextTexture = SDL_CreateTextureFromSurface(Game::getRenderer(), s.next.background);
+            SDL_DestroySurface(s.next.background);
+            s.next.background = nullptr;
+        }
+    }
+
+    void showLevelNumber(const LevelProgression::SessionState& s) {
+        std::string title = "Maze Game - Level " + std::to_string(s.levelNumber);
+        if (s.pack) title += " of " + std::to_string(s.pack->getLevelCount());
+        SDL_SetWindowTitle(Game::getWindow(), title.c_str());
+    }
+}
+
+std::shared_ptr<LevelProgression::SessionState> LevelProgression::createSessionState() {
+    return std::make_shared<SessionState>();
+}
+
+LevelProgression::PreparedLevel LevelProgression::prepare(MazeGenerator::Algorithm algorithm, uint32_t seed, int number) {
+    PreparedLevel level;
+    level.number = number;
+
+    // A generated maze always passes, but a bad seed shouldn't ever end the game
+    uint32_t levelSeed = seed + static_cast<uint32_t>(number - 1);
+    do {
+        level.layout = MazeGenerator::generate(algorithm, GameConfig::MAZE_WIDTH, GameConfig::MAZE_HEIGHT, levelSeed);
+        levelSeed += 0x9E3779B9u;
+        ++level.attempts;
+    } while (!isPlayable(level.layout) && level.attempts < MAX_ATTEMPTS);
+
+    level.background = drawBackground(level.layout);
+    return level;
+}
+
+LevelProgression::PreparedLevel LevelProgression::prepare(LevelPack& levels, int number) {
+    PreparedLevel level;
+    level.number = number;
+    level.attempts = 1;
+
+    MazeFile::TileGrid grid;
+    std::string error;
+    if (!levels.load(number - 1, grid, error) || !MazeFile::toLayout(grid, level.layout, error)) {
+        SDL_Log("Can't play level %d: %s; playing a generated maze instead", number, error.c_str());
+        return prepare(FALLBACK_ALGORITHM, static_cast<uint32_t>(number), number);
+    }
+
+    // Same check as a generated maze gets, so a broken level can't end the game
+    if (!isPlayable(level.layout)) {
+        SDL_Log("Can't play level %d: the goal or an item can't be reached; playing a generated maze instead", number);
+        return prepare(FALLBACK_ALGORITHM, static_cast<uint32_t>(number), number);
+    }
+    level.background = drawBackground(level.layout);
+    return level;
+}
+
+void LevelProgression::start(MazeGenerator::Algorithm levelAlgorithm, uint32_t seed) {
+    SessionState& s = state();
+    s.active = true;
+    s.algorithm = levelAlgorithm;
+    s.firstSeed = seed;
+    s.pack.reset();
+    s.levelNumber = 1;
+    showLevelNumber(s);
+    requestLevel(s, s.levelNumber + 1);
+}
+
+void LevelProgression::startPack(std::shared_ptr<LevelPack> levels, int firstLevel) {
+    SessionState& s = state();
+    s.active = true;
+    s.pack = std::move(levels);
+    s.levelNumber = firstLevel;
+    showLevelNumber(s);
+    requestLevel(s, s.levelNumber + 1);
+}
+
+bool LevelProgression::isActive() {
+    return state().active;
+}
+
+int LevelProgression::getLevelNumber() {
+    return state().levelNumber;
+}
+
+void LevelProgression::update() {
+    SessionState& s = state();
+    if (!s.active || s.nextReady) return;
+    if (s.pending.valid() && s.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        takeNext(s);
+    }
+}
+
+void LevelProgression::advance() {
+    SessionState& s = state();
+    if (!s.active) return;
+    if (!s.nextReady) {
+        if (!s.pending.valid()) return;
+        takeNext(s);
+    }
+    if (s.next.layout.empty()) return;
+
+    GameSession::current().startNextLevel(s.next.layout);
+    s.levelNumber = s.next.number;
+
+    if (s.currentTexture) SDL_DestroyTexture(s.currentTexture);
+    s.currentTexture = s.nextTexture;
+    s.nextTexture = nullptr;
+    s.currentRevision = Maze::getRevision();
+    showLevelNumber(s);
+
+    requestLevel(s, s.levelNumber + 1);
+}
+
+bool LevelProgression::renderBackground() {
+    const SessionState& s = state();
+    if (!s.active || !s.currentTexture || s.currentRevision != Maze::getRevision()) return false;
+
+    SDL_FRect rect = {
+        0.0f, static_cast<float>(GameConfig::UI_OFFSET_Y),
+        static_cast<float>(GameConfig::MAZE_WIDTH * GameConfig::TILE_SIZE),
+        static_cast<float>(GameConfig::MAZE_HEIGHT * GameConfig::TILE_SIZE)
+    };
+    return SDL_RenderTexture(Game::getRenderer(), s.currentTexture, nullptr, &rect);
+}
+
+void LevelProgression::shutdown() {
+    SessionState& s = state();
+    if (s.pending.valid()) {
+        PreparedLevel unused = s.pending.get();
+        if (unused.background) SDL_DestroySurface(unused.background);
+    }
+    if (s.currentTexture) SDL_DestroyTexture(s.currentTexture);
+    if (s.nextTexture) SDL_DestroyTexture(s.nextTexture);
+    s.currentTexture = nullptr;
+    s.nextTexture = nullptr;
+    s.pack.reset();
+    s.active = false;
+}
@@ -0,0 +1,64 @@
+// LevelProgression.h
+#pragma once
+#include "LevelPack.h"
+#include "MazeGenerator.h"
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Level after level of generated mazes (or the levels of a LevelPack) instead of
+// restarting the same one.
+//
+// While a level is played, the next one is generated, checked (goal and items reachable)
+// and its maze tiles drawn into an image on a background thread. The image is turned into
+// a texture on a normal frame soon after, so reaching the goal only has to load the
+// layout and swap the texture, which takes far less than one frame.
+namespace LevelProgression {
+    // Everything the background thread gets ready for one level
+    struct PreparedLevel {
+        int number = 0;
+        std::vector<std::vector<int>> layout;
+        SDL_Surface* background = nullptr;  // The maze tiles, drawn like Maze::render
+        int attempts = 0;                   // Mazes generated until one passed the check
+    };
+
+    // Turn progression on. Level 1 is the maze made with `algorithm` from `seed`, which
+    // main.cpp has already loaded; level n uses seed + n - 1.
+    void start(MazeGenerator::Algorithm algorithm, uint32_t seed);
+
+    // Turn progression on with the levels of a pack. Level `firstLevel` (1 = first) is the
+    // one main.cpp has already loaded. After the last level the game is won as usual.
+    void startPack(std::shared_ptr<LevelPack> pack, int firstLevel);
+
+    bool isActive();
+
+    // Number of the level being played (1 = first)
+    int getLevelNumber();
+
+    // Call once per frame: turns a finished background image into a texture
+    void update();
+
+    // Go on to the next level, keeping score and lives. Only waits if the background
+    // thread isn't finished yet. Does nothing when there is no next level.
+    void advance();
+
+    // Draw the current level's pre-drawn maze tiles. Returns false if there are none (the
+    // first level, or tiles were changed since), so Maze::render has to draw them.
+    bool renderBackground();
+
+    // Stop the background thread and free the textures
+    void shutdown();
+
+    // Generate, check and draw level `number` (what the background thread does).
+    // The caller owns the returned surface.
+    PreparedLevel prepare(MazeGenerator::Algorithm algorithm, uint32_t seed, int number);
+
+    // Load, check and draw level `number` of a pack. A level that can't be loaded, or whose
+    // goal or items the player can't get to, is replaced by a generated maze (the reason is logged).
+    PreparedLevel prepare(LevelPack& pack, int number);
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
+}
@@ -0,0 +1,308 @@
+// MappedMaze.cpp
+#include "MappedMaze.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[8] = { 'M', 'A', 'Z', 'E', 'B', 'I', 'N', '1' };
+    const uint32_t VERSION = 2;
+
+    // The walls start on a page boundary, so a block never shares a page with the header
+    const uint64_t GRID_OFFSET = 4096;
+
+    const uint8_t WALL = 0;
+    const uint8_t PATH = 1;
+    const uint8_t ITEM = 2;
+    const uint8_t PLAYER = 3;
+    const uint8_t GOAL = 4;
+    const uint8_t ENEMY = 5;
+
+    // The first 72 bytes of the file, exactly as they are stored
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t blockSize;
+        int32_t width, height;
+        int32_t playerX, playerY;
+        int32_t goalX, goalY;
+        uint64_t gridOffset;
+        uint64_t entityOffset;
+        uint64_t entityCount;
+        uint64_t layoutHash;    // hashLayout() of the walls (see BitGrid.h)
+    };
+    static_assert(sizeof(Header) == 72, "the header must have the same layout everywhere");
+    static_assert(sizeof(MappedMaze::Entity) == 12, "entities must have the same layout everywhere");
+
+    uint64_t blockCount(int tiles) {
+        return (static_cast<uint64_t>(tiles) + MappedMaze::BLOCK_SIZE - 1) / MappedMaze::BLOCK_SIZE;
+    }
+
+    // Map the whole file copy-on-write; null on failure
+    void* mapFile(const std::string& path, size_t& size, std::string& error) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            error = "can't open " + path;
+            return nullptr;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+            static_cast<unsigned long long>(fileSize.QuadPart) > std::numeric_limits<size_t>::max()) {
+            CloseHandle(file);
+            error = path + " is empty or too big for this build";
+            return nullptr;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+
+        // The view keeps the file mapped after the handles are closed
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        if (!view) {
+            error = "can't map " + path;
+            return nullptr;
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+        return view;
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            error = "can't open " + path;
+            return nullptr;
+        }
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size <= 0 ||
+            static_cast<unsigned long long>(info.st_size) > std::numeric_limits<size_t>::max()) {
+            ::close(file);
+            error = path + " is empty or too big for this build";
+            return nullptr;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+
+        // The mapping stays after the file is closed
+        ::close(file);
+        if (view == MAP_FAILED) {
+            error = "can't map " + path;
+            return nullptr;
+        }
+        size = static_cast<size_t>(info.st_size);
+        return view;
+#endif
+    }
+
+    void unmapFile(void* view, size_t size) {
+#ifdef _WIN32
+        (void)size;
+        UnmapViewOfFile(view);
+#else
+        munmap(view, size);
+#endif
+    }
+
+    bool entityBefore(const MappedMaze::Entity& a, const MappedMaze::Entity& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    }
+}
+
+MappedMaze::~MappedMaze() {
+    close();
+}
+
+bool MappedMaze::open(const std::string& path, std::string& error) {
+    close();
+    size_t size = 0;
+    void* view = mapFile(path, size, error);
+    if (!view) return false;
+
+    // Only the header is read now; everything else is read when it is first touched
+    Header header;
+    bool valid = size >= sizeof(Header);
+    if (valid) {
+        std::memcpy(&header, view, sizeof(Header));
+        valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+    if (!valid) {
+        unmapFile(view, size);
+        error = path + " is not a maze file";
+        return false;
+    }
+    if (header.version != VERSION || header.blockSize != BLOCK_SIZE) {
+        unmapFile(view, size);
+        error = path + " was written by a different version of the game";
+        return false;
+    }
+
+    // Make sure every part the header points to is really in the file
+    const uint64_t gridBytes = blockCount(header.width) * blockCount(header.height) * BLOCK_SIZE * sizeof(uint64_t);
+    const uint64_t maxEntities = (std::numeric_limits<uint64_t>::max() - header.entityOffset) / sizeof(Entity);
+    if (header.width <= 0 || header.height <= 0 || header.gridOffset % sizeof(uint64_t) != 0 ||
+        header.gridOffset > size || gridBytes > size - header.gridOffset ||
+        header.entityOffset % alignof(Entity) != 0 || header.entityCount > maxEntities ||
+        header.entityOffset + header.entityCount * sizeof(Entity) > size) {
+        unmapFile(view, size);
+        error = path + " is damaged (the header doesn't match the file size)";
+        return false;
+    }
+
+    mapped = view;
+    mappedSize = size;
+    width = header.width;
+    height = header.height;
+    playerX = header.playerX;
+    playerY = header.playerY;
+    goalX = header.goalX;
+    goalY = header.goalY;
+    layoutHash = header.layoutHash;
+    blocksX = static_cast<size_t>(blockCount(width));
+    grid = reinterpret_cast<uint64_t*>(static_cast<char*>(view) + header.gridOffset);
+    entities = reinterpret_cast<const Entity*>(static_cast<char*>(view) + header.entityOffset);
+    entityCount = static_cast<size_t>(header.entityCount);
+    return true;
+}
+
+void MappedMaze::close() {
+    if (mapped) unmapFile(mapped, mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+    width = height = 0;
+    playerX = playerY = goalX = goalY = -1;
+    layoutHash = 0;
+    blocksX = 0;
+    grid = nullptr;
+    entities = nullptr;
+    entityCount = 0;
+}
+
+void MappedMaze::setWalkable(int64_t x, int64_t y, bool walkable) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    uint64_t* block = grid + (static_cast<size_t>(y >> BLOCK_SHIFT) * blocksX + static_cast<size_t>(x >> BLOCK_SHIFT)) * BLOCK_SIZE;
+    const uint64_t bit = uint64_t(1) << (x & BLOCK_MASK);
+    if (walkable) block[y & BLOCK_MASK] |= bit;
+    else block[y & BLOCK_MASK] &= ~bit;
+}
+
+void MappedMaze::copyWalls(BitGrid& walk) const {
+    walk = BitGrid(width, height);
+
+    // A block row is laid out like a BitGrid word: bit x is tile x of those 64 tiles
+    const size_t wordsPerRow = static_cast<size_t>(width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const int spare = static_cast<int>(wordsPerRow * BLOCK_SIZE) - width;
+    const uint64_t lastWordMask = ~uint64_t(0) >> spare;
+    for (int y = 0; y < height; ++y) {
+        uint64_t* row = walk.row(y);
+        const uint64_t* blockRow = grid + static_cast<size_t>(y >> BLOCK_SHIFT) * blocksX * BLOCK_SIZE + (y & BLOCK_MASK);
+        for (size_t word = 0; word < wordsPerRow; ++word) {
+            row[word] = blockRow[word * BLOCK_SIZE];
+        }
+        row[wordsPerRow - 1] &= lastWordMask;
+    }
+}
+
+const MappedMaze::Entity* MappedMaze::getEntities(int y, int fromX, int toX, size_t& count) const {
+    const Entity* end = entities + entityCount;
+    const Entity* first = std::lower_bound(entities, end, Entity{ fromX, y, 0 }, entityBefore);
+    const Entity* last = std::lower_bound(first, end, Entity{ toX, y, 0 }, entityBefore);
+    count = static_cast<size_t>(last - first);
+    return first;
+}
+
+bool MappedMaze::write(const std::string& path, const MazeFile::TileGrid& grid, std::string& error) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        error = "can't write " + path;
+        return false;
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.blockSize = BLOCK_SIZE;
+    header.width = grid.width;
+    header.height = grid.height;
+    header.playerX = header.playerY = header.goalX = header.goalY = -1;
+    header.gridOffset = GRID_OFFSET;
+
+    // The header is written last, once the player, goal and entity count are known
+    std::vector<char> padding(static_cast<size_t>(GRID_OFFSET), 0);
+    out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+    // One row of blocks at a time, so only 64 rows of the maze are in memory as bits
+    const size_t blocksX = static_cast<size_t>(blockCount(grid.width));
+    std::vector<uint64_t> band(blocksX * BLOCK_SIZE);
+    std::vector<Entity> found;
+    LayoutHash hash(grid.width, grid.height);
+    for (int top = 0; top < grid.height; top += BLOCK_SIZE) {
+        std::fill(band.begin(), band.end(), 0);
+        const int bottom = std::min(grid.height, top + BLOCK_SIZE);
+        for (int y = top; y < bottom; ++y) {
+            const uint8_t* row = &grid.tiles[static_cast<size_t>(y) * grid.width];
+            for (int left = 0; left < grid.width; left += BLOCK_SIZE) {
+                // 64 tiles into one word; most of them are plain walls and paths
+                const int count = std::min(BLOCK_SIZE, grid.width - left);
+                uint64_t bits = 0;
+                bool hasObjects = false;
+                for (int i = 0; i < count; ++i) {
+                    bits |= uint64_t(row[left + i] != WALL) << i;
+                    hasObjects |= row[left + i] > PATH;
+                }
+                band[(left >> BLOCK_SHIFT) * BLOCK_SIZE + (y - top)] = bits;
+                if (!hasObjects) continue;
+
+                for (int x = left; x < left + count; ++x) {
+                    const uint8_t tile = row[x];
+                    if (tile == ITEM || tile == ENEMY) {
+                        found.push_back(Entity{ x, y, tile });
+                    }
+                    else if (tile == PLAYER && header.playerX < 0) {
+                        header.playerX = x;
+                        header.playerY = y;
+                    }
+                    else if (tile == GOAL && header.goalX < 0) {
+                        header.goalX = x;
+                        header.goalY = y;
+                    }
+                }
+            }
+
+            // The finished row, word by word, like a BitGrid row
+            for (size_t block = 0; block < blocksX; ++block) hash.mix(band[block * BLOCK_SIZE + (y - top)]);
+        }
+        out.write(reinterpret_cast<const char*>(band.data()), static_cast<std::streamsize>(band.size() * sizeof(uint64_t)));
+    }
+
+    // Found row by row, left to right, so the table is already sorted
+    header.entityOffset = GRID_OFFSET + blockCount(grid.width) * blockCount(grid.height) * BLOCK_SIZE * sizeof(uint64_t);
+    header.entityCount = found.size();
+    header.layoutHash = hash.value;
+    out.write(reinterpret_cast<const char*>(found.data()), static_cast<std::streamsize>(found.size() * sizeof(Entity)));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out) {
+        error = "can't write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool MappedMaze::isMazeFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
@@ -0,0 +1,100 @@
+// MappedMaze.h
+#pragma once
+#include "BitGrid.h"
+#include "MazeFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A huge maze in a binary file that is used right where it lies instead of being loaded.
+//
+// The file is memory-mapped: the operating system makes it look like one big array, and
+// only reads a piece of it from the disk the first time that piece is touched. Opening a
+// 1 GB maze is therefore instant, and only the parts the player actually sees are ever
+// read. isWalkable looks straight into the mapped file, so the maze is never copied.
+//
+// What is in the file (all numbers little-endian):
+//   - a 72-byte header: "MAZEBIN1", version, size, player start, goal and a hash of the
+//     walls (so a sidecar made for the maze can be checked without reading the walls)
+//   - the walls as bits (1 = walkable), in blocks of 64 x 64 tiles, one 64-bit word per
+//     block row; blocks go left to right, then top to bottom. A block is 512 bytes, so the
+//     tiles around the player sit in a few neighboring blocks instead of being spread over
+//     thousands of long rows.
+//   - a table of the items and enemies, sorted by row and then column
+//
+// Changing a tile changes the mapped memory only ("copy on write"); the file stays as it is.
+// Text mazes (MazeFile) are turned into this format with write() or "MazeGame --convert".
+class MappedMaze {
+public:
+    static constexpr int BLOCK_SIZE = 64;
+
+    // An item or enemy from the file, with the tile code from main.cpp (2 or 5)
+    struct Entity {
+        int32_t x;
+        int32_t y;
+        int32_t tile;
+    };
+
+    MappedMaze() = default;
+    ~MappedMaze();
+
+    MappedMaze(const MappedMaze&) = delete;
+    MappedMaze& operator=(const MappedMaze&) = delete;
+
+    // Map a maze file. On failure returns false and explains why in `error`.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // -1 when the file has none
+    int getPlayerX() const { return playerX; }
+    int getPlayerY() const { return playerY; }
+    int getGoalX() const { return goalX; }
+    int getGoalY() const { return goalY; }
+
+    // hashLayout() of the walls as they were written (see BitGrid.h); edits don't change it
+    uint64_t getLayoutHash() const { return layoutHash; }
+
+    // Tile (x, y); everything outside the maze is wall
+    bool isWalkable(int64_t x, int64_t y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) return false;
+        const uint64_t* block = grid + (static_cast<size_t>(y >> BLOCK_SHIFT) * blocksX + static_cast<size_t>(x >> BLOCK_SHIFT)) * BLOCK_SIZE;
+        return (block[y & BLOCK_MASK] >> (x & BLOCK_MASK)) & 1;
+    }
+
+    // Change a tile in memory (not in the file)
+    void setWalkable(int64_t x, int64_t y, bool walkable);
+
+    // Copy the whole maze into `walk` (1 = walkable), for algorithms that need all of it at
+    // once. This reads every block of the file.
+    void copyWalls(BitGrid& walk) const;
+
+    // The items and enemies on row y with fromX <= x < toX: returns the first one and
+    // puts how many there are in `count`
+    const Entity* getEntities(int y, int fromX, int toX, size_t& count) const;
+    size_t getEntityCount() const { return entityCount; }
+
+    // Write `grid` as a maze file; returns false and explains why in `error` on failure
+    static bool write(const std::string& path, const MazeFile::TileGrid& grid, std::string& error);
+
+    // True if the file starts like a maze file written by write()
+    static bool isMazeFile(const std::string& path);
+
+private:
+    static constexpr int BLOCK_SHIFT = 6;
+    static constexpr int BLOCK_MASK = BLOCK_SIZE - 1;
+
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+
+    int width = 0, height = 0;
+    int playerX = -1, playerY = -1;
+    int goalX = -1, goalY = -1;
+    uint64_t layoutHash = 0;
+    size_t blocksX = 0;
+    uint64_t* grid = nullptr;
+    const Entity* entities = nullptr;
+    size_t entityCount = 0;
+};
@@ -1,14 +1,26 @@
 // Maze.cpp
 #include "Maze.h"
+#include "ChunkWorld.h"
+#include "ComponentLabels.h"
+#include "ContractionHierarchy.h"
+#include "EllerGenerator.h"
 #include "GameConfig.h"
+#include "JunctionGraph.h"
+#include "MappedMaze.h"
 #include "Renderer.h"
 
 #include "Player.h"
 #include "Goal.h"
 #include "Item.h"
 #include "Enemy.h"
+#include "GameSession.h"
 
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
 #include "Game.h"
 
 // This file handles the maze grid and initial placement of everything
@@ -22,63 +34,486 @@ enum TileType {
     ENEMY_INT = 5
 };
 
-namespace {
-    int maze[GameConfig::MAZE_HEIGHT][GameConfig::MAZE_WIDTH];
+// Everything the maze keeps for one game
+struct Maze::SessionState {
+    int maze[GameConfig::MAZE_HEIGHT][GameConfig::MAZE_WIDTH] = {};
     std::vector<std::vector<int>> originalLayout;
+    int revision = 0;
+    BitGrid walkGrid{ GameConfig::MAZE_WIDTH, GameConfig::MAZE_HEIGHT };
+
+    // Connected areas of the view and the one the player is in, as of areasRevision.
+    // Wall edits only move the revision on; isReachable labels the areas again when asked.
+    ComponentLabels areas;
+    int playerArea = -1;
+    int areasRevision = -1;
+    Maze::LayoutCheck layoutCheck;
+
+    // Endless mode: where the rows come from and which one is at the top of the screen.
+    // Rows that scroll away are forgotten; the generator can make any of them again.
+    std::unique_ptr<EllerGenerator> endless;
+    uint32_t endlessSeed = 0;
+    int64_t topRow = 0;
+
+    // Open world: the chunks the tiles come from (`maze` isn't used then), and the world
+    // tile shown in the top-left corner of the view
+    std::unique_ptr<ChunkWorld> world;
+    uint32_t worldSeed = 0;
+    int64_t originX = 0, originY = 0;
+
+    // Mapped maze: the file the tiles are looked up in instead of the chunks. It scrolls
+    // through the same view as the open world (originX, originY).
+    std::unique_ptr<MappedMaze> mapped;
+    std::string mappedPath;
+
+    // Junctions and corridors of the view, for walking distances; built again when the
+    // revision moves on without setWalkable (a new layout, a scroll)
+    JunctionGraph junctions;
+    int junctionsRevision = -1;
+
+    // The mapped maze's contraction hierarchy, if a sidecar for it was found. Dropped as soon
+    // as a wall is edited, because it only fits the walls it was made for.
+    std::unique_ptr<ContractionHierarchy> hierarchy;
+};
+
+namespace {
+    Maze::SessionState& state() {
+        return *GameSession::current().maze;
+    }
+
+    // Tile (x, y) of the open world or the mapped maze
+    bool isWorldWalkable(Maze::SessionState& s, int64_t x, int64_t y) {
+        if (s.mapped) return s.mapped->isWalkable(x, y);
+        return s.world->isWalkable(x, y);
+    }
+
+    // Copy the part of the world the view shows into the walk grid
+    void copyWorldView(Maze::SessionState& s) {
+        for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+            for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
+                s.walkGrid.set(x, y, isWorldWalkable(s, s.originX + x, s.originY + y));
+            }
+        }
+    }
+
+    // Mapped maze: put the goal and the file's items and enemies on the view. Only tiles
+    // that weren't shown before (when the view's corner was at oldX, oldY) get new ones.
+    void placeMappedObjects(Maze::SessionState& s, int64_t oldX, int64_t oldY) {
+        const MappedMaze& mapped = *s.mapped;
+        const int64_t goalX = mapped.getGoalX() - s.originX;
+        const int64_t goalY = mapped.getGoalY() - s.originY;
+        if (mapped.getGoalX() >= 0 && goalX >= 0 && goalX < GameConfig::MAZE_WIDTH &&
+            goalY >= 0 && goalY < GameConfig::MAZE_HEIGHT) {
+            Goal::setPosition(static_cast<int>(goalX), static_cast<int>(goalY));
+        }
+        else {
+            Goal::setPosition(-1, -1);
+        }
+
+        for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+            const int64_t worldY = s.originY + y;
+            if (worldY < 0 || worldY >= mapped.getHeight()) continue;
+            const int64_t fromX = std::max<int64_t>(s.originX, 0);
+            const int64_t toX = std::min<int64_t>(s.originX + GameConfig::MAZE_WIDTH, mapped.getWidth());
+            if (fromX >= toX) continue;
+
+            size_t count = 0;
+            const MappedMaze::Entity* entity = mapped.getEntities(static_cast<int>(worldY),
+                static_cast<int>(fromX), static_cast<int>(toX), count);
+            for (; count > 0; --count, ++entity) {
+                const bool shownBefore = entity->x >= oldX && entity->x < oldX + GameConfig::MAZE_WIDTH &&
+                    entity->y >= oldY && entity->y < oldY + GameConfig::MAZE_HEIGHT;
+                if (shownBefore) continue;
+                const int x = static_cast<int>(entity->x - s.originX);
+                if (entity->tile == ENEMY_INT) Enemy::add(x, y);
+                else Item::add(x, y);
+            }
+        }
+    }
+
+    // Label the connected areas of the view and find the one the player is in
+    void labelAreas(Maze::SessionState& s) {
+        s.areas.build(s.walkGrid);
+        s.playerArea = s.areas.componentAt(Player::getX(), Player::getY());
+        s.areasRevision = s.revision;
+    }
+
+    // Label the areas and report goals, items and enemies the player can never get to
+    void checkLayout(int goalX, int goalY, const std::vector<std::pair<int, int>>& items,
+        const std::vector<std::pair<int, int>>& enemies) {
+        Maze::SessionState& s = state();
+        ComponentLabels& areas = s.areas;
+        int& playerArea = s.playerArea;
+        Maze::LayoutCheck& layoutCheck = s.layoutCheck;
+
+        labelAreas(s);
+
+        auto reachable = [&](int x, int y) {
+            return playerArea >= 0 && areas.componentAt(x, y) == playerArea;
+        };
+
+        layoutCheck = Maze::LayoutCheck();
+        layoutCheck.areaCount = areas.getComponentCount();
+        layoutCheck.goalReachable = goalX >= 0 && reachable(goalX, goalY);
+        for (const auto& item : items) {
+            if (!reachable(item.first, item.second)) ++layoutCheck.unreachableItems;
+        }
+        for (const auto& enemy : enemies) {
+            if (!reachable(enemy.first, enemy.second)) ++layoutCheck.unreachableEnemies;
+        }
+
+        if (playerArea < 0) {
+            SDL_Log("Maze layout: the player does not start on a path tile");
+        }
+        if (!layoutCheck.goalReachable && !s.endless && !s.world && !s.mapped) {
+            SDL_Log("Maze layout: the goal can't be reached from the player's start");
+        }
+        if (layoutCheck.unreachableItems > 0) {
+            SDL_Log("Maze layout: %d item(s) can't be reached from the player's start", layoutCheck.unreachableItems);
+        }
+        if (layoutCheck.unreachableEnemies > 0) {
+            SDL_Log("Maze layout: %d enemy(s) can't reach the player's area", layoutCheck.unreachableEnemies);
+        }
+    }
+
+    // Fill the maze from a layout and place everything on it
+    void placeLayout(const std::vector<std::vector<int>>& layout) {
+        Maze::SessionState& s = state();
+        auto& maze = s.maze;
+
+        // Save original for restart
+        s.originalLayout = layout;
+        ++s.revision;
+
+        // Clear old items and enemies
+        Item::clearAll();
+        Enemy::clearAll();
+
+        // Where the layout puts things, for the reachability check
+        int goalX = -1, goalY = -1;
+        std::vector<std::pair<int, int>> layoutItems;
+        std::vector<std::pair<int, int>> layoutEnemies;
+
+        // Place everything based on tile values
+        for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+            for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
+                int cell = layout[y][x];
+
+                switch (cell) {
+                case WALL: maze[y][x] = WALL; break;
+                case PATH: maze[y][x] = PATH; break;
+                case ITEM:
+                    maze[y][x] = PATH;
+                    Item::add(x, y);
+                    layoutItems.push_back({ x, y });
+                    break;
+                case PLAYER_INT:
+                    maze[y][x] = PATH;
+                    Player::setPosition(x, y);
+                    break;
+                case GOAL_INT:
+                    maze[y][x] = PATH;
+                    Goal::setPosition(x, y);
+                    goalX = x;
+                    goalY = y;
+                    break;
+                case ENEMY_INT:
+                    maze[y][x] = PATH;
+                    Enemy::add(x, y);
+                    layoutEnemies.push_back({ x, y });
+                    break;
+                default:
+                    maze[y][x] = WALL;
+                }
+
+                s.walkGrid.set(x, y, maze[y][x] != WALL);
+            }
+        }
+
+        checkLayout(goalX, goalY, layoutItems, layoutEnemies);
+
+        // Randomly fill missing items and enemies (only where the player can get to)
+        Item::fillRandom();
+        Enemy::fillRandom();
+    }
+}
+
+std::shared_ptr<Maze::SessionState> Maze::createSessionState() {
+    return std::make_shared<SessionState>();
 }
 
 void Maze::loadLayout(const std::vector<std::vector<int>>& layout) {
-    // Save original for restart
-    originalLayout = layout;
+    state().endless.reset();
+    state().world.reset();
+    state().mapped.reset();
+    state().hierarchy.reset();
+    placeLayout(layout);
+}
 
-    // Clear old items and enemies
-    Item::clearAll();
-    Enemy::clearAll();
+void Maze::reload() {
+    SessionState& s = state();
+    if (s.endless) {
+        loadEndless(s.endlessSeed);
+        return;
+    }
+    if (s.world) {
+        loadWorld(s.worldSeed);
+        return;
+    }
+    std::string error;
+    if (s.mapped && loadMapped(s.mappedPath, error)) {
+        return;
+    }
+    loadLayout(s.originalLayout);
+}
+
+void Maze::loadEndless(uint32_t seed) {
+    EllerGenerator generator(GameConfig::MAZE_WIDTH, seed);
+    std::vector<std::vector<int>> layout(GameConfig::MAZE_HEIGHT, std::vector<int>(GameConfig::MAZE_WIDTH));
+    std::vector<uint8_t> row(GameConfig::MAZE_WIDTH);
+    for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+        generator.getRow(y, row.data());
+        layout[y].assign(row.begin(), row.end());
+    }
+    layout[1][1] = PLAYER_INT;
+
+    // The generator carries on from the rows already on screen
+    SessionState& s = state();
+    s.endless = std::make_unique<EllerGenerator>(std::move(generator));
+    s.endlessSeed = seed;
+    s.topRow = 0;
+    s.world.reset();
+    s.mapped.reset();
+    s.hierarchy.reset();
+    Goal::setPosition(-1, -1);
+    placeLayout(layout);
+}
 
-    // Place everything based on tile values
+bool Maze::isEndless() {
+    return state().endless != nullptr;
+}
+
+void Maze::scrollEndless() {
+    SessionState& s = state();
+    if (!s.endless) return;
+
+    const int width = GameConfig::MAZE_WIDTH;
+    const int height = GameConfig::MAZE_HEIGHT;
+    for (int y = 0; y + 1 < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            s.maze[y][x] = s.maze[y + 1][x];
+            s.walkGrid.set(x, y, s.maze[y][x] != WALL);
+        }
+    }
+
+    std::vector<uint8_t> row(width);
+    s.endless->getRow(s.topRow + height, row.data());
+    for (int x = 0; x < width; ++x) {
+        s.maze[height - 1][x] = row[x] ? PATH : WALL;
+        s.walkGrid.set(x, height - 1, row[x] != 0);
+    }
+    ++s.topRow;
+    ++s.revision;
+
+    // Everything on the maze moves up with it
+    Player::setPosition(Player::getX(), Player::getY() - 1);
+    Item::scroll(0, 1);
+    Enemy::scroll(0, 1);
+
+    // New tiles came in, so find the player's area again before placing new things there
+    labelAreas(s);
+    Item::fillRandom();
+    Enemy::fillRandom();
+}
+
+int64_t Maze::getTopRow() {
+    return state().topRow;
+}
+
+void Maze::loadWorld(uint32_t seed) {
+    SessionState& s = state();
+    s.endless.reset();
+    s.mapped.reset();
+    s.hierarchy.reset();
+    s.world = std::make_unique<ChunkWorld>(seed, static_cast<size_t>(GameConfig::WORLD_CACHE_KB) * 1024);
+    s.worldSeed = seed;
+
+    // World tile (1, 1) is always a cell; put it in the middle of the view
+    const int startX = GameConfig::MAZE_WIDTH / 2;
+    const int startY = GameConfig::MAZE_HEIGHT / 2;
+    s.originX = 1 - startX;
+    s.originY = 1 - startY;
+
+    std::vector<std::vector<int>> layout(GameConfig::MAZE_HEIGHT, std::vector<int>(GameConfig::MAZE_WIDTH));
     for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
         for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
-            int cell = layout[y][x];
-
-            switch (cell) {
-            case WALL: maze[y][x] = WALL; break;
-            case PATH: maze[y][x] = PATH; break;
-            case ITEM:
-                maze[y][x] = PATH;
-                Item::add(x, y);
-                break;
-            case PLAYER_INT:
-                maze[y][x] = PATH;
-                Player::setPosition(x, y);
-                break;
-            case GOAL_INT:
-                maze[y][x] = PATH;
-                Goal::setPosition(x, y);
-                break;
-            case ENEMY_INT:
-                maze[y][x] = PATH;
-                Enemy::add(x, y);
-                break;
-            default:
-                maze[y][x] = WALL;
-            }
+            layout[y][x] = s.world->isWalkable(s.originX + x, s.originY + y) ? PATH : WALL;
+        }
+    }
+    layout[startY][startX] = PLAYER_INT;
+
+    Goal::setPosition(-1, -1);
+    placeLayout(layout);
+    s.world->prefetchAround(1, 1);
+}
+
+bool Maze::loadMapped(const std::string& path, std::string& error) {
+    auto mapped = std::make_unique<MappedMaze>();
+    if (!mapped->open(path, error)) return false;
+    if (mapped->getPlayerX() < 0) {
+        error = path + " has no player start";
+        return false;
+    }
+
+    SessionState& s = state();
+    s.endless.reset();
+    s.world.reset();
+    s.mapped = std::move(mapped);
+    s.mappedPath = path;
+
+    // A sidecar made with "MazeGame --contract" answers how far away the goal is, even when
+    // it is nowhere near the view. It is checked against the hash in the maze file's header
+    // and looks tiles up in the mapped file, so the walls are still never copied.
+    s.hierarchy.reset();
+    const std::string sidecar = ContractionHierarchy::sidecarPath(path);
+    if (std::ifstream(sidecar).good()) {
+        const MappedMaze* maze = s.mapped.get();
+        s.hierarchy = std::make_unique<ContractionHierarchy>();
+        if (!s.hierarchy->load(sidecar, maze->getWidth(), maze->getHeight(), maze->getLayoutHash(),
+            [maze](int x, int y) { return maze->isWalkable(x, y); })) {
+            SDL_Log("%s doesn't match %s; run MazeGame --contract again", sidecar.c_str(), path.c_str());
+            s.hierarchy.reset();
+        }
+    }
+
+    // The player starts in the middle of the view
+    const int startX = GameConfig::MAZE_WIDTH / 2;
+    const int startY = GameConfig::MAZE_HEIGHT / 2;
+    s.originX = s.mapped->getPlayerX() - startX;
+    s.originY = s.mapped->getPlayerY() - startY;
+
+    std::vector<std::vector<int>> layout(GameConfig::MAZE_HEIGHT, std::vector<int>(GameConfig::MAZE_WIDTH));
+    for (int y = 0; y < GameConfig::MAZE_HEIGHT; ++y) {
+        for (int x = 0; x < GameConfig::MAZE_WIDTH; ++x) {
+            layout[y][x] = s.mapped->isWalkable(s.originX + x, s.originY + y) ? PATH : WALL;
         }
     }
 
-    // Randomly fill missing items and enemies
+    // The file's goal, items and enemies go on first, so random ones only fill up the rest.
+    // (An old view just right of this one: every tile counts as not shown before.)
+    Item::clearAll();
+    Enemy::clearAll();
+    placeMappedObjects(s, s.originX + GameConfig::MAZE_WIDTH, s.originY);
+    std::vector<std::pair<int, int>> items = Item::getPositions();
+    std::vector<std::pair<int, int>> enemies = Enemy::getPositions();
+    for (const auto& item : items) layout[item.second][item.first] = ITEM;
+    for (const auto& enemy : enemies) layout[enemy.second][enemy.first] = ENEMY_INT;
+    if (Goal::getX() >= 0) layout[Goal::getY()][Goal::getX()] = GOAL_INT;
+    layout[startY][startX] = PLAYER_INT;
+    placeLayout(layout);
+    return true;
+}
+
+bool Maze::isMapped() {
+    return state().mapped != nullptr;
+}
+
+int Maze::getMappedGoalSteps(int x, int y) {
+    const SessionState& s = state();
+    if (!s.mapped || !s.hierarchy || s.mapped->getGoalX() < 0) return -1;
+    return s.hierarchy->distance(static_cast<int>(s.originX + x), static_cast<int>(s.originY + y),
+        s.mapped->getGoalX(), s.mapped->getGoalY());
+}
+
+bool Maze::isWorld() {
+    return state().world != nullptr || state().mapped != nullptr;
+}
+
+void Maze::scrollWorld(int dx, int dy) {
+    SessionState& s = state();
+    if ((!s.world && !s.mapped) || (dx == 0 && dy == 0)) return;
+
+    const int64_t oldX = s.originX, oldY = s.originY;
+    s.originX += dx;
+    s.originY += dy;
+    copyWorldView(s);
+    ++s.revision;
+
+    // Everything on the maze stays where it is in the world
+    Player::setPosition(Player::getX() - dx, Player::getY() - dy);
+    Item::scroll(dx, dy);
+    Enemy::scroll(dx, dy);
+    if (s.mapped) placeMappedObjects(s, oldX, oldY);
+
+    labelAreas(s);
     Item::fillRandom();
     Enemy::fillRandom();
+
+    // Have the chunks the player is heading for ready before they come into view
+    if (s.world) s.world->prefetchAround(s.originX + Player::getX(), s.originY + Player::getY());
 }
 
-void Maze::reload() {
-    loadLayout(originalLayout);
+int64_t Maze::getWorldX() {
+    return state().originX;
+}
+
+int64_t Maze::getWorldY() {
+    return state().originY;
 }
 
 bool Maze::isWalkable(int x, int y) {
     if (x < 0 || x >= GameConfig::MAZE_WIDTH || y < 0 || y >= GameConfig::MAZE_HEIGHT) {
         return false;
     }
-    return maze[y][x] != WALL;
+    SessionState& s = state();
+    if (s.world || s.mapped) return isWorldWalkable(s, s.originX + x, s.originY + y);
+    return s.maze[y][x] != WALL;
+}
+
+bool Maze::isReachable(int x, int y) {
+    if (!isWalkable(x, y)) return false;
+    SessionState& s = state();
+    if (s.areasRevision != s.revision) labelAreas(s);
+    if (s.playerArea < 0) return true;  // No player start to measure from
+    return s.areas.componentAt(x, y) == s.playerArea;
+}
+
+const Maze::LayoutCheck& Maze::getLayoutCheck() {
+    return state().layoutCheck;
+}
+
+void Maze::setWalkable(int x, int y, bool walkable) {
+    if (x < 0 || x >= GameConfig::MAZE_WIDTH || y < 0 || y >= GameConfig::MAZE_HEIGHT) {
+        return;
+    }
+    SessionState& s = state();
+    if (s.world) s.world->setWalkable(s.originX + x, s.originY + y, walkable);
+    if (s.mapped) s.mapped->setWalkable(s.originX + x, s.originY + y, walkable);
+    s.hierarchy.reset();
+    s.maze[y][x] = walkable ? PATH : WALL;
+    s.walkGrid.set(x, y, walkable);
+    ++s.revision;
+    if (s.junctionsRevision == s.revision - 1) {
+        s.junctions.updateTile(s.walkGrid, x, y);
+        s.junctionsRevision = s.revision;
+    }
+    Enemy::onTileChanged(x, y);
+}
+
+int Maze::getRevision() {
+    return state().revision;
+}
+
+const BitGrid& Maze::getWalkGrid() {
+    return state().walkGrid;
+}
+
+int Maze::getWalkingDistance(int ax, int ay, int bx, int by) {
+    SessionState& s = state();
+    if (s.junctionsRevision != s.revision) {
+        s.junctions.build(s.walkGrid);
+        s.junctionsRevision = s.revision;
+    }
+    return s.junctions.distance(ax, ay, bx, by);
 }
 
 void Maze::render() {
@@ -94,7 +529,7 @@ void Maze::render() {
             };
 
             // Custom tile colors
-            SDL_Color color = (maze[y][x] == WALL) ? GameConfig::COLOR_WALL : GameConfig::COLOR_PATH;
+            SDL_Color color = isWalkable(x, y) ? GameConfig::COLOR_PATH : GameConfig::COLOR_WALL;
             SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
             SDL_RenderFillRect(renderer, &tileRect);
         }
@@ -1,7 +1,11 @@
 // Maze.h
 #pragma once
 
+#include "BitGrid.h"
+#include <cstdint>
 #include <vector>
+#include <memory>
+#include <string>
 
 namespace Maze {
     // Load the initial layout from a 2D vector (called once at start)
@@ -15,4 +19,80 @@ namespace Maze {
 
     // Check if a tile is walkable (not a wall)
     bool isWalkable(int x, int y);
+
+    // Check if a tile is walkable and connected to the tile the player is on. Random items
+    // and enemies are only placed on such tiles. After walls change, the areas are worked
+    // out again on the next call.
+    bool isReachable(int x, int y);
+
+    // What loadLayout found when it checked which tiles the player can get to
+    struct LayoutCheck {
+        int areaCount = 0;          // Separate walkable areas (1 = everything is connected)
+        bool goalReachable = true;
+        int unreachableItems = 0;
+        int unreachableEnemies = 0;
+    };
+
+    const LayoutCheck& getLayoutCheck();
+
+    // Turn a tile into a wall or a path while the game is running (doors, breakable walls, editors)
+    void setWalkable(int x, int y, bool walkable);
+
+    // Goes up by one every time the walls change (layout loaded or a tile edited).
+    // Caches built from the maze compare this to know when they are out of date.
+    int getRevision();
+
+    // Walkable tiles packed as bits (1 = walkable), for fast whole-maze algorithms
+    const BitGrid& getWalkGrid();
+
+    // Steps between two tiles of the view, or -1 if they aren't connected. Answered on the
+    // maze's JunctionGraph, which setWalkable keeps up to date tile by tile.
+    int getWalkingDistance(int ax, int ay, int bx, int by);
+
+    // Endless mode: show the first rows of an endless maze made from `seed` (see
+    // EllerGenerator), with the player in the top-left corner and no goal
+    void loadEndless(uint32_t seed);
+
+    bool isEndless();
+
+    // Endless mode: drop the top row and add the next one at the bottom. The player,
+    // items and enemies move up with the maze; whatever was on the dropped row is removed.
+    void scrollEndless();
+
+    // Endless mode: how many rows have scrolled away (the endless maze's row shown at the top)
+    int64_t getTopRow();
+
+    // Open world: show the middle of a maze without edges made from `seed` (see
+    // ChunkWorld), with the player in the middle of the view and no goal. isWalkable and
+    // the other tile functions then look the tiles up in the world's chunks.
+    void loadWorld(uint32_t seed);
+
+    // True in the open world and in mapped mazes (both scroll the view with scrollWorld)
+    bool isWorld();
+
+    // Open world and mapped mazes: move the view by (dx, dy) tiles. The player, items and
+    // enemies stay on their tiles of the world; items and enemies that end up outside the
+    // view are removed.
+    void scrollWorld(int dx, int dy);
+
+    // Play a maze file written by MappedMaze (see MappedMaze.h) straight from the mapped
+    // file. It scrolls like the open world, with the player's start in the middle of the
+    // view; the file's goal, items and enemies appear as their tiles come into view.
+    // On failure returns false, explains why in `error` and leaves the maze as it was.
+    bool loadMapped(const std::string& path, std::string& error);
+
+    bool isMapped();
+
+    // Mapped mazes with a contraction hierarchy sidecar (see ContractionHierarchy.h): steps
+    // from view tile (x, y) to the file's goal, wherever it is. -1 without a sidecar, after a
+    // wall was edited, or when the goal can't be reached.
+    int getMappedGoalSteps(int x, int y);
+
+    // Open world and mapped mazes: the world tile shown in the top-left corner of the view
+    int64_t getWorldX();
+    int64_t getWorldY();
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+// MazeFile.cpp
+#include "MazeFile.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+    // What a character means; tile codes are 0..5
+    const uint8_t SKIP = 6;
+    const uint8_t NEWLINE = 7;
+    const uint8_t COMMENT = 8;
+    const uint8_t INVALID = 9;
+
+    const char SYMBOLS[] = { '#', '.', '*', 'P', 'G', 'E' };
+
+    std::array<uint8_t, 256> makeTable() {
+        std::array<uint8_t, 256> table;
+        table.fill(INVALID);
+        for (uint8_t tile = 0; tile < 6; ++tile) {
+            table[static_cast<unsigned char>('0' + tile)] = tile;
+            table[static_cast<unsigned char>(SYMBOLS[tile])] = tile;
+        }
+        table[static_cast<unsigned char>(' ')] = SKIP;
+        table[static_cast<unsigned char>('\t')] = SKIP;
+        table[static_cast<unsigned char>(',')] = SKIP;
+        table[static_cast<unsigned char>('\r')] = SKIP;
+        table[static_cast<unsigned char>('\n')] = NEWLINE;
+        table[static_cast<unsigned char>(';')] = COMMENT;
+        return table;
+    }
+
+    const std::array<uint8_t, 256> TABLE = makeTable();
+
+    // Turns text into tiles block by block; a row may start in one block and end in the next
+    class Parser {
+    public:
+        // `capacity`: at least the number of characters that will be fed in
+        Parser(MazeFile::TileGrid& grid, size_t capacity)
+            : grid(grid) {
+            grid.width = 0;
+            grid.height = 0;
+            grid.tiles.resize(capacity);
+            out = grid.tiles.data();
+        }
+
+        bool feed(const char* text, size_t size, std::string& error) {
+            const char* end = text + size;
+            while (text < end) {
+                // Fast way for the usual case: the rest of the line is nothing but tiles.
+                // Translate it without a branch per character and check afterwards.
+                const char* lineEnd = static_cast<const char*>(std::memchr(text, '\n', end - text));
+                if (!lineEnd) lineEnd = end;
+                const size_t count = static_cast<size_t>(lineEnd - text);
+                uint8_t highest = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    uint8_t kind = TABLE[static_cast<unsigned char>(text[i])];
+                    out[i] = kind;
+                    highest = std::max(highest, kind);
+                }
+
+                if (highest < SKIP && !inComment) {
+                    out += count;
+                    lineTiles += static_cast<int>(count);
+                }
+                else if (!feedSlowly(text, lineEnd, error)) {
+                    return false;
+                }
+
+                text = lineEnd;
+                if (text < end) {
+                    if (!endLine(error)) return false;
+                    ++text;
+                }
+            }
+            return true;
+        }
+
+        // Character by character, with separators and comments
+        bool feedSlowly(const char* text, const char* end, std::string& error) {
+            for (const char* c = text; c < end; ++c) {
+                uint8_t kind = TABLE[static_cast<unsigned char>(*c)];
+                if (kind < SKIP) {
+                    if (inComment) continue;
+                    *out++ = kind;
+                    ++lineTiles;
+                }
+                else if (kind == NEWLINE) {
+                    if (!endLine(error)) return false;
+                }
+                else if (kind == COMMENT) {
+                    inComment = true;
+                }
+                else if (kind == INVALID && !inComment) {
+                    error = "line " + std::to_string(line) + ": unknown tile '" + std::string(1, *c) + "'";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool finish(std::string& error) {
+            if (!endLine(error)) return false;
+            grid.tiles.resize(static_cast<size_t>(out - grid.tiles.data()));
+            if (grid.height == 0) {
+                error = "no rows of tiles";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        MazeFile::TileGrid& grid;
+        uint8_t* out;
+        int lineTiles = 0;
+        long long line = 1;
+        bool inComment = false;
+
+        bool endLine(std::string& error) {
+            inComment = false;
+            if (lineTiles > 0) {
+                if (grid.height == 0) {
+                    grid.width = lineTiles;
+                }
+                else if (lineTiles != grid.width) {
+                    error = "line " + std::to_string(line) + ": " + std::to_string(lineTiles) +
+                        " tiles, but the rows above have " + std::to_string(grid.width);
+                    return false;
+                }
+                ++grid.height;
+                lineTiles = 0;
+            }
+            ++line;
+            return true;
+        }
+    };
+
+    // Characters read from the disk at a time
+    const size_t READ_BLOCK = 1 << 20;
+}
+
+bool MazeFile::parse(const char* text, size_t size, TileGrid& grid, std::string& error) {
+    Parser parser(grid, size);
+    return parser.feed(text, size, error) && parser.finish(error);
+}
+
+bool MazeFile::load(const std::string& path, TileGrid& grid, std::string& error) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        error = "can't open " + path;
+        return false;
+    }
+    const std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+
+    Parser parser(grid, static_cast<size_t>(fileSize));
+    std::vector<char> block(READ_BLOCK);
+    std::streamoff left = fileSize;
+    while (left > 0) {
+        size_t size = static_cast<size_t>(std::min<std::streamoff>(left, static_cast<std::streamoff>(block.size())));
+        if (!in.read(block.data(), static_cast<std::streamsize>(size))) {
+            error = "can't read " + path;
+            return false;
+        }
+        if (!parser.feed(block.data(), size, error)) return false;
+        left -= static_cast<std::streamoff>(size);
+    }
+    return parser.finish(error);
+}
+
+bool MazeFile::parseTile(char c, uint8_t& tile) {
+    uint8_t kind = TABLE[static_cast<unsigned char>(c)];
+    if (kind >= SKIP) return false;
+    tile = kind;
+    return true;
+}
+
+bool MazeFile::save(const std::string& path, const TileGrid& grid) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    std::string row(static_cast<size_t>(grid.width) + 1, '\n');
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            uint8_t tile = grid.at(x, y);
+            row[x] = tile < 6 ? SYMBOLS[tile] : SYMBOLS[0];
+        }
+        out.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(out);
+}
+
+bool MazeFile::toLayout(const TileGrid& grid, std::vector<std::vector<int>>& layout, std::string& error) {
+    if (grid.width > GameConfig::MAZE_WIDTH || grid.height > GameConfig::MAZE_HEIGHT) {
+        error = "the maze is " + std::to_string(grid.width) + " x " + std::to_string(grid.height) +
+            " tiles, but the game only has room for " + std::to_string(GameConfig::MAZE_WIDTH) + " x " +
+            std::to_string(GameConfig::MAZE_HEIGHT) + " (MAZE_WIDTH and MAZE_HEIGHT in GameConfig.h)";
+        return false;
+    }
+
+    layout.assign(GameConfig::MAZE_HEIGHT, std::vector<int>(GameConfig::MAZE_WIDTH, 0));
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            layout[y][x] = grid.at(x, y);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+// MazeFile.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reads and writes mazes as plain text files, one line per row of tiles.
+//
+// Every tile is one character, either the tile code from main.cpp or a symbol for it:
+//   0 or #  wall        3 or P  player
+//   1 or .  path        4 or G  goal
+//   2 or *  item        5 or E  enemy
+// Spaces, tabs and commas between tiles are ignored, so "0,1,1,0" works as well as "#..#".
+// Everything after a ';' on a line is a comment, and lines without tiles are skipped.
+// All rows must be equally long.
+//
+// The loader reads the file in large blocks and turns characters into tiles with a lookup
+// table as they come in, straight into one flat buffer, so big files load about as fast
+// as the disk can deliver them.
+namespace MazeFile {
+    // Tile codes, row by row
+    struct TileGrid {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> tiles;
+
+        uint8_t at(int x, int y) const { return tiles[static_cast<size_t>(y) * width + x]; }
+    };
+
+    // Load a text maze. On failure returns false and explains why in `error`
+    // (with the line number for mistakes in the file).
+    bool load(const std::string& path, TileGrid& grid, std::string& error);
+
+    // Same for text that is already in memory
+    bool parse(const char* text, size_t size, TileGrid& grid, std::string& error);
+
+    // The tile a character stands for (code or symbol); false if it isn't one
+    bool parseTile(char c, uint8_t& tile);
+
+    // Write a maze with the symbols (#, ., P, ...); returns false if the file can't be written
+    bool save(const std::string& path, const TileGrid& grid);
+
+    // A layout for Maze::loadLayout. Mazes smaller than the game's MAZE_WIDTH x MAZE_HEIGHT
+    // are filled up with walls on the right and bottom; bigger ones don't fit and fail.
+    bool toLayout(const TileGrid& grid, std::vector<std::vector<int>>& layout, std::string& error);
+}
@@ -0,0 +1,384 @@
+// MazeGenerator.cpp
+#include "MazeGenerator.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <utility>
+
+namespace {
+    // Tile values of the layout in main.cpp
+    const uint8_t WALL = 0;
+    const uint8_t PATH = 1;
+    const uint8_t ITEM = 2;
+    const uint8_t PLAYER = 3;
+    const uint8_t GOAL = 4;
+    const uint8_t ENEMY = 5;
+
+    // Enemies are never placed closer than this (in steps) to the player's start
+    const int ENEMY_MIN_DISTANCE = 6;
+
+    // Growing tree: out of 4 picks, this many take the newest cell and the rest a random one
+    const int GROWING_TREE_NEWEST = 3;
+
+    const char* const NAMES[] = { "backtracker", "kruskal", "prim", "wilson", "growing-tree" };
+
+    // xorshift32: a few instructions per number, which matters when a maze has millions of cells
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Random number from 0 to count - 1
+    int randomBelow(uint32_t& state, int count) {
+        return static_cast<int>((static_cast<uint64_t>(nextRandom(state)) * static_cast<uint32_t>(count)) >> 32);
+    }
+
+    // For every 4-bit set of directions: how many there are, and the k-th one
+    struct DirectionPicker {
+        uint8_t count[16];
+        uint8_t pick[16][4];
+
+        DirectionPicker() {
+            for (int mask = 0; mask < 16; ++mask) {
+                count[mask] = 0;
+                for (int d = 0; d < 4; ++d) {
+                    if (mask & (1 << d)) pick[mask][count[mask]++] = static_cast<uint8_t>(d);
+                }
+            }
+        }
+
+        int choose(unsigned mask, uint32_t& random) const {
+            return pick[mask][randomBelow(random, count[mask])];
+        }
+    };
+
+    const DirectionPicker picker;
+
+    // Wilson: a cell's state is the direction its random walk left in (low 2 bits) plus these flags
+    const uint8_t IN_MAZE = 0x80;
+    const uint8_t OUTSIDE = 0x40;
+
+    // Prim: cell states
+    const uint8_t FREE = 0;
+    const uint8_t FRONTIER = 1;
+    const uint8_t IN_TREE = 2;
+    const uint8_t RING = 3;
+
+    int findRoot(std::vector<int32_t>& parent, int cell) {
+        while (parent[cell] != cell) {
+            parent[cell] = parent[parent[cell]];    // Path halving keeps the trees flat
+            cell = parent[cell];
+        }
+        return cell;
+    }
+}
+
+const char* MazeGenerator::getName(Algorithm algorithm) {
+    int index = static_cast<int>(algorithm);
+    return index >= 0 && index < static_cast<int>(Algorithm::COUNT) ? NAMES[index] : "unknown";
+}
+
+bool MazeGenerator::findAlgorithm(const std::string& name, Algorithm& algorithm) {
+    for (int i = 0; i < static_cast<int>(Algorithm::COUNT); ++i) {
+        if (name == NAMES[i]) {
+            algorithm = static_cast<Algorithm>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void MazeGenerator::prepare(uint8_t* tiles, int width, int height, uint8_t inside, uint8_t outside) {
+    this->tiles = tiles;
+    this->width = width;
+    std::memset(tiles, WALL, static_cast<size_t>(width) * height);
+
+    cellsX = std::max(0, (width - 1) / 2);
+    cellsY = std::max(0, (height - 1) / 2);
+    stride = cellsX + 2;
+
+    cellState.assign(static_cast<size_t>(stride) * (cellsY + 2), outside);
+    for (int cy = 0; cy < cellsY; ++cy) {
+        std::memset(cellState.data() + (cy + 1) * stride + 1, inside, cellsX);
+    }
+
+    // Same order as the Direction enum: up, right, down, left
+    cellOffset[0] = -stride; cellOffset[1] = 1; cellOffset[2] = stride; cellOffset[3] = -1;
+    tileOffset[0] = -width; tileOffset[1] = 1; tileOffset[2] = width; tileOffset[3] = -1;
+}
+
+MazeGenerator::Spot MazeGenerator::spotAt(int cx, int cy) const {
+    return { (cy + 1) * stride + cx + 1, (cy * 2 + 1) * width + cx * 2 + 1 };
+}
+
+void MazeGenerator::carve(Algorithm algorithm, uint8_t* tiles, int width, int height, uint32_t seed) {
+    uint32_t random = seed * 2654435761u + 0x7F4A7C15u;
+    if (random == 0) random = 1;    // xorshift would only ever return 0
+
+    switch (algorithm) {
+    case Algorithm::KRUSKAL:
+        prepare(tiles, width, height, 0, 0);
+        if (cellsX > 0 && cellsY > 0) carveKruskal(random);
+        break;
+    case Algorithm::PRIM:
+        prepare(tiles, width, height, FREE, RING);
+        if (cellsX > 0 && cellsY > 0) carvePrim(random);
+        break;
+    case Algorithm::WILSON:
+        prepare(tiles, width, height, 0, OUTSIDE);
+        if (cellsX > 0 && cellsY > 0) carveWilson(random);
+        break;
+    case Algorithm::GROWING_TREE:
+        prepare(tiles, width, height, 0, 1);
+        if (cellsX > 0 && cellsY > 0) carveGrowingTree(random);
+        break;
+    default:
+        prepare(tiles, width, height, 0, 1);
+        if (cellsX > 0 && cellsY > 0) carveBacktracker(random);
+        break;
+    }
+}
+
+// Depth-first search: keep walking to a random unvisited neighbor, and step back along
+// the way you came when there is none. Cell states: 0 = not visited yet, 1 = visited.
+void MazeGenerator::carveBacktracker(uint32_t& random) {
+    spots.resize(static_cast<size_t>(cellsX) * cellsY);
+    Spot* stack = spots.data();
+    uint8_t* state = cellState.data();
+
+    int top = 0;
+    Spot spot = spotAt(0, 0);
+    stack[0] = spot;
+    state[spot.cell] = 1;
+    tiles[spot.tile] = PATH;
+
+    while (true) {
+        unsigned open = (state[spot.cell - stride] == 0) | (state[spot.cell + 1] == 0) << 1 |
+            (state[spot.cell + stride] == 0) << 2 | (state[spot.cell - 1] == 0) << 3;
+        if (!open) {
+            if (--top < 0) break;
+            spot = stack[top];
+            continue;
+        }
+
+        int d = picker.choose(open, random);
+        tiles[spot.tile + tileOffset[d]] = PATH;
+        spot.cell += cellOffset[d];
+        spot.tile += 2 * tileOffset[d];
+        state[spot.cell] = 1;
+        tiles[spot.tile] = PATH;
+        stack[++top] = spot;
+    }
+}
+
+// Every wall between two cells in random order; a wall is removed when the cells on
+// either side aren't connected yet (checked with union-find).
+void MazeGenerator::carveKruskal(uint32_t& random) {
+    edges.clear();
+    edges.reserve(static_cast<size_t>(cellsX) * cellsY * 2);
+    parent.resize(static_cast<size_t>(cellsX) * cellsY);
+
+    for (int cy = 0; cy < cellsY; ++cy) {
+        int tile = (cy * 2 + 1) * width + 1;
+        for (int cx = 0; cx < cellsX; ++cx, tile += 2) {
+            uint32_t cell = static_cast<uint32_t>(cy * cellsX + cx);
+            parent[cell] = static_cast<int32_t>(cell);
+            tiles[tile] = PATH;
+
+            // Axis 0 = wall to the right, 1 = wall below
+            if (cx + 1 < cellsX) edges.push_back(static_cast<uint64_t>((tile + 1) * 2) << 32 | cell);
+            if (cy + 1 < cellsY) edges.push_back(static_cast<uint64_t>((tile + width) * 2 + 1) << 32 | cell);
+        }
+    }
+
+    // Fisher-Yates shuffle
+    for (size_t i = edges.size(); i > 1; --i) {
+        std::swap(edges[i - 1], edges[randomBelow(random, static_cast<int>(i))]);
+    }
+
+    int joinsLeft = cellsX * cellsY - 1;
+    for (size_t i = 0; i < edges.size() && joinsLeft > 0; ++i) {
+        uint64_t edge = edges[i];
+        int a = static_cast<int>(edge & 0xFFFFFFFFu);
+        uint32_t wall = static_cast<uint32_t>(edge >> 32);
+        int b = a + ((wall & 1) ? cellsX : 1);
+
+        int rootA = findRoot(parent, a);
+        int rootB = findRoot(parent, b);
+        if (rootA == rootB) continue;
+
+        parent[rootB] = rootA;
+        tiles[wall >> 1] = PATH;
+        --joinsLeft;
+    }
+}
+
+// Grow the maze from one cell: keep a list of cells next to it (the frontier), attach a
+// random one by a random wall, and add its own free neighbors to the frontier.
+void MazeGenerator::carvePrim(uint32_t& random) {
+    spots.clear();
+    spots.reserve(static_cast<size_t>(cellsX) * cellsY);
+    uint8_t* state = cellState.data();
+
+    auto addToTree = [&](Spot spot) {
+        state[spot.cell] = IN_TREE;
+        tiles[spot.tile] = PATH;
+        for (int d = 0; d < 4; ++d) {
+            int next = spot.cell + cellOffset[d];
+            if (state[next] != FREE) continue;
+            state[next] = FRONTIER;
+            spots.push_back({ next, spot.tile + 2 * tileOffset[d] });
+        }
+    };
+
+    addToTree(spotAt(randomBelow(random, cellsX), randomBelow(random, cellsY)));
+
+    while (!spots.empty()) {
+        int index = randomBelow(random, static_cast<int>(spots.size()));
+        Spot spot = spots[index];
+        spots[index] = spots.back();
+        spots.pop_back();
+
+        unsigned inTree = (state[spot.cell - stride] == IN_TREE) | (state[spot.cell + 1] == IN_TREE) << 1 |
+            (state[spot.cell + stride] == IN_TREE) << 2 | (state[spot.cell - 1] == IN_TREE) << 3;
+        int d = picker.choose(inTree, random);
+        tiles[spot.tile + tileOffset[d]] = PATH;
+        addToTree(spot);
+    }
+}
+
+// Loop-erased random walks: from each cell not in the maze yet, walk randomly until the
+// maze is hit, then add the walk to the maze. Each cell only remembers the direction it
+// was last left in, so loops in the walk disappear by themselves when it is followed again.
+void MazeGenerator::carveWilson(uint32_t& random) {
+    uint8_t* state = cellState.data();
+
+    Spot first = spotAt(randomBelow(random, cellsX), randomBelow(random, cellsY));
+    state[first.cell] = IN_MAZE;
+    tiles[first.tile] = PATH;
+
+    for (int cy = 0; cy < cellsY; ++cy) {
+        for (int cx = 0; cx < cellsX; ++cx) {
+            Spot start = spotAt(cx, cy);
+            if (state[start.cell] & IN_MAZE) continue;
+
+            // Walk until the maze is reached (directions into the ring are tried again)
+            int cell = start.cell;
+            while (!(state[cell] & IN_MAZE)) {
+                int d = nextRandom(random) >> 30;
+                if (state[cell + cellOffset[d]] & OUTSIDE) continue;
+                state[cell] = static_cast<uint8_t>(d);
+                cell += cellOffset[d];
+            }
+
+            // Follow the remembered directions from the start and carve them
+            Spot spot = start;
+            while (!(state[spot.cell] & IN_MAZE)) {
+                int d = state[spot.cell] & 3;
+                state[spot.cell] = IN_MAZE;
+                tiles[spot.tile] = PATH;
+                tiles[spot.tile + tileOffset[d]] = PATH;
+                spot.cell += cellOffset[d];
+                spot.tile += 2 * tileOffset[d];
+            }
+        }
+    }
+}
+
+// Like the backtracker, but sometimes continues from a random cell of the list instead of
+// the newest one, which adds side branches. Cell states: 0 = not visited yet, 1 = visited.
+// A cell with no unvisited neighbors left is swapped with the last one and dropped.
+void MazeGenerator::carveGrowingTree(uint32_t& random) {
+    spots.clear();
+    spots.reserve(static_cast<size_t>(cellsX) * cellsY);
+    uint8_t* state = cellState.data();
+
+    Spot start = spotAt(randomBelow(random, cellsX), randomBelow(random, cellsY));
+    state[start.cell] = 1;
+    tiles[start.tile] = PATH;
+    spots.push_back(start);
+
+    while (!spots.empty()) {
+        int last = static_cast<int>(spots.size()) - 1;
+        int index = randomBelow(random, 4) < GROWING_TREE_NEWEST ? last : randomBelow(random, last + 1);
+        Spot spot = spots[index];
+
+        unsigned open = (state[spot.cell - stride] == 0) | (state[spot.cell + 1] == 0) << 1 |
+            (state[spot.cell + stride] == 0) << 2 | (state[spot.cell - 1] == 0) << 3;
+        if (!open) {
+            spots[index] = spots[last];
+            spots.pop_back();
+            continue;
+        }
+
+        int d = picker.choose(open, random);
+        Spot next = { spot.cell + cellOffset[d], spot.tile + 2 * tileOffset[d] };
+        state[next.cell] = 1;
+        tiles[spot.tile + tileOffset[d]] = PATH;
+        tiles[next.tile] = PATH;
+        spots.push_back(next);
+    }
+}
+
+void MazeGenerator::placeObjects(uint8_t* tiles, int width, int height, uint32_t seed, int itemCount, int enemyCount) {
+    const int start = width + 1;    // Top-left cell
+    if (width < 3 || height < 3 || tiles[start] == WALL) return;
+
+    // Steps from the player's start to every path tile
+    const int tileCount = width * height;
+    std::vector<int> distance(tileCount, -1);
+    std::vector<int> queue = { start };
+    distance[start] = 0;
+    int farthest = start;
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int tile = queue[head];
+        if (distance[tile] > distance[farthest]) farthest = tile;
+
+        int x = tile % width;
+        int y = tile / width;
+        const int neighbors[4][2] = { { x, y - 1 }, { x + 1, y }, { x, y + 1 }, { x - 1, y } };
+        for (const auto& n : neighbors) {
+            if (n[0] < 0 || n[0] >= width || n[1] < 0 || n[1] >= height) continue;
+            int next = n[1] * width + n[0];
+            if (tiles[next] == WALL || distance[next] >= 0) continue;
+            distance[next] = distance[tile] + 1;
+            queue.push_back(next);
+        }
+    }
+
+    tiles[start] = PLAYER;
+    if (farthest != start) tiles[farthest] = GOAL;
+
+    // Random free path tiles, giving up after a while on mazes that are too small
+    std::mt19937 rng(seed);
+    auto place = [&](uint8_t value, int count, int minDistance) {
+        for (int attempt = 0; count > 0 && attempt < 100 * tileCount; ++attempt) {
+            int tile = static_cast<int>(rng() % static_cast<uint32_t>(tileCount));
+            if (tiles[tile] != PATH || distance[tile] < minDistance) continue;
+            tiles[tile] = value;
+            --count;
+        }
+    };
+    place(ITEM, itemCount, 1);
+    place(ENEMY, enemyCount, ENEMY_MIN_DISTANCE);
+}
+
+std::vector<std::vector<int>> MazeGenerator::generate(Algorithm algorithm, int width, int height, uint32_t seed) {
+    std::vector<uint8_t> tiles(static_cast<size_t>(width) * height);
+    MazeGenerator generator;
+    generator.carve(algorithm, tiles.data(), width, height, seed);
+    placeObjects(tiles.data(), width, height, seed, GameConfig::MAX_ITEMS, GameConfig::MAX_ENEMIES);
+
+    std::vector<std::vector<int>> layout(height, std::vector<int>(width));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            layout[y][x] = tiles[static_cast<size_t>(y) * width + x];
+        }
+    }
+    return layout;
+}
@@ -0,0 +1,72 @@
+// MazeGenerator.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Makes new maze layouts from a seed instead of typing them in by hand.
+//
+// All algorithms carve a "perfect" maze: cells sit on odd coordinates, the tiles between
+// two cells are opened up to connect them, and there is exactly one way between any two
+// cells. They differ in what the maze looks like:
+//   BACKTRACKER   long winding corridors, few dead ends (depth-first search)
+//   KRUSKAL       lots of short dead ends (walls removed in random order, union-find)
+//   PRIM          grows outward from one spot, many short branches
+//   WILSON        no bias at all: every possible maze is equally likely (random walks)
+//   GROWING_TREE  mostly backtracker, sometimes branching off somewhere random
+//
+// The same algorithm, size and seed always give the same maze.
+class MazeGenerator {
+public:
+    enum class Algorithm { BACKTRACKER, KRUSKAL, PRIM, WILSON, GROWING_TREE, COUNT };
+
+    static const char* getName(Algorithm algorithm);
+
+    // Look up an algorithm by its lowercase name ("backtracker", "growing-tree", ...)
+    static bool findAlgorithm(const std::string& name, Algorithm& algorithm);
+
+    // Carve a maze into `tiles`: width * height bytes, row by row, 0 = wall and 1 = path.
+    // Everything that was there before is overwritten. Width and height should be odd;
+    // with an even size the last column or row stays wall. Work buffers are kept between
+    // calls, so generating many mazes with one generator allocates nothing after the first.
+    void carve(Algorithm algorithm, uint8_t* tiles, int width, int height, uint32_t seed);
+
+    // Put the player in the top-left cell, the goal on the path tile farthest from it, and
+    // up to itemCount items and enemyCount enemies on random path tiles (enemies not too
+    // close to the player). Uses the tile values of main.cpp's layout.
+    static void placeObjects(uint8_t* tiles, int width, int height, uint32_t seed, int itemCount, int enemyCount);
+
+    // A complete layout for Maze::loadLayout, with GameConfig's item and enemy counts
+    static std::vector<std::vector<int>> generate(Algorithm algorithm, int width, int height, uint32_t seed);
+
+private:
+    // A cell and the tile it is drawn on, kept together so the tile never has to be worked out
+    struct Spot {
+        int32_t cell;
+        int32_t tile;
+    };
+
+    // Cell grid with a ring of extra cells around it, so neighbors never need bounds checks
+    int cellsX = 0, cellsY = 0;
+    int stride = 0;                 // cellsX + 2
+    std::vector<uint8_t> cellState; // Per padded cell; what the values mean depends on the algorithm
+    std::vector<Spot> spots;        // Stack or frontier
+    std::vector<uint64_t> edges;    // Kruskal: wall tile and axis (high half), first cell (low half)
+    std::vector<int32_t> parent;    // Kruskal: union-find over cells without the ring
+
+    uint8_t* tiles = nullptr;
+    int width = 0;
+    int cellOffset[4] = {};         // Padded cell index change for each direction
+    int tileOffset[4] = {};         // Tile index change for each direction
+
+    void prepare(uint8_t* tiles, int width, int height, uint8_t inside, uint8_t outside);
+
+    // Padded cell index and tile index of cell (cx, cy)
+    Spot spotAt(int cx, int cy) const;
+
+    void carveBacktracker(uint32_t& random);
+    void carveKruskal(uint32_t& random);
+    void carvePrim(uint32_t& random);
+    void carveWilson(uint32_t& random);
+    void carveGrowingTree(uint32_t& random);
+};
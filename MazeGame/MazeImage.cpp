@@ -0,0 +1,451 @@
+// MazeImage.cpp
+#include "MazeImage.h"
+#include "GameConfig.h"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+    // Tile codes of main.cpp's layout
+    const uint8_t WALL = 0;
+    const uint8_t PATH = 1;
+    const uint8_t ITEM = 2;
+    const uint8_t PLAYER = 3;
+    const uint8_t GOAL = 4;
+    const uint8_t ENEMY = 5;
+
+    // How the pixels of a BMP are stored
+    const uint32_t BMP_RGB = 0;
+    const uint32_t BMP_BITFIELDS = 3;
+
+    const size_t FILE_HEADER_SIZE = 14;
+    const size_t CORE_HEADER_SIZE = 12;     // Very old BMPs: 16-bit size, 3-byte palette colors
+    const size_t INFO_HEADER_SIZE = 40;
+    const size_t LARGEST_HEADER_SIZE = 124;
+
+    // More tiles than this means the file is damaged (or far too big to play)
+    const uint64_t MAX_TILES = uint64_t(1) << 31;
+
+    uint16_t readU16(const uint8_t* bytes) {
+        return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    uint32_t readU32(const uint8_t* bytes) {
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    void writeU16(std::vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+        writeU16(out, static_cast<uint16_t>(value));
+        writeU16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    // Turns colors into tiles. Every color is matched against the palette only the first
+    // time it shows up; drawn mazes have few colors, and the same one many times in a row.
+    class ColorMatcher {
+    public:
+        explicit ColorMatcher(const std::vector<MazeImage::PaletteColor>& palette)
+            : palette(palette) {
+        }
+
+        uint8_t tileOf(uint8_t r, uint8_t g, uint8_t b) {
+            const uint32_t key = (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+            if (key == lastKey) return lastTile;
+            auto found = known.find(key);
+            lastTile = found != known.end() ? found->second : (known[key] = closest(r, g, b));
+            lastKey = key;
+            return lastTile;
+        }
+
+    private:
+        const std::vector<MazeImage::PaletteColor>& palette;
+        std::unordered_map<uint32_t, uint8_t> known;
+        uint32_t lastKey = 0xFFFFFFFFu;     // No 24-bit color looks like this
+        uint8_t lastTile = WALL;
+
+        uint8_t closest(int r, int g, int b) const {
+            int best = -1;
+            uint8_t tile = WALL;
+            for (const MazeImage::PaletteColor& color : palette) {
+                int dr = r - color.r, dg = g - color.g, db = b - color.b;
+                int distance = dr * dr + dg * dg + db * db;
+                if (best < 0 || distance < best) {
+                    best = distance;
+                    tile = color.tile;
+                }
+            }
+            return tile;
+        }
+    };
+
+    // One color channel of a 16- or 32-bit pixel, given by the bits it uses
+    struct Channel {
+        uint32_t mask = 0;
+        int shift = 0;
+        int bits = 0;
+
+        explicit Channel(uint32_t channelMask)
+            : mask(channelMask) {
+            if (mask == 0) return;
+            while (((mask >> shift) & 1) == 0) ++shift;
+            while (shift + bits < 32 && ((mask >> (shift + bits)) & 1)) ++bits;
+        }
+
+        // The channel scaled to 0..255
+        uint8_t get(uint32_t pixel) const {
+            if (bits == 0) return 0;
+            uint32_t value = (pixel & mask) >> shift;
+            if (bits >= 8) return static_cast<uint8_t>(value >> (bits - 8));
+            return static_cast<uint8_t>(value * 255 / ((1u << bits) - 1));
+        }
+    };
+
+    // What the headers of a BMP say
+    struct BmpInfo {
+        int width = 0;
+        int height = 0;
+        bool topDown = false;           // Rows are usually stored bottom row first
+        int bitsPerPixel = 0;
+        uint32_t compression = BMP_RGB;
+        uint32_t dataOffset = 0;
+        uint32_t masks[3] = { 0, 0, 0 };
+        std::vector<uint8_t> paletteRgb;    // Colors of 1-, 4- and 8-bit images, 3 bytes each
+    };
+
+    bool readExactly(SDL_IOStream* io, void* bytes, size_t size) {
+        return size == 0 || SDL_ReadIO(io, bytes, size) == size;
+    }
+
+    bool readHeaders(SDL_IOStream* io, BmpInfo& info, std::string& error) {
+        uint8_t fileHeader[FILE_HEADER_SIZE];
+        uint8_t header[LARGEST_HEADER_SIZE] = {};
+        if (!readExactly(io, fileHeader, FILE_HEADER_SIZE) || fileHeader[0] != 'B' || fileHeader[1] != 'M' ||
+            !readExactly(io, header, 4)) {
+            error = "not a BMP image";
+            return false;
+        }
+        info.dataOffset = readU32(fileHeader + 10);
+
+        const uint32_t headerSize = readU32(header);
+        if (headerSize != CORE_HEADER_SIZE && (headerSize < INFO_HEADER_SIZE || headerSize > LARGEST_HEADER_SIZE)) {
+            error = "unknown kind of BMP image";
+            return false;
+        }
+        if (!readExactly(io, header + 4, headerSize - 4)) {
+            error = "the BMP image is cut off";
+            return false;
+        }
+
+        int64_t height;
+        if (headerSize == CORE_HEADER_SIZE) {
+            info.width = readU16(header + 4);
+            height = readU16(header + 6);
+            info.bitsPerPixel = readU16(header + 10);
+        }
+        else {
+            info.width = static_cast<int32_t>(readU32(header + 4));
+            height = static_cast<int32_t>(readU32(header + 8));
+            info.bitsPerPixel = readU16(header + 14);
+            info.compression = readU32(header + 16);
+        }
+        info.topDown = height < 0;
+        height = height < 0 ? -height : height;
+        if (info.width <= 0 || height <= 0 ||
+            static_cast<uint64_t>(info.width) * static_cast<uint64_t>(height) > MAX_TILES) {
+            error = "the BMP image has an impossible size";
+            return false;
+        }
+        info.height = static_cast<int>(height);
+
+        // Color masks come inside bigger headers, or right after the 40-byte one
+        if (info.compression == BMP_BITFIELDS) {
+            uint8_t maskBytes[12];
+            const uint8_t* masks = header + INFO_HEADER_SIZE;
+            if (headerSize == INFO_HEADER_SIZE) {
+                if (!readExactly(io, maskBytes, sizeof(maskBytes))) {
+                    error = "the BMP image is cut off";
+                    return false;
+                }
+                masks = maskBytes;
+            }
+            for (int i = 0; i < 3; ++i) {
+                info.masks[i] = readU32(masks + i * 4);
+            }
+        }
+        else if (info.bitsPerPixel == 16) {
+            info.masks[0] = 0x7C00;
+            info.masks[1] = 0x03E0;
+            info.masks[2] = 0x001F;
+        }
+        else if (info.bitsPerPixel == 32) {
+            info.masks[0] = 0x00FF0000;
+            info.masks[1] = 0x0000FF00;
+            info.masks[2] = 0x000000FF;
+        }
+
+        // The palette follows the headers, blue first
+        if (info.bitsPerPixel <= 8) {
+            const bool core = headerSize == CORE_HEADER_SIZE;
+            const uint32_t used = core ? 0 : readU32(header + 32);
+            const uint32_t count = std::min<uint32_t>(used != 0 ? used : (1u << info.bitsPerPixel), 256);
+            const size_t entrySize = core ? 3 : 4;
+            std::vector<uint8_t> entries(count * entrySize);
+            if (!readExactly(io, entries.data(), entries.size())) {
+                error = "the BMP image is cut off";
+                return false;
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint8_t* entry = &entries[i * entrySize];
+                info.paletteRgb.insert(info.paletteRgb.end(), { entry[2], entry[1], entry[0] });
+            }
+        }
+        return true;
+    }
+
+    // Read the pixel rows one by one, straight into the grid
+    bool readRows(SDL_IOStream* io, const BmpInfo& info, ColorMatcher& matcher, MazeFile::TileGrid& grid,
+        std::string& error) {
+        const int width = info.width;
+        const size_t stride = (static_cast<size_t>(width) * info.bitsPerPixel + 31) / 32 * 4;
+        std::vector<uint8_t> row(stride);
+
+        // 1-, 4- and 8-bit pixels are palette numbers: each number's tile is worked out once
+        uint8_t numberTiles[256];
+        for (int i = 0; i < 256; ++i) {
+            const size_t at = static_cast<size_t>(i) * 3;
+            numberTiles[i] = at < info.paletteRgb.size()
+                ? matcher.tileOf(info.paletteRgb[at], info.paletteRgb[at + 1], info.paletteRgb[at + 2])
+                : matcher.tileOf(0, 0, 0);
+        }
+        const Channel red(info.masks[0]), green(info.masks[1]), blue(info.masks[2]);
+
+        if (SDL_SeekIO(io, info.dataOffset, SDL_IO_SEEK_SET) < 0) {
+            error = "the BMP image is cut off";
+            return false;
+        }
+        for (int r = 0; r < info.height; ++r) {
+            if (!readExactly(io, row.data(), stride)) {
+                error = "the BMP image is cut off";
+                return false;
+            }
+            const int y = info.topDown ? r : info.height - 1 - r;
+            uint8_t* out = &grid.tiles[static_cast<size_t>(y) * width];
+            const uint8_t* pixel = row.data();
+
+            switch (info.bitsPerPixel) {
+            case 1:
+            case 2:
+            case 4: {
+                const int bits = info.bitsPerPixel;
+                const int perByte = 8 / bits;
+                const int numberMask = (1 << bits) - 1;
+                for (int x = 0; x < width; ++x) {
+                    int shift = 8 - bits * (x % perByte + 1);
+                    out[x] = numberTiles[(pixel[x / perByte] >> shift) & numberMask];
+                }
+                break;
+            }
+            case 8:
+                for (int x = 0; x < width; ++x) {
+                    out[x] = numberTiles[pixel[x]];
+                }
+                break;
+            case 16:
+                for (int x = 0; x < width; ++x, pixel += 2) {
+                    uint32_t value = readU16(pixel);
+                    out[x] = matcher.tileOf(red.get(value), green.get(value), blue.get(value));
+                }
+                break;
+            case 24:
+                for (int x = 0; x < width; ++x, pixel += 3) {
+                    out[x] = matcher.tileOf(pixel[2], pixel[1], pixel[0]);
+                }
+                break;
+            case 32:
+                for (int x = 0; x < width; ++x, pixel += 4) {
+                    uint32_t value = readU32(pixel);
+                    out[x] = matcher.tileOf(red.get(value), green.get(value), blue.get(value));
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Compressed images: SDL decodes the whole image, then it is read like the others
+    bool readWithSdl(SDL_IOStream* io, ColorMatcher& matcher, MazeFile::TileGrid& grid, std::string& error) {
+        SDL_SeekIO(io, 0, SDL_IO_SEEK_SET);
+        SDL_Surface* image = SDL_LoadBMP_IO(io, false);
+        SDL_Surface* rgb = image ? SDL_ConvertSurface(image, SDL_PIXELFORMAT_RGB24) : nullptr;
+        if (image) SDL_DestroySurface(image);
+        if (!rgb) {
+            error = SDL_GetError();
+            return false;
+        }
+
+        grid.width = rgb->w;
+        grid.height = rgb->h;
+        grid.tiles.resize(static_cast<size_t>(rgb->w) * rgb->h);
+        for (int y = 0; y < rgb->h; ++y) {
+            const uint8_t* pixel = static_cast<const uint8_t*>(rgb->pixels) + static_cast<size_t>(y) * rgb->pitch;
+            uint8_t* out = &grid.tiles[static_cast<size_t>(y) * rgb->w];
+            for (int x = 0; x < rgb->w; ++x, pixel += 3) {
+                out[x] = matcher.tileOf(pixel[0], pixel[1], pixel[2]);
+            }
+        }
+        SDL_DestroySurface(rgb);
+        return true;
+    }
+
+    int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+std::vector<MazeImage::PaletteColor> MazeImage::defaultPalette() {
+    auto color = [](const SDL_Color& c, uint8_t tile) { return PaletteColor{ c.r, c.g, c.b, tile }; };
+    return {
+        color(GameConfig::COLOR_WALL, WALL),
+        color(GameConfig::COLOR_PATH, PATH),
+        color(GameConfig::COLOR_ITEM_FILL, ITEM),
+        color(GameConfig::COLOR_PLAYER_FILL, PLAYER),
+        color(GameConfig::COLOR_GOAL_FILL, GOAL),
+        color(GameConfig::COLOR_ENEMY_FILL, ENEMY),
+    };
+}
+
+bool MazeImage::loadPalette(const std::string& path, std::vector<PaletteColor>& palette, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "can't open " + path;
+        return false;
+    }
+
+    palette.clear();
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        line = line.substr(0, line.find(';'));
+        size_t at = line.find_first_not_of(" \t\r");
+        if (at == std::string::npos) continue;
+
+        // The tile, some space, six hex digits and nothing else
+        uint8_t tile = 0;
+        const size_t hex = line.find_first_not_of(" \t", at + 1);
+        bool valid = MazeFile::parseTile(line[at], tile) && hex != std::string::npos && hex > at + 1 &&
+            hex + 6 <= line.size() && line.find_first_not_of(" \t\r", hex + 6) == std::string::npos;
+        uint32_t rgb = 0;
+        for (size_t i = hex; valid && i < hex + 6; ++i) {
+            int digit = hexDigit(line[i]);
+            valid = digit >= 0;
+            rgb = rgb * 16 + static_cast<uint32_t>(digit);
+        }
+        if (!valid) {
+            error = path + " line " + std::to_string(number) + ": expected a tile and a color like \"# 646464\"";
+            return false;
+        }
+        palette.push_back(PaletteColor{ static_cast<uint8_t>(rgb >> 16), static_cast<uint8_t>(rgb >> 8),
+            static_cast<uint8_t>(rgb), tile });
+    }
+    if (palette.empty()) {
+        error = path + " has no colors";
+        return false;
+    }
+    return true;
+}
+
+bool MazeImage::load(const std::string& path, const std::vector<PaletteColor>& palette, MazeFile::TileGrid& grid,
+    std::string& error) {
+    if (palette.empty()) {
+        error = "the palette has no colors";
+        return false;
+    }
+    SDL_IOStream* io = SDL_IOFromFile(path.c_str(), "rb");
+    if (!io) {
+        error = "can't open " + path;
+        return false;
+    }
+
+    ColorMatcher matcher(palette);
+    BmpInfo info;
+    bool ok = readHeaders(io, info, error);
+    const bool streamable = (info.compression == BMP_RGB &&
+        (info.bitsPerPixel == 1 || info.bitsPerPixel == 2 || info.bitsPerPixel == 4 || info.bitsPerPixel == 8 ||
+            info.bitsPerPixel == 16 || info.bitsPerPixel == 24 || info.bitsPerPixel == 32)) ||
+        (info.compression == BMP_BITFIELDS && (info.bitsPerPixel == 16 || info.bitsPerPixel == 32));
+    if (ok && streamable) {
+        grid.width = info.width;
+        grid.height = info.height;
+        grid.tiles.resize(static_cast<size_t>(info.width) * info.height);
+        ok = readRows(io, info, matcher, grid, error);
+    }
+    else if (ok) {
+        ok = readWithSdl(io, matcher, grid, error);
+    }
+    SDL_CloseIO(io);
+
+    if (!ok) error = path + ": " + error;
+    return ok;
+}
+
+bool MazeImage::save(const std::string& path, const MazeFile::TileGrid& grid, const std::vector<PaletteColor>& palette) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    // Blue, green, red of every tile code
+    uint8_t colors[256][3] = {};
+    for (int tile = 0; tile < 256; ++tile) {
+        auto found = std::find_if(palette.begin(), palette.end(), [tile](const PaletteColor& c) { return c.tile == tile; });
+        if (found == palette.end()) continue;
+        colors[tile][0] = found->b;
+        colors[tile][1] = found->g;
+        colors[tile][2] = found->r;
+    }
+
+    const size_t stride = (static_cast<size_t>(grid.width) * 3 + 3) / 4 * 4;
+    const uint64_t imageSize = static_cast<uint64_t>(stride) * grid.height;
+    std::vector<uint8_t> header;
+    header.push_back('B');
+    header.push_back('M');
+    writeU32(header, static_cast<uint32_t>(FILE_HEADER_SIZE + INFO_HEADER_SIZE + imageSize));
+    writeU32(header, 0);
+    writeU32(header, static_cast<uint32_t>(FILE_HEADER_SIZE + INFO_HEADER_SIZE));
+    writeU32(header, static_cast<uint32_t>(INFO_HEADER_SIZE));
+    writeU32(header, static_cast<uint32_t>(grid.width));
+    writeU32(header, static_cast<uint32_t>(grid.height));
+    writeU16(header, 1);     // Planes
+    writeU16(header, 24);    // Bits per pixel
+    writeU32(header, BMP_RGB);
+    writeU32(header, static_cast<uint32_t>(imageSize));
+    writeU32(header, 2835);  // 72 dpi
+    writeU32(header, 2835);
+    writeU32(header, 0);
+    writeU32(header, 0);
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+    // Bottom row first, as BMPs usually are
+    std::vector<uint8_t> row(stride, 0);
+    for (int y = grid.height - 1; y >= 0; --y) {
+        for (int x = 0; x < grid.width; ++x) {
+            std::memcpy(&row[static_cast<size_t>(x) * 3], colors[grid.at(x, y)], 3);
+        }
+        out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(stride));
+    }
+    return static_cast<bool>(out);
+}
+
+bool MazeImage::isBmpFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[2];
+    return in.read(magic, sizeof(magic)) && magic[0] == 'B' && magic[1] == 'M';
+}
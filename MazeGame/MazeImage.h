@@ -0,0 +1,43 @@
+// MazeImage.h
+#pragma once
+#include "MazeFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Imports mazes drawn as BMP images: every pixel becomes one tile, picked by its color.
+//
+// The palette says which color is which tile. The default one uses the game's own colors
+// (GameConfig.h: gray wall, white path, yellow item, green player, blue goal, red enemy),
+// so a maze drawn with them, or a screenshot scaled down to one pixel per tile, comes back
+// as itself. Other colors become the tile with the closest palette color, so black walls,
+// or slightly off colors from a paint program, work too.
+//
+// A palette file has one line per color: a tile (code or symbol, like in MazeFile) and a
+// color as RRGGBB hex, e.g. "# 000000" or "P 00FF00". ';' starts a comment.
+//
+// The image is read through SDL's file streams one pixel row at a time and each row goes
+// straight into the tile grid, so even an 8k x 8k image only needs the grid and one row
+// in memory. Uncompressed BMPs (1, 4, 8, 16, 24 and 32 bits per pixel) are read this way;
+// compressed ones (RLE) are handed to SDL_LoadBMP, which loads the whole image first.
+namespace MazeImage {
+    struct PaletteColor {
+        uint8_t r, g, b;
+        uint8_t tile;
+    };
+
+    std::vector<PaletteColor> defaultPalette();
+
+    // Read a palette file. On failure returns false and explains why in `error`.
+    bool loadPalette(const std::string& path, std::vector<PaletteColor>& palette, std::string& error);
+
+    // Import a BMP image. On failure returns false and explains why in `error`.
+    bool load(const std::string& path, const std::vector<PaletteColor>& palette, MazeFile::TileGrid& grid,
+        std::string& error);
+
+    // Write a maze as a 24-bit BMP, each tile in the first palette color for it
+    bool save(const std::string& path, const MazeFile::TileGrid& grid, const std::vector<PaletteColor>& palette);
+
+    // True if the file starts like a BMP image
+    bool isBmpFile(const std::string& path);
+}
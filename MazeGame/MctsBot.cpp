@@ -0,0 +1,266 @@
+// MctsBot.cpp
+#include "MctsBot.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // How strongly the search tries moves it knows little about (higher = more curious)
+    const double EXPLORATION = 0.2;
+
+    // Quick moves played after leaving the tree, before the game is scored
+    const int ROLLOUT_STEPS = 20;
+
+    // Chance (out of 100) that a quick move heads straight for the goal instead of a random one
+    const uint32_t ROLLOUT_GOAL_CHANCE = 25;
+
+    // Spare moves (time left minus steps to the goal) at which reaching the goal counts as safe
+    const double SAFE_SPARE_STEPS = 40.0;
+
+    // Extra score for winning, so the bot doesn't dawdle once there is nothing left to get
+    const double WIN_BONUS = 0.05;
+
+    // The most there is for standing next to an item (more than WIN_BONUS, so a reachable
+    // item is fetched before finishing)
+    const double ITEM_PULL = 0.1;
+
+    // How far (in steps) the search for the nearest item looks
+    const int ITEM_SEARCH_RADIUS = 60;
+
+    // Nodes a single tree may grow to; after that it only refines what it has
+    const size_t MAX_NODES = 1 << 18;
+
+    // How many tries run between looks at the clock
+    const int CLOCK_CHECK_INTERVAL = 32;
+
+    uint32_t nextSeed(uint32_t& seed) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+}
+
+MctsBot::MctsBot(const GameSim::Level& level, int threadCount)
+    : level(level) {
+    farthestFromGoal = std::max(1, *std::max_element(level.goalDistance.begin(), level.goalDistance.end()));
+    int threads = threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    trees.resize(threads);
+}
+
+int MctsBot::chooseMove(const GameSim::State& state, const Budget& budget) {
+    lastIterations = 0;
+    if (state.over) return GameSim::STAY;
+
+    // Every thread gets an equal share of the tries, and its own random seeds
+    const int threads = static_cast<int>(trees.size());
+    Budget share = budget;
+    if (budget.iterations > 0) share.iterations = (budget.iterations + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(&MctsBot::search, this, std::ref(trees[t]), std::cref(state), std::cref(share),
+            state.random ^ (0x9E3779B9u * (t + 1)));
+    }
+    search(trees[0], state, share, state.random ^ 0x9E3779B9u);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // The most tried move wins; the average score breaks ties
+    int visits[5] = {};
+    double values[5] = {};
+    for (const Tree& tree : trees) {
+        lastIterations += tree.iterations;
+        for (int i = 0; i < 5; ++i) {
+            visits[i] += tree.rootVisits[i];
+            values[i] += tree.rootValues[i];
+        }
+    }
+
+    int best = -1;
+    for (int i = 0; i < 5; ++i) {
+        if (visits[i] == 0) continue;
+        if (best < 0 || visits[i] > visits[best] ||
+            (visits[i] == visits[best] && values[i] / visits[i] > values[best] / visits[best])) {
+            best = i;
+        }
+    }
+    return best < 0 ? GameSim::STAY : best - 1;
+}
+
+void MctsBot::search(Tree& tree, const GameSim::State& root, const Budget& budget, uint32_t seed) const {
+    const Clock::time_point start = Clock::now();
+    const auto timeLimit = std::chrono::milliseconds(budget.timeMs);
+    if (seed == 0) seed = 1;
+
+    tree.nodes.clear();
+    tree.nodes.push_back(Node());
+    tree.iterations = 0;
+
+    while (true) {
+        if (budget.iterations > 0 && tree.iterations >= budget.iterations) break;
+        if (budget.timeMs > 0 && tree.iterations % CLOCK_CHECK_INTERVAL == 0 && Clock::now() - start >= timeLimit) break;
+        if (budget.iterations <= 0 && budget.timeMs <= 0) break;
+
+        // The copy every try starts from; a new seed makes enemies and items move differently
+        GameSim::State state = root;
+        state.random = nextSeed(seed) | 1;
+
+        tree.path.clear();
+        tree.path.push_back(0);
+        int node = 0;
+
+        // 1. Walk down the tree, picking the best looking child each time
+        while (tree.nodes[node].childCount > 0 && !state.over) {
+            const Node& parent = tree.nodes[node];
+            int chosen = -1;
+            double bestScore = -1.0;
+            const double logVisits = std::log(static_cast<double>(std::max(1, parent.visits)));
+            for (int c = parent.firstChild; c < parent.firstChild + parent.childCount; ++c) {
+                const Node& child = tree.nodes[c];
+                if (child.visits == 0) {
+                    chosen = c;     // Every move is tried once before any is tried twice
+                    break;
+                }
+                double score = child.totalValue / child.visits + EXPLORATION * std::sqrt(logVisits / child.visits);
+                if (score > bestScore) {
+                    bestScore = score;
+                    chosen = c;
+                }
+            }
+            node = chosen;
+            GameSim::step(level, state, tree.nodes[node].move, tree.scratch);
+            tree.path.push_back(node);
+        }
+
+        // 2. Add the moves possible from here once the node has been reached before
+        if (!state.over && (node == 0 || tree.nodes[node].visits > 0) && tree.nodes.size() + 5 <= MAX_NODES) {
+            int firstChild = static_cast<int>(tree.nodes.size());
+            for (int move = GameSim::STAY; move < 4; ++move) {
+                if (move != GameSim::STAY &&
+                    !level.isWalkable(state.playerX + GameSim::STEP_X[move], state.playerY + GameSim::STEP_Y[move])) {
+                    continue;
+                }
+                Node child;
+                child.move = move;
+                tree.nodes.push_back(child);
+            }
+            tree.nodes[node].firstChild = firstChild;
+            tree.nodes[node].childCount = static_cast<int>(tree.nodes.size()) - firstChild;
+
+            node = firstChild + static_cast<int>(GameSim::nextRandom(state) % tree.nodes[node].childCount);
+            GameSim::step(level, state, tree.nodes[node].move, tree.scratch);
+            tree.path.push_back(node);
+        }
+
+        // 3. Play on quickly and score the result
+        double value = state.over ? evaluate(state, root, tree) : rollout(state, root, tree);
+
+        // 4. Count the result for every node on the way down
+        for (int n : tree.path) {
+            ++tree.nodes[n].visits;
+            tree.nodes[n].totalValue += value;
+        }
+        ++tree.iterations;
+    }
+
+    const Node& top = tree.nodes[0];
+    for (int i = 0; i < 5; ++i) {
+        tree.rootVisits[i] = 0;
+        tree.rootValues[i] = 0.0;
+    }
+    for (int c = top.firstChild; c < top.firstChild + top.childCount; ++c) {
+        tree.rootVisits[tree.nodes[c].move + 1] = tree.nodes[c].visits;
+        tree.rootValues[tree.nodes[c].move + 1] = tree.nodes[c].totalValue;
+    }
+}
+
+double MctsBot::rollout(GameSim::State& state, const GameSim::State& root, Tree& tree) const {
+    for (int i = 0; i < ROLLOUT_STEPS && !state.over; ++i) {
+        int move = GameSim::STAY;
+        uint32_t roll = GameSim::nextRandom(state);
+        if (roll % 100 < ROLLOUT_GOAL_CHANCE) {
+            move = GameSim::stepDownhill(level, level.goalDistance, state.playerX, state.playerY);
+        }
+        else {
+            move = static_cast<int>((roll >> 8) % 4);
+        }
+        GameSim::step(level, state, move, tree.scratch);
+    }
+    return evaluate(state, root, tree);
+}
+
+double MctsBot::evaluate(const GameSim::State& state, const GameSim::State& root, Tree& tree) const {
+    if (state.over && !state.won) return 0.0;
+
+    // Share of the items still out there at the start of the search that were picked up
+    double items = root.itemCount > 0
+        ? static_cast<double>(state.score - root.score) / (root.itemCount * GameConfig::ITEM_SCORE) : 0.0;
+
+    double value = 0.45 * items - 0.1 * (root.lives - state.lives);
+    if (state.won) return std::max(0.01, value + 0.5 + WIN_BONUS);
+
+    // Not finished: how safely the goal can still be reached in time. Moving towards the goal
+    // keeps this the same as time runs, moving away loses it twice as fast.
+    int goalDistance = level.goalDistance[state.playerY * level.width + state.playerX];
+    if (goalDistance < 0) return 0.01;
+    double stepsLeft = static_cast<double>(state.timeRemaining) * GameConfig::TIME_DECREASE_INTERVAL / level.rules.playerStepInterval;
+    double winChance = std::min(1.0, std::max(0.0, (stepsLeft - goalDistance) / SAFE_SPARE_STEPS));
+    value += 0.5 * winChance;
+
+    // A little extra for being close to the next item, so items too far away for the tree
+    // to find still pull the player towards them. With no item nearby the goal pulls instead,
+    // a bit less than winning is worth, so the bot finishes instead of waiting for the clock.
+    int nearest = state.itemCount > 0 ? nearestItemDistance(state, tree) : -1;
+    if (nearest >= 0) {
+        value += ITEM_PULL * (1.0 - static_cast<double>(nearest) / ITEM_SEARCH_RADIUS);
+    }
+    else {
+        value += WIN_BONUS * (1.0 - static_cast<double>(goalDistance) / (farthestFromGoal + 1));
+    }
+    return std::max(0.01, value);
+}
+
+int MctsBot::nearestItemDistance(const GameSim::State& state, Tree& tree) const {
+    // Breadth-first search that stops at the first item or after ITEM_SEARCH_RADIUS steps.
+    // Only the tiles it touched are reset afterwards, so big levels cost no more than small ones.
+    std::vector<int>& distance = tree.itemDistance;
+    std::vector<int>& queue = tree.itemQueue;
+    if (distance.size() != level.walkable.size()) distance.assign(level.walkable.size(), -1);
+    queue.clear();
+
+    int start = state.playerY * level.width + state.playerX;
+    distance[start] = 0;
+    queue.push_back(start);
+    int found = -1;
+    for (size_t head = 0; head < queue.size() && found < 0; ++head) {
+        int tile = queue[head];
+        int x = tile % level.width;
+        int y = tile / level.width;
+        for (int i = 0; i < state.itemCount; ++i) {
+            if (state.items[i].x == x && state.items[i].y == y) found = distance[tile];
+        }
+        if (distance[tile] >= ITEM_SEARCH_RADIUS) continue;
+
+        for (int dir = 0; dir < 4; ++dir) {
+            int nx = x + GameSim::STEP_X[dir];
+            int ny = y + GameSim::STEP_Y[dir];
+            if (!level.isWalkable(nx, ny)) continue;
+            int next = ny * level.width + nx;
+            if (distance[next] >= 0) continue;
+            distance[next] = distance[tile] + 1;
+            queue.push_back(next);
+        }
+    }
+
+    for (int tile : queue) {
+        distance[tile] = -1;
+    }
+    return found;
+}
@@ -0,0 +1,70 @@
+// MctsBot.h
+#pragma once
+#include "GameSim.h"
+#include <SDL3/SDL.h>
+#include <vector>
+
+// A bot that picks each move with Monte Carlo tree search (MCTS).
+//
+// For every move it copies the current GameSim::State over and over, tries a sequence
+// of moves on the copy (first the promising ones the tree already knows about, then
+// quick semi-random ones), and scores how the game ended up. Moves that lead to good
+// endings more often get tried more, and the move tried most often is played.
+//
+// Enemies and items move randomly, so every try uses a different random seed and the
+// tree stores move sequences, not game states ("open loop"). Each thread grows its own
+// tree from the same starting state and the visit counts are added up at the end.
+class MctsBot {
+public:
+    // How long to think about one move. The search stops at whichever limit comes first;
+    // 0 means no limit (at least one of the two must be set).
+    struct Budget {
+        Uint64 timeMs = 20;
+        int iterations = 0;
+    };
+
+    // The level must stay alive (and unchanged) as long as the bot is used.
+    // threadCount 0 = one thread per core.
+    explicit MctsBot(const GameSim::Level& level, int threadCount = 0);
+
+    // Best move for `state`: a direction (0-3, like the Direction enum) or GameSim::STAY
+    int chooseMove(const GameSim::State& state, const Budget& budget);
+
+    // Tries (state copies played out) used by the last chooseMove, over all threads
+    int getLastIterations() const { return lastIterations; }
+
+private:
+    struct Node {
+        int firstChild = -1;    // Children are stored next to each other
+        int childCount = 0;
+        int move = GameSim::STAY;
+        int visits = 0;
+        double totalValue = 0.0;
+    };
+
+    // Everything one search thread needs, so threads never share anything while searching
+    struct Tree {
+        std::vector<Node> nodes;
+        std::vector<int> path;  // Nodes visited by the current try
+        GameSim::Scratch scratch;
+        std::vector<int> itemDistance;  // -1 everywhere between item searches
+        std::vector<int> itemQueue;
+        double rootValues[5] = {};
+        int rootVisits[5] = {};
+        int iterations = 0;
+    };
+
+    const GameSim::Level& level;
+    std::vector<Tree> trees;
+    int lastIterations = 0;
+    int farthestFromGoal = 1;   // Longest way to the goal from anywhere in the level
+
+    void search(Tree& tree, const GameSim::State& root, const Budget& budget, uint32_t seed) const;
+
+    // Play quick moves from `state` and score how it went (0 = lost ... 1 = won with every item)
+    double rollout(GameSim::State& state, const GameSim::State& root, Tree& tree) const;
+    double evaluate(const GameSim::State& state, const GameSim::State& root, Tree& tree) const;
+
+    // Steps to the nearest item, or -1 if none is close
+    int nearestItemDistance(const GameSim::State& state, Tree& tree) const;
+};
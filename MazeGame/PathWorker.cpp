@@ -0,0 +1,128 @@
+// PathWorker.cpp
+#include "PathWorker.h"
+#include <algorithm>
+
+namespace {
+    const int STEP_X[4] = { 0, 1, 0, -1 };
+    const int STEP_Y[4] = { -1, 0, 1, 0 };
+
+    // Marks the start tile in cameFrom (it wasn't entered from anywhere)
+    const uint8_t START = 5;
+
+    // How many tiles the search visits between checks for a newer request
+    const int CHECK_INTERVAL = 4096;
+}
+
+PathWorker::~PathWorker() {
+    stop();
+}
+
+unsigned PathWorker::request(std::shared_ptr<const BitGrid> walk, int startX, int startY, int goalX, int goalY) {
+    unsigned generation = ++newestGeneration;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return generation;
+        if (hasPending) ++discarded;    // Replaced before it even started
+
+        pending = { generation, std::move(walk), startX, startY, goalX, goalY };
+        hasPending = true;
+
+        // The thread is only started once there is something to do
+        if (!thread.joinable()) thread = std::thread(&PathWorker::run, this);
+    }
+    wake.notify_one();
+    return generation;
+}
+
+bool PathWorker::takeResult(std::vector<std::pair<int, int>>& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasResult) return false;
+    hasResult = false;
+
+    if (resultGeneration != newestGeneration) {
+        ++discarded;
+        return false;
+    }
+    path.swap(result);
+    return true;
+}
+
+void PathWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (thread.joinable()) thread.join();
+}
+
+void PathWorker::run() {
+    std::vector<std::pair<int, int>> path;
+    while (true) {
+        Request job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || hasPending; });
+            if (stopping) return;
+            job = std::move(pending);
+            hasPending = false;
+        }
+
+        if (!search(job, path)) {
+            ++discarded;
+            continue;
+        }
+
+        // The lock is only held to swap the finished path in, never during a search
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hasResult) ++discarded;     // The previous result was never picked up
+        result.swap(path);
+        resultGeneration = job.generation;
+        hasResult = true;
+    }
+}
+
+bool PathWorker::search(const Request& job, std::vector<std::pair<int, int>>& path) {
+    const BitGrid& walk = *job.walk;
+    path.clear();
+    if (!walk.get(job.startX, job.startY) || !walk.get(job.goalX, job.goalY)) return true;
+
+    const int width = walk.width;
+    const int start = job.startY * width + job.startX;
+    const int goal = job.goalY * width + job.goalX;
+    cameFrom.assign(static_cast<size_t>(width) * walk.height, 0);
+    queue.clear();
+    queue.push_back(start);
+    cameFrom[start] = START;
+
+    bool found = start == goal;
+    for (size_t head = 0; head < queue.size() && !found; ++head) {
+        if (head % CHECK_INTERVAL == 0 && newestGeneration != job.generation) return false;
+
+        int tile = queue[head];
+        int x = tile % width;
+        int y = tile / width;
+        for (int dir = 0; dir < 4; ++dir) {
+            int nx = x + STEP_X[dir];
+            int ny = y + STEP_Y[dir];
+            if (!walk.get(nx, ny)) continue;
+
+            int next = ny * width + nx;
+            if (cameFrom[next]) continue;
+            cameFrom[next] = static_cast<uint8_t>(dir + 1);
+            queue.push_back(next);
+            if (next == goal) found = true;
+        }
+    }
+    if (!found) return true;
+
+    // Walk back from the goal, then flip the list so it starts at the start
+    for (int tile = goal; ; ) {
+        path.push_back({ tile % width, tile / width });
+        if (cameFrom[tile] == START) break;
+        int dir = cameFrom[tile] - 1;
+        tile -= STEP_Y[dir] * width + STEP_X[dir];
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
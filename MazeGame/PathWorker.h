@@ -0,0 +1,71 @@
+// PathWorker.h
+#pragma once
+#include "BitGrid.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Finds shortest paths on a background thread so the caller never waits for a search.
+//
+// Every request gets a generation number. Only the newest request matters: when a
+// new one comes in, an older search that is still running gives up, and results
+// for older generations are thrown away instead of being handed out.
+class PathWorker {
+public:
+    PathWorker() = default;
+    ~PathWorker();
+
+    PathWorker(const PathWorker&) = delete;
+    PathWorker& operator=(const PathWorker&) = delete;
+
+    // Ask for the path from (startX, startY) to (goalX, goalY) on `walk`.
+    // Returns right away with the generation number of the request.
+    unsigned request(std::shared_ptr<const BitGrid> walk, int startX, int startY, int goalX, int goalY);
+
+    // If the answer to the newest request is ready, move it into `path` (start and goal
+    // included, empty if there is no way through) and return true. Never waits.
+    bool takeResult(std::vector<std::pair<int, int>>& path);
+
+    // Stop the background thread (also done by the destructor)
+    void stop();
+
+    // Searches that were given up or whose result was thrown away because a newer request came in
+    int getDiscardedCount() const { return discarded; }
+
+private:
+    struct Request {
+        unsigned generation = 0;
+        std::shared_ptr<const BitGrid> walk;
+        int startX = 0, startY = 0;
+        int goalX = 0, goalY = 0;
+    };
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    // Guarded by `mutex`
+    Request pending;
+    bool hasPending = false;
+    bool stopping = false;
+    std::vector<std::pair<int, int>> result;
+    unsigned resultGeneration = 0;
+    bool hasResult = false;
+
+    std::atomic<unsigned> newestGeneration{ 0 };
+    std::atomic<int> discarded{ 0 };
+
+    // Only used by the background thread
+    std::vector<uint8_t> cameFrom;  // Direction + 1 the search entered each tile from, 0 = not reached
+    std::vector<int> queue;
+
+    void run();
+
+    // Breadth-first search; returns false if a newer request made it pointless
+    bool search(const Request& job, std::vector<std::pair<int, int>>& path);
+};
@@ -2,26 +2,37 @@
 #include "Player.h"
 #include "GameConfig.h"
 #include "Maze.h"
+#include "GameSession.h"
 
-namespace {
+struct Player::SessionState {
     // You can change the shape and colors here!
-    Entity player(1, 1,
+    Entity player{ 1, 1,
         ShapeType::CIRCLE,
         GameConfig::COLOR_PLAYER_FILL,
-        GameConfig::COLOR_PLAYER_OUTLINE);
+        GameConfig::COLOR_PLAYER_OUTLINE };
+};
+
+namespace {
+    Entity& player() {
+        return GameSession::current().player->player;
+    }
+}
+
+std::shared_ptr<Player::SessionState> Player::createSessionState() {
+    return std::make_shared<SessionState>();
 }
 
 void Player::setPosition(int x, int y) {
-    player.setPosition(x, y);
+    player().setPosition(x, y);
 }
 
 void Player::move(int dx, int dy) {
-    int newX = player.getX() + dx;
-    int newY = player.getY() + dy;
+    int newX = player().getX() + dx;
+    int newY = player().getY() + dy;
 
     // Only move if the target tile is walkable
     if (Maze::isWalkable(newX, newY)) {
-        player.setPosition(newX, newY);
+        player().setPosition(newX, newY);
     }
 }
 
@@ -34,10 +45,10 @@ void Player::update() {
 void Player::render(bool invulnerable) {
     // Blinking effect when invulnerable
     if (!invulnerable || (SDL_GetTicks() / 100) % 2 == 0) {
-        player.render();
+        player().render();
     }
 }
 
-int Player::getX() { return player.getX(); }
-int Player::getY() { return player.getY(); }
+int Player::getX() { return player().getX(); }
+int Player::getY() { return player().getY(); }
 
@@ -1,6 +1,7 @@
 // Player.h
 #pragma once
 #include "Entity.h"
+#include <memory>
 
 namespace Player {
 	void setPosition(int x, int y);
@@ -10,4 +11,8 @@ namespace Player {
 
 	int getX();
 	int getY();
+
+	// What this module keeps for one game (see GameSession.h)
+	struct SessionState;
+	std::shared_ptr<SessionState> createSessionState();
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+// Playtest.cpp
+#include "Playtest.h"
+#include "GameConfig.h"
+#include "MctsBot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace {
+    // A collector heads for the goal once it has less spare time than this
+    const Uint64 COLLECTOR_SAFETY_MARGIN = 5000;
+
+    const char* BOT_NAMES[4] = { "runner", "collector", "wanderer", "mcts" };
+
+    struct Outcome {
+        bool won;
+        int score;
+        Uint64 timeMs;
+    };
+
+    Outcome playOne(const GameSim::Level& level, Playtest::Bot bot, Uint64 mctsMoveTime, int mctsThreads, unsigned seed) {
+        GameSim::State state = GameSim::newGame(level, seed);
+        GameSim::Scratch scratch;
+        std::vector<int> distance;
+        std::vector<int> itemDistance;
+        std::vector<int> queue;
+
+        std::unique_ptr<MctsBot> mcts;
+        MctsBot::Budget budget;
+        budget.timeMs = mctsMoveTime;
+        if (bot == Playtest::Bot::MCTS) mcts = std::make_unique<MctsBot>(level, mctsThreads);
+
+        while (!state.over) {
+            const int px = state.playerX;
+            const int py = state.playerY;
+            int dir = GameSim::STAY;
+
+            if (bot == Playtest::Bot::RUNNER) {
+                dir = GameSim::stepDownhill(level, level.goalDistance, px, py);
+            }
+            else if (bot == Playtest::Bot::COLLECTOR) {
+                // Nearest item, if there is time to fetch it and still make it to the goal
+                GameSim::distancesFrom(level, py * level.width + px, distance, queue);
+                int best = -1;
+                for (int i = 0; i < state.itemCount; ++i) {
+                    int d = distance[state.items[i].y * level.width + state.items[i].x];
+                    if (d >= 0 && (best < 0 || d < distance[state.items[best].y * level.width + state.items[best].x])) best = i;
+                }
+                if (best >= 0) {
+                    int itemTile = state.items[best].y * level.width + state.items[best].x;
+                    Uint64 steps = distance[itemTile] + std::max(0, level.goalDistance[itemTile]);
+                    Uint64 needed = steps * level.rules.playerStepInterval + COLLECTOR_SAFETY_MARGIN;
+                    if (needed < static_cast<Uint64>(state.timeRemaining) * GameConfig::TIME_DECREASE_INTERVAL) {
+                        GameSim::distancesFrom(level, itemTile, itemDistance, queue);
+                        dir = GameSim::stepDownhill(level, itemDistance, px, py);
+                    }
+                }
+                if (dir == GameSim::STAY) dir = GameSim::stepDownhill(level, level.goalDistance, px, py);
+            }
+            else if (bot == Playtest::Bot::MCTS) {
+                dir = mcts->chooseMove(state, budget);
+            }
+            else {
+                dir = static_cast<int>(GameSim::nextRandom(state) % 4);
+            }
+
+            GameSim::step(level, state, dir, scratch);
+        }
+        return { state.won, state.score, state.now };
+    }
+
+    // Value at `percent` of a sorted list (nearest rank)
+    template <typename T>
+    T percentile(const std::vector<T>& sorted, int percent) {
+        if (sorted.empty()) return T();
+        return sorted[(sorted.size() - 1) * percent / 100];
+    }
+
+    Playtest::Summary summarize(const std::vector<Outcome>& outcomes) {
+        Playtest::Summary summary;
+        summary.games = static_cast<int>(outcomes.size());
+
+        std::vector<int> scores;
+        std::vector<double> winTimes;
+        long long scoreSum = 0;
+        for (const Outcome& outcome : outcomes) {
+            scores.push_back(outcome.score);
+            scoreSum += outcome.score;
+            if (outcome.won) {
+                ++summary.wins;
+                winTimes.push_back(outcome.timeMs / 1000.0);
+            }
+        }
+        std::sort(scores.begin(), scores.end());
+        std::sort(winTimes.begin(), winTimes.end());
+
+        summary.averageScore = outcomes.empty() ? 0.0 : static_cast<double>(scoreSum) / outcomes.size();
+        const int scorePoints[3] = { 10, 50, 90 };
+        const int timePoints[3] = { 50, 90, 99 };
+        for (int i = 0; i < 3; ++i) {
+            summary.scorePercentiles[i] = percentile(scores, scorePoints[i]);
+            summary.winTimePercentiles[i] = percentile(winTimes, timePoints[i]);
+        }
+        return summary;
+    }
+
+    double winRate(const Playtest::Summary& summary) {
+        return summary.games > 0 ? summary.wins * 100.0 / summary.games : 0.0;
+    }
+}
+
+Playtest::Summary Playtest::play(const std::vector<std::vector<int>>& layout, Bot bot, const Settings& settings,
+    int games, int threadCount, Uint64 mctsMoveTime) {
+    GameSim::Level level = GameSim::makeLevel(layout, settings);
+    std::vector<Outcome> outcomes(std::max(0, games));
+    int threads = threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // The MCTS bot spreads its search over the threads, so its games are played one after another
+    int mctsThreads = threads;
+    if (bot == Bot::MCTS) threads = 1;
+
+    // Game i always uses seed i, whichever thread plays it
+    auto playRange = [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            outcomes[i] = playOne(level, bot, mctsMoveTime, mctsThreads, static_cast<unsigned>(i) * 2654435761u + 1);
+        }
+    };
+
+    threads = std::max(1, std::min(threads, games));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(playRange, games * t / threads, games * (t + 1) / threads);
+    }
+    playRange(0, games / threads);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return summarize(outcomes);
+}
+
+void Playtest::run(const std::vector<std::vector<int>>& layout, int games, bool sweep) {
+    const Bot bots[3] = { Bot::RUNNER, Bot::COLLECTOR, Bot::WANDERER };
+    printf("Playtest: %d games per bot and setting, %u threads\n", games, std::thread::hardware_concurrency());
+
+    if (!sweep) {
+        Settings settings;
+        printf("  enemies %d, enemy step %llu ms, lives %d, time %d s\n", settings.maxEnemies,
+            static_cast<unsigned long long>(settings.enemyMoveInterval), settings.playerLives, settings.timeLimit);
+
+        for (int b = 0; b < 3; ++b) {
+            Summary s = play(layout, bots[b], settings, games);
+            printf("    %-9s win %5.1f%%  score avg %5.1f (p10 %3d, p50 %3d, p90 %3d)  "
+                "time to goal p50 %5.1f s, p90 %5.1f s, p99 %5.1f s\n",
+                BOT_NAMES[b], winRate(s), s.averageScore, s.scorePercentiles[0], s.scorePercentiles[1],
+                s.scorePercentiles[2], s.winTimePercentiles[0], s.winTimePercentiles[1], s.winTimePercentiles[2]);
+        }
+        return;
+    }
+
+    // One line per grid point: win rate, average score and median time to goal for each bot
+    const Uint64 enemyIntervals[] = { 250, 500, 1000 };
+    const int enemyCounts[] = { 1, 3, 6 };
+    const int livesOptions[] = { 1, 3, 5 };
+    const int timeLimits[] = { 60, 100 };
+
+    printf("  %-26s", "");
+    for (int b = 0; b < 3; ++b) {
+        printf(" | %-19s", BOT_NAMES[b]);
+    }
+    printf("\n  %-6s %-7s %-5s %-4s", "step", "enemies", "lives", "time");
+    for (int b = 0; b < 3; ++b) {
+        printf(" | %6s %5s %6s", "win", "score", "p50 s");
+    }
+    printf("\n");
+
+    for (Uint64 interval : enemyIntervals) {
+        for (int enemies : enemyCounts) {
+            for (int lives : livesOptions) {
+                for (int timeLimit : timeLimits) {
+                    Settings settings;
+                    settings.enemyMoveInterval = interval;
+                    settings.maxEnemies = enemies;
+                    settings.playerLives = lives;
+                    settings.timeLimit = timeLimit;
+
+                    printf("  %-6llu %-7d %-5d %-4d", static_cast<unsigned long long>(interval), enemies, lives, timeLimit);
+                    for (int b = 0; b < 3; ++b) {
+                        Summary s = play(layout, bots[b], settings, games);
+                        printf(" | %5.1f%% %5.1f %6.1f", winRate(s), s.averageScore, s.winTimePercentiles[0]);
+                    }
+                    printf("\n");
+                }
+            }
+        }
+    }
+}
+
+void Playtest::runMcts(const std::vector<std::vector<int>>& layout, int games, Uint64 moveTimeMs) {
+    Settings settings;
+    printf("Playtest: %d games, MCTS with %llu ms per move on %u threads\n", games,
+        static_cast<unsigned long long>(moveTimeMs), std::thread::hardware_concurrency());
+    printf("  enemies %d, enemy step %llu ms, lives %d, time %d s\n", settings.maxEnemies,
+        static_cast<unsigned long long>(settings.enemyMoveInterval), settings.playerLives, settings.timeLimit);
+
+    // The scripted bots play the same games, for comparison
+    const Bot bots[3] = { Bot::RUNNER, Bot::COLLECTOR, Bot::MCTS };
+    for (Bot bot : bots) {
+        auto start = std::chrono::steady_clock::now();
+        Summary s = play(layout, bot, settings, games, 0, moveTimeMs);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("    %-9s win %5.1f%%  score avg %5.1f (p10 %3d, p50 %3d, p90 %3d)  "
+            "time to goal p50 %5.1f s  (%.1f s to play)\n",
+            BOT_NAMES[static_cast<int>(bot)], winRate(s), s.averageScore, s.scorePercentiles[0],
+            s.scorePercentiles[1], s.scorePercentiles[2], s.winTimePercentiles[0], seconds);
+    }
+}
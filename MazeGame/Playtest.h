@@ -0,0 +1,45 @@
+// Playtest.h
+#pragma once
+#include "GameSim.h"
+#include <SDL3/SDL.h>
+#include <vector>
+
+// Plays the game without a window, many times over, with simple scripted players
+// ("bots"), to see how hard a layout is with different settings.
+//
+// The games are played with GameSim, which follows the same rules as the real game:
+// the clock, lives, moving items, wandering (or chasing) enemies, the hit cooldown and
+// the win/lose checks. Each game gets its own random seed, so the results are the
+// same for any number of threads.
+namespace Playtest {
+    enum class Bot {
+        RUNNER,     // Takes the shortest way to the goal and ignores everything else
+        COLLECTOR,  // Grabs the nearest item until time gets short, then heads for the goal
+        WANDERER,   // Steps in a random direction every move
+        MCTS        // Plans every move by playing out many possible futures (see MctsBot)
+    };
+
+    // The settings a playthrough can be run with (defaults come from GameConfig)
+    using Settings = GameSim::Rules;
+
+    struct Summary {
+        int games = 0;
+        int wins = 0;
+        double averageScore = 0.0;
+        int scorePercentiles[3] = {};           // 10th, 50th and 90th percentile
+        double winTimePercentiles[3] = {};      // Seconds to reach the goal: 50th, 90th, 99th (wins only)
+    };
+
+    // Play `games` games of `layout` (same format as Maze::loadLayout) with one bot,
+    // spread over `threadCount` threads (0 = one per core). The MCTS bot thinks for
+    // `mctsMoveTime` ms per move and uses the threads for its search instead.
+    Summary play(const std::vector<std::vector<int>>& layout, Bot bot, const Settings& settings,
+        int games, int threadCount = 0, Uint64 mctsMoveTime = 20);
+
+    // Console tool: print a summary for every bot, either for the settings in GameConfig
+    // or, with `sweep`, for a grid of enemy speeds, enemy counts, lives and time limits
+    void run(const std::vector<std::vector<int>>& layout, int games, bool sweep);
+
+    // Console tool: the MCTS bot next to the runner and collector, with the default settings
+    void runMcts(const std::vector<std::vector<int>>& layout, int games, Uint64 moveTimeMs);
+}
@@ -0,0 +1,163 @@
+// TiledMazeGenerator.cpp
+#include "TiledMazeGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+    const uint8_t PATH = 1;
+
+    // Random numbers worked out from the seed and two more numbers alone
+    uint32_t mixSeed(uint32_t seed, uint32_t a, uint32_t b) {
+        uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ (static_cast<uint64_t>(a) << 16) ^ (static_cast<uint64_t>(b) * 0xD6E8FEB86659FD93ull);
+        z += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        uint32_t state = static_cast<uint32_t>(z);
+        return state != 0 ? state : 1;
+    }
+
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // How the cells are split up
+    struct Layout {
+        int cellsX, cellsY;
+        int blockCells;
+        int blocksX, blocksY;
+
+        int firstCellX(int bx) const { return bx * blockCells; }
+        int firstCellY(int by) const { return by * blockCells; }
+        int blockWidth(int bx) const { return std::min(blockCells, cellsX - bx * blockCells); }
+        int blockHeight(int by) const { return std::min(blockCells, cellsY - by * blockCells); }
+    };
+
+    int findBlock(std::vector<int>& parent, int block) {
+        while (parent[block] != block) {
+            parent[block] = parent[parent[block]];
+            block = parent[block];
+        }
+        return block;
+    }
+
+    // Carve one block into `scratch`, then copy it over. Each block writes its own cells,
+    // the walls between them and its left and top wall; the last blocks also write the
+    // right and bottom wall. No two threads ever write the same byte.
+    void carveBlock(MazeGenerator::Algorithm algorithm, uint8_t* tiles, int width, uint32_t seed, const Layout& layout,
+        int block, MazeGenerator& generator, std::vector<uint8_t>& scratch) {
+        const int bx = block % layout.blocksX;
+        const int by = block / layout.blocksX;
+        const int blockWidth = layout.blockWidth(bx) * 2 + 1;
+        const int blockHeight = layout.blockHeight(by) * 2 + 1;
+        scratch.resize(static_cast<size_t>(blockWidth) * blockHeight);
+        generator.carve(algorithm, scratch.data(), blockWidth, blockHeight,
+            mixSeed(seed, static_cast<uint32_t>(bx), static_cast<uint32_t>(by)));
+
+        const int copyWidth = blockWidth - (bx + 1 < layout.blocksX ? 1 : 0);
+        const int copyHeight = blockHeight - (by + 1 < layout.blocksY ? 1 : 0);
+        uint8_t* target = tiles + static_cast<size_t>(layout.firstCellY(by)) * 2 * width + layout.firstCellX(bx) * 2;
+        for (int y = 0; y < copyHeight; ++y) {
+            std::memcpy(target + static_cast<size_t>(y) * width, &scratch[static_cast<size_t>(y) * blockWidth], copyWidth);
+        }
+    }
+
+    // Join the blocks along a random spanning tree, one opening per joined pair
+    void stitchSeams(uint8_t* tiles, int width, uint32_t seed, const Layout& layout) {
+        const int blockCount = layout.blocksX * layout.blocksY;
+
+        // Every pair of neighboring blocks as (first block, 0 = right / 1 = down)
+        std::vector<std::pair<int, int>> seams;
+        for (int block = 0; block < blockCount; ++block) {
+            if (block % layout.blocksX + 1 < layout.blocksX) seams.push_back({ block, 0 });
+            if (block / layout.blocksX + 1 < layout.blocksY) seams.push_back({ block, 1 });
+        }
+
+        uint32_t random = mixSeed(seed, 0xFFFFFFFFu, 0xFFFFFFFFu);
+        for (size_t i = seams.size(); i > 1; --i) {
+            std::swap(seams[i - 1], seams[nextRandom(random) % i]);
+        }
+
+        std::vector<int> parent(blockCount);
+        std::iota(parent.begin(), parent.end(), 0);
+        for (const auto& seam : seams) {
+            const int block = seam.first;
+            const int other = block + (seam.second == 0 ? 1 : layout.blocksX);
+            int a = findBlock(parent, block);
+            int b = findBlock(parent, other);
+            if (a == b) continue;
+            parent[b] = a;
+
+            // The opening goes next to a random cell along the shared edge
+            const int bx = block % layout.blocksX;
+            const int by = block / layout.blocksX;
+            size_t x, y;
+            if (seam.second == 0) {
+                x = static_cast<size_t>(layout.firstCellX(bx + 1)) * 2;
+                y = static_cast<size_t>(layout.firstCellY(by) + nextRandom(random) % layout.blockHeight(by)) * 2 + 1;
+            }
+            else {
+                x = static_cast<size_t>(layout.firstCellX(bx) + nextRandom(random) % layout.blockWidth(bx)) * 2 + 1;
+                y = static_cast<size_t>(layout.firstCellY(by + 1)) * 2;
+            }
+            tiles[y * width + x] = PATH;
+        }
+    }
+}
+
+void TiledMazeGenerator::carve(MazeGenerator::Algorithm algorithm, uint8_t* tiles, int width, int height, uint32_t seed,
+    int threadCount, int blockCells) {
+    Layout layout;
+    layout.cellsX = std::max(0, (width - 1) / 2);
+    layout.cellsY = std::max(0, (height - 1) / 2);
+    if (layout.cellsX == 0 || layout.cellsY == 0) {
+        std::memset(tiles, 0, static_cast<size_t>(std::max(0, width)) * std::max(0, height));
+        return;
+    }
+    layout.blockCells = std::max(1, blockCells);
+    layout.blocksX = (layout.cellsX + layout.blockCells - 1) / layout.blockCells;
+    layout.blocksY = (layout.cellsY + layout.blockCells - 1) / layout.blockCells;
+    const int blockCount = layout.blocksX * layout.blocksY;
+
+    // With an even size the last column or row isn't part of any block and stays wall
+    const int usedWidth = layout.cellsX * 2 + 1;
+    const int usedHeight = layout.cellsY * 2 + 1;
+    for (int y = 0; y < usedHeight && usedWidth < width; ++y) {
+        std::memset(tiles + static_cast<size_t>(y) * width + usedWidth, 0, width - usedWidth);
+    }
+    if (usedHeight < height) {
+        std::memset(tiles + static_cast<size_t>(usedHeight) * width, 0, static_cast<size_t>(height - usedHeight) * width);
+    }
+
+    if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threadCount = std::min(threadCount, blockCount);
+
+    // Threads take the next block that nobody has started yet until none are left
+    std::atomic<int> nextBlock{ 0 };
+    auto work = [&] {
+        MazeGenerator generator;
+        std::vector<uint8_t> scratch;
+        for (int block = nextBlock++; block < blockCount; block = nextBlock++) {
+            carveBlock(algorithm, tiles, width, seed, layout, block, generator, scratch);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threadCount; ++i) {
+        helpers.emplace_back(work);
+    }
+    work();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    stitchSeams(tiles, width, seed, layout);
+}
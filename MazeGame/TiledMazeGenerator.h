@@ -0,0 +1,27 @@
+// TiledMazeGenerator.h
+#pragma once
+#include "MazeGenerator.h"
+#include <cstdint>
+
+// Carves very large mazes on several threads at once.
+//
+// The cells are split into square blocks. Every block is carved as its own perfect maze
+// (with MazeGenerator) by whichever thread gets to it first, so the blocks are walled off
+// from each other at first. Then the seams are stitched: a random spanning tree over the
+// blocks picks which neighboring blocks get joined, and each of those gets one opening in
+// the wall between them. A tree of blocks, each a tree of cells, is still a perfect maze.
+//
+// Each block's maze depends only on the seed and where the block is, and the stitching
+// runs on one thread, so the result is the same whatever the number of threads.
+// Long corridors never cross a seam more than once, so the maze looks a little blocky
+// from far away.
+namespace TiledMazeGenerator {
+    // Cells per block side unless told otherwise. A block's tiles (about 257 x 257 bytes)
+    // then fit in a core's own cache.
+    const int DEFAULT_BLOCK_CELLS = 128;
+
+    // Like MazeGenerator::carve: `tiles` is width * height bytes, row by row, 0 = wall and
+    // 1 = path, and width and height should be odd. threadCount <= 0 uses every core.
+    void carve(MazeGenerator::Algorithm algorithm, uint8_t* tiles, int width, int height, uint32_t seed,
+        int threadCount = 0, int blockCells = DEFAULT_BLOCK_CELLS);
+}
@@ -0,0 +1,175 @@
+// VecEnv.cpp
+#include "VecEnv.h"
+#include "GameConfig.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Rewards handed out by step()
+    const float REWARD_ITEM = 1.0f;     // Per item picked up
+    const float REWARD_HIT = -1.0f;     // Per life lost
+    const float REWARD_WIN = 5.0f;
+    const float REWARD_LOSE = -5.0f;
+
+    // Seeds of later games in the same environment are this far apart
+    const uint32_t EPISODE_SEED_STRIDE = 2654435761u;
+
+    void addMovers(uint8_t* plane, int width, const GameSim::Mover* movers, int count, int change) {
+        for (int i = 0; i < count; ++i) {
+            plane[movers[i].y * width + movers[i].x] += change;
+        }
+    }
+}
+
+VecEnv::VecEnv(const GameSim::Level& level, int envCount, int threadCount)
+    : level(level),
+    envCount(std::max(1, envCount)),
+    observationSize(PLANE_COUNT * level.width * level.height),
+    planeSize(level.width * level.height),
+    states(this->envCount),
+    episodes(this->envCount, 0),
+    wallPlane(planeSize) {
+    for (int tile = 0; tile < planeSize; ++tile) {
+        wallPlane[tile] = level.walkable[tile] ? 0 : 1;
+    }
+
+    int threads = threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, this->envCount);
+    slices.resize(threads);
+    for (int t = 0; t < threads; ++t) {
+        slices[t].begin = this->envCount * t / threads;
+        slices[t].end = this->envCount * (t + 1) / threads;
+    }
+
+    reset(1);
+
+    // Slice 0 is always run by the thread calling step()
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(&VecEnv::workerLoop, this, t);
+    }
+}
+
+VecEnv::~VecEnv() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void VecEnv::setObservationBuffer(uint8_t* buffer) {
+    observations = buffer;
+    if (!observations) return;
+    for (int env = 0; env < envCount; ++env) {
+        writeObservation(env);
+    }
+}
+
+void VecEnv::reset(uint32_t seed) {
+    baseSeed = seed;
+    for (int env = 0; env < envCount; ++env) {
+        episodes[env] = 0;
+        startGame(env);
+        if (observations) writeObservation(env);
+    }
+}
+
+void VecEnv::startGame(int env) {
+    uint32_t seed = baseSeed + static_cast<uint32_t>(env) + episodes[env] * EPISODE_SEED_STRIDE;
+    ++episodes[env];
+    states[env] = GameSim::newGame(level, seed);
+}
+
+void VecEnv::writeObservation(int env) {
+    const GameSim::State& state = states[env];
+    uint8_t* out = observations + static_cast<size_t>(env) * observationSize;
+    const int width = level.width;
+
+    std::memcpy(out + WALLS * planeSize, wallPlane.data(), planeSize);
+    std::memset(out + ITEMS * planeSize, 0, static_cast<size_t>(planeSize) * (PLANE_COUNT - ITEMS));
+    addMovers(out + ITEMS * planeSize, width, state.items, state.itemCount, 1);
+    addMovers(out + ENEMIES * planeSize, width, state.enemies, state.enemyCount, 1);
+    out[PLAYER * planeSize + state.playerY * width + state.playerX] = 1;
+    if (level.goalX >= 0) out[GOAL * planeSize + level.goalY * width + level.goalX] = 1;
+}
+
+void VecEnv::step(const int* actions, float* rewards, uint8_t* dones) {
+    jobActions = actions;
+    jobRewards = rewards;
+    jobDones = dones;
+
+    if (!workers.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++jobNumber;
+            workersBusy = static_cast<int>(workers.size());
+        }
+        wake.notify_all();
+    }
+
+    stepSlice(slices[0]);
+
+    if (!workers.empty()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return workersBusy == 0; });
+    }
+}
+
+void VecEnv::workerLoop(int sliceIndex) {
+    unsigned lastJob = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || jobNumber != lastJob; });
+            if (stopping) return;
+            lastJob = jobNumber;
+        }
+
+        stepSlice(slices[sliceIndex]);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last = --workersBusy == 0;
+        }
+        if (last) finished.notify_one();
+    }
+}
+
+void VecEnv::stepSlice(Slice& slice) {
+    const int width = level.width;
+    for (int env = slice.begin; env < slice.end; ++env) {
+        GameSim::State& state = states[env];
+        const GameSim::State before = state;   // A plain copy, see GameSim::State
+
+        int action = jobActions[env];
+        int dir = action >= 0 && action < 4 ? action : GameSim::STAY;
+        GameSim::step(level, state, dir, slice.scratch);
+
+        float reward = REWARD_ITEM * (state.score - before.score) / GameConfig::ITEM_SCORE +
+            REWARD_HIT * (before.lives - state.lives);
+        if (state.over) reward += state.won ? REWARD_WIN : REWARD_LOSE;
+        jobRewards[env] = reward;
+        jobDones[env] = state.over ? 1 : 0;
+
+        if (state.over) {
+            startGame(env);
+            if (observations) writeObservation(env);
+            continue;
+        }
+        if (!observations) continue;
+
+        // Only the moving things change: take them off their old tiles, put them on the new ones
+        uint8_t* out = observations + static_cast<size_t>(env) * observationSize;
+        addMovers(out + ITEMS * planeSize, width, before.items, before.itemCount, -1);
+        addMovers(out + ITEMS * planeSize, width, state.items, state.itemCount, 1);
+        addMovers(out + ENEMIES * planeSize, width, before.enemies, before.enemyCount, -1);
+        addMovers(out + ENEMIES * planeSize, width, state.enemies, state.enemyCount, 1);
+        out[PLAYER * planeSize + before.playerY * width + before.playerX] = 0;
+        out[PLAYER * planeSize + state.playerY * width + state.playerX] = 1;
+    }
+}
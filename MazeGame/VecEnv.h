@@ -0,0 +1,92 @@
+// VecEnv.h
+#pragma once
+#include "GameSim.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Many independent copies of the game stepped together, for training learning agents.
+//
+// Every copy ("environment") plays the same level with its own random seed. One call
+// to step() moves the player in every environment and runs each game until its next
+// move, spread over a few worker threads that stay alive between calls.
+//
+// Observations go into one block of memory the caller owns: for each environment,
+// PLANE_COUNT planes of width x height bytes (walls, items, enemies, player, goal).
+// A tile holds how many of that thing are on it, so walls, player and goal are 0 or 1.
+// Walls and the goal never change and the other planes are only touched where
+// something moved, so a step costs about the same however big the level is.
+// Nothing is allocated after the constructor.
+class VecEnv {
+public:
+    enum Plane { WALLS, ITEMS, ENEMIES, PLAYER, GOAL, PLANE_COUNT };
+
+    // Actions 0-3 follow the Direction enum (up, right, down, left); 4 stands still
+    static constexpr int ACTION_COUNT = 5;
+
+    // threadCount 0 = one thread per core
+    VecEnv(const GameSim::Level& level, int envCount, int threadCount = 0);
+    ~VecEnv();
+
+    VecEnv(const VecEnv&) = delete;
+    VecEnv& operator=(const VecEnv&) = delete;
+
+    int getEnvCount() const { return envCount; }
+
+    // Bytes of observation per environment (PLANE_COUNT * width * height)
+    int getObservationSize() const { return observationSize; }
+
+    // Where observations are written: getEnvCount() * getObservationSize() bytes that must
+    // stay valid until the next call. nullptr turns observations off. Setting a buffer
+    // fills it completely; after that steps only write the tiles that changed.
+    void setObservationBuffer(uint8_t* buffer);
+
+    // Start a new game in every environment; environment i gets seed + i
+    void reset(uint32_t seed);
+
+    // Apply actions[i] to environment i and write its reward and whether its game ended.
+    // A finished game is reported once and then restarted right away with a new seed, so
+    // the observation already shows the first moment of the next game.
+    void step(const int* actions, float* rewards, uint8_t* dones);
+
+    // The full game state of one environment (score, lives, time, ...)
+    const GameSim::State& getState(int env) const { return states[env]; }
+
+private:
+    const GameSim::Level& level;
+    const int envCount;
+    const int observationSize;
+    const int planeSize;
+
+    std::vector<GameSim::State> states;
+    std::vector<uint32_t> episodes;     // Games started per environment, for new seeds
+    uint32_t baseSeed = 1;
+    uint8_t* observations = nullptr;
+    std::vector<uint8_t> wallPlane;     // Copied into every observation on a full write
+
+    // Worker threads, woken once per step; each handles a fixed slice of the environments
+    struct Slice {
+        int begin, end;
+        GameSim::Scratch scratch;
+    };
+    std::vector<Slice> slices;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    unsigned jobNumber = 0;         // Goes up by one for every step()
+    int workersBusy = 0;
+    bool stopping = false;
+
+    // The step the workers are running (guarded by jobNumber/workersBusy)
+    const int* jobActions = nullptr;
+    float* jobRewards = nullptr;
+    uint8_t* jobDones = nullptr;
+
+    void startGame(int env);
+    void writeObservation(int env);
+    void stepSlice(Slice& slice);
+    void workerLoop(int sliceIndex);
+};
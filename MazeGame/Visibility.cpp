@@ -0,0 +1,164 @@
+// Visibility.cpp
+#include "Visibility.h"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+    const int SIDE = 2 * VisibilityTable::MAX_RANGE + 1;
+
+    // Calls visit(x, y) for every tile on the line from a to b, both ends included.
+    // Stops early and returns false as soon as visit returns false.
+    template <typename Visit>
+    bool traceLine(int ax, int ay, int bx, int by, Visit visit) {
+        int dx = std::abs(bx - ax);
+        int dy = -std::abs(by - ay);
+        int stepX = ax < bx ? 1 : -1;
+        int stepY = ay < by ? 1 : -1;
+        int error = dx + dy;
+
+        int x = ax;
+        int y = ay;
+        while (true) {
+            if (!visit(x, y)) return false;
+            if (x == bx && y == by) return true;
+
+            int twice = 2 * error;
+            if (twice >= dy) {
+                error += dy;
+                x += stepX;
+            }
+            if (twice <= dx) {
+                error += dx;
+                y += stepY;
+            }
+        }
+    }
+
+    // True if b comes before a in the maze, so the line has to be drawn from b instead
+    bool drawnBackward(int ax, int ay, int bx, int by) {
+        return by < ay || (by == ay && bx < ax);
+    }
+
+    bool inRange(int dx, int dy, int range) {
+        return dx * dx + dy * dy <= range * range;
+    }
+
+    // Tiles x .. x + 63 of row y as one word; anything outside the grid reads as wall
+    uint64_t bitsAt(const BitGrid& grid, int x, int y) {
+        if (y < 0 || y >= grid.height) return 0;
+
+        int word = (x >= 0 ? x : x - 63) / 64;
+        int shift = x - word * 64;
+        auto wordAt = [&](int index) {
+            return index >= 0 && index < grid.wordsPerRow ? grid.row(y)[index] : 0;
+        };
+
+        uint64_t bits = wordAt(word) >> shift;
+        if (shift > 0) bits |= wordAt(word + 1) << (64 - shift);
+        return bits;
+    }
+}
+
+bool Visibility::lineOfSight(const BitGrid& walk, int ax, int ay, int bx, int by) {
+    if (drawnBackward(ax, ay, bx, by)) {
+        std::swap(ax, bx);
+        std::swap(ay, by);
+    }
+    return traceLine(ax, ay, bx, by, [&](int x, int y) { return walk.get(x, y); });
+}
+
+bool Visibility::canSee(const BitGrid& walk, int ax, int ay, int bx, int by, int range) {
+    if (!inRange(bx - ax, by - ay, range)) return false;
+    return lineOfSight(walk, ax, ay, bx, by);
+}
+
+void Visibility::canSeeTarget(const BitGrid& walk, const std::vector<Point>& viewers,
+    int targetX, int targetY, int range, std::vector<uint8_t>& seen) {
+    seen.assign(viewers.size(), 0);
+    if (!walk.get(targetX, targetY)) return;
+
+    for (size_t i = 0; i < viewers.size(); ++i) {
+        seen[i] = canSee(walk, viewers[i].x, viewers[i].y, targetX, targetY, range) ? 1 : 0;
+    }
+}
+
+void VisibilityTable::build(const BitGrid& walk, int maxRange) {
+    range = std::max(0, std::min(maxRange, MAX_RANGE));
+    width = walk.width;
+    height = walk.height;
+
+    // Number the offsets inside the range
+    offsetBit.assign(SIDE * SIDE, -1);
+    int bitCount = 0;
+    for (int dy = -range; dy <= range; ++dy) {
+        for (int dx = -range; dx <= range; ++dx) {
+            if (inRange(dx, dy, range)) offsetBit[(dy + MAX_RANGE) * SIDE + dx + MAX_RANGE] = bitCount++;
+        }
+    }
+    wordsPerTile = (bitCount + 63) / 64;
+    bits.assign(static_cast<size_t>(width) * height * wordsPerTile, 0);
+
+    auto setBit = [&](int x, int y, int dx, int dy) {
+        int bit = offsetBit[(dy + MAX_RANGE) * SIDE + dx + MAX_RANGE];
+        bits[(static_cast<size_t>(y) * width + x) * wordsPerTile + bit / 64] |= uint64_t(1) << (bit % 64);
+    };
+
+    std::vector<std::pair<int, int>> line;
+    for (int dy = 0; dy <= range; ++dy) {
+        for (int dx = -range; dx <= range; ++dx) {
+            if (dy == 0 && dx < 0) continue;    // The other half follows from A seeing B = B seeing A
+            if (!inRange(dx, dy, range)) continue;
+
+            // Tiles the line crosses, relative to where it starts
+            line.clear();
+            traceLine(0, 0, dx, dy, [&](int x, int y) {
+                line.push_back({ x, y });
+                return true;
+            });
+
+            // Bit i of `clear` is set if tile (word * 64 + i, y) sees the tile (dx, dy) away:
+            // AND together the walls shifted by every step of the line, 64 tiles at once
+            for (int y = 0; y < height; ++y) {
+                for (int word = 0; word * 64 < width; ++word) {
+                    uint64_t clear = ~uint64_t(0);
+                    for (const auto& step : line) {
+                        clear &= bitsAt(walk, word * 64 + step.first, y + step.second);
+                    }
+
+                    while (clear) {
+                        int x = word * 64 + lowestBit(clear);
+                        clear &= clear - 1;
+                        setBit(x, y, dx, dy);
+                        setBit(x + dx, y + dy, -dx, -dy);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool VisibilityTable::canSee(int ax, int ay, int bx, int by) const {
+    if (ax < 0 || ax >= width || ay < 0 || ay >= height) return false;
+
+    int dx = bx - ax;
+    int dy = by - ay;
+    if (dx < -range || dx > range || dy < -range || dy > range) return false;
+
+    int bit = offsetBit[(dy + MAX_RANGE) * SIDE + dx + MAX_RANGE];
+    if (bit < 0) return false;
+    return (bits[(static_cast<size_t>(ay) * width + ax) * wordsPerTile + bit / 64] >> (bit % 64)) & 1;
+}
+
+void VisibilityTable::canSeeTarget(const std::vector<Visibility::Point>& viewers,
+    int targetX, int targetY, std::vector<uint8_t>& seen) const {
+    // Seeing is symmetric, so every check reads the target's bits
+    seen.resize(viewers.size());
+    for (size_t i = 0; i < viewers.size(); ++i) {
+        seen[i] = canSee(targetX, targetY, viewers[i].x, viewers[i].y) ? 1 : 0;
+    }
+}
+
+size_t VisibilityTable::getMemoryBytes() const {
+    return bits.capacity() * sizeof(uint64_t) + offsetBit.capacity() * sizeof(int);
+}
@@ -0,0 +1,62 @@
+// Visibility.h
+#pragma once
+#include "BitGrid.h"
+#include <cstdint>
+#include <vector>
+
+// "Can this tile see that tile?" checks against the walls of the maze.
+//
+// A line is drawn from the center of one tile to the center of the other with
+// Bresenham's algorithm, and the view is blocked if any tile on it is a wall.
+// The line is always drawn from the tile that comes first in the maze (top to
+// bottom, left to right), so A sees B exactly when B sees A.
+namespace Visibility {
+    struct Point {
+        int x, y;
+    };
+
+    // True if no wall is on the line between the two tiles (both must be walkable)
+    bool lineOfSight(const BitGrid& walk, int ax, int ay, int bx, int by);
+
+    // Line of sight, but only up to `range` tiles away (measured as a straight line)
+    bool canSee(const BitGrid& walk, int ax, int ay, int bx, int by, int range);
+
+    // canSee() from every viewer to one target: seen[i] is 1 if viewers[i] sees it
+    void canSeeTarget(const BitGrid& walk, const std::vector<Point>& viewers,
+        int targetX, int targetY, int range, std::vector<uint8_t>& seen);
+}
+
+// Precomputed answers to canSee() for a maze that doesn't change, so each check is
+// a single bit lookup. Every tile stores one bit per offset (dx, dy) within the range
+// saying whether it sees that tile; the bits of one tile sit together, so checking a
+// whole crowd of enemies against the player only reads the player's few words.
+// Needs about range * range * 0.4 bytes per tile (24 bytes at range 7).
+class VisibilityTable {
+public:
+    static constexpr int MAX_RANGE = 7;
+
+    // Work out every check up to `range` tiles (at most MAX_RANGE) for `walk`
+    void build(const BitGrid& walk, int range);
+
+    // Same answer as Visibility::canSee() with the range given to build()
+    bool canSee(int ax, int ay, int bx, int by) const;
+
+    // Same answers as Visibility::canSeeTarget()
+    void canSeeTarget(const std::vector<Visibility::Point>& viewers,
+        int targetX, int targetY, std::vector<uint8_t>& seen) const;
+
+    int getRange() const { return range; }
+    size_t getMemoryBytes() const;
+
+private:
+    int range = 0;
+    int width = 0;
+    int height = 0;
+    int wordsPerTile = 0;
+
+    // Bits of tile t are bits[t * wordsPerTile ...]. The bit for an offset is
+    // offsetBit[(dy + MAX_RANGE) * (2 * MAX_RANGE + 1) + dx + MAX_RANGE], or -1 if
+    // that offset is out of range.
+    std::vector<uint64_t> bits;
+    std::vector<int> offsetBit;
+};
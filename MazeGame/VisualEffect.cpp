@@ -3,6 +3,7 @@
 #include "GameConfig.h"
 #include "Game.h"
 #include "Renderer.h"
+#include "GameSession.h"
 
 #include <SDL3/SDL.h>
 #include <vector>
@@ -16,8 +17,14 @@ namespace {
         VisualEffect::EffectConfig config;
         Uint64 startTime = 0;
     };
+}
 
+struct VisualEffect::SessionState {
     std::vector<Effect> effects;
+};
+
+std::shared_ptr<VisualEffect::SessionState> VisualEffect::createSessionState() {
+    return std::make_shared<SessionState>();
 }
 
 void VisualEffect::add(const std::string& text, int tileX, int tileY, const EffectConfig& config) {
@@ -29,13 +36,16 @@ void VisualEffect::add(const std::string& text, int tileX, int tileY, const Effe
     fx.x = static_cast<float>(pixelX);
     fx.y = static_cast<float>(pixelY);
     fx.config = config;
-    fx.startTime = SDL_GetTicks();
+    GameSession& session = GameSession::current();
+    fx.startTime = session.now();
 
-    effects.push_back(fx);
+    session.effects->effects.push_back(fx);
 }
 
 void VisualEffect::updateAll() {
-    Uint64 now = SDL_GetTicks();
+    GameSession& session = GameSession::current();
+    auto& effects = session.effects->effects;
+    Uint64 now = session.now();
 
     for (size_t i = 0; i < effects.size(); ) {
         Effect& fx = effects[i];
@@ -53,6 +63,7 @@ void VisualEffect::updateAll() {
 }
 
 void VisualEffect::renderAll() {
+    const auto& effects = GameSession::current().effects->effects;
     for (const auto& fx : effects) {
         SDL_Color color = fx.config.color;
         color.a = static_cast<Uint8>(fx.alpha);
@@ -2,6 +2,7 @@
 #pragma once
 #include <string>
 #include <SDL3/SDL.h>
+#include <memory>
 
 namespace VisualEffect {
 
@@ -17,4 +18,8 @@ namespace VisualEffect {
 
     void updateAll();
     void renderAll();
+
+    // What this module keeps for one game (see GameSession.h)
+    struct SessionState;
+    std::shared_ptr<SessionState> createSessionState();
 }
\ No newline at end of file
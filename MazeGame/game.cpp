@@ -14,6 +14,10 @@
 #include "Enemy.h"
 #include "Item.h"
 #include "Goal.h"
+#include "HintPath.h"
+#include "AutoPlay.h"
+#include "GameSession.h"
+#include "LevelProgression.h"
 
 // ---------------------
 // INTERNAL GAME STATE
@@ -23,20 +27,9 @@ namespace {
     SDL_Renderer* renderer = nullptr;
     TTF_Font* font = nullptr;
 
-    bool gameOver = false;
-    bool gameWon = false;
     bool exitRequested = false;
 
-    int score = 0;
-    int timeRemaining = 100;
-    int playerLives = GameConfig::PLAYER_LIVES;
-
-    Uint64 gameStartTime = 0;
-    Uint64 lastTimeDecrease = 0;
-
-    // For invulnerability after being hit
-    bool isInvulnerable = false;
-    Uint64 invulnerableStartTime = 0;
+    // Score, lives, timers and everything on the maze live in the default GameSession
 }
 
 // ---------------------
@@ -83,8 +76,7 @@ bool Game::init() {
     }
 
     // Record start time
-    gameStartTime = SDL_GetTicks();
-    lastTimeDecrease = gameStartTime;
+    GameSession::current().resetStats();
 
     return true;
 }
@@ -93,6 +85,10 @@ bool Game::init() {
 // CLEANUP
 // ---------------------
 void Game::shutdown() {
+    HintPath::shutdown();
+    AutoPlay::shutdown();
+    LevelProgression::shutdown();
+
     TTF_CloseFont(font);
     font = nullptr;
 
@@ -110,10 +106,12 @@ void Game::shutdown() {
 void Game::handleInput(SDL_Event& event) {
     if (event.type == SDL_EVENT_KEY_DOWN) {
         switch (event.key.key) {
-        case SDLK_UP: Player::move(0, -1); break;
-        case SDLK_DOWN: Player::move(0, 1); break;
-        case SDLK_LEFT: Player::move(-1, 0); break;
-        case SDLK_RIGHT: Player::move(1, 0); break;
+        case SDLK_UP: GameSession::current().movePlayer(0, -1); break;
+        case SDLK_DOWN: GameSession::current().movePlayer(0, 1); break;
+        case SDLK_LEFT: GameSession::current().movePlayer(-1, 0); break;
+        case SDLK_RIGHT: GameSession::current().movePlayer(1, 0); break;
+        case SDLK_H: HintPath::toggle(); break;
+        case SDLK_A: AutoPlay::toggle(); break;
         }
     }
 }
@@ -128,57 +126,22 @@ bool Game::shouldQuit() {
 // GAME LOGIC UPDATE
 // ---------------------
 void Game::update() {
-    if (gameOver) return;
-
-    Uint64 now = SDL_GetTicks();
-
-    // Handle invulnerability timer
-    if (isInvulnerable && now - invulnerableStartTime >= GameConfig::INVULNERABLE_DURATION) {
-        isInvulnerable = false;
-    }
+    GameSession& session = GameSession::current();
+    if (session.isOver()) return;
 
-    // Decrease timer every second
-    if (now - lastTimeDecrease >= GameConfig::TIME_DECREASE_INTERVAL) {
-        timeRemaining--;
-        lastTimeDecrease = now;
-    }
-
-    // Update game objects
-    Player::update();
-    Enemy::updateAll();
-    Item::updateAll();
-    VisualEffect::updateAll();
-
-    // Check for item pickup
-    Item::checkCollection(score);
-
-    // Check for enemy collision
-    if (!isInvulnerable && Enemy::checkCollisionWithPlayer()) {
-        playerLives -= GameConfig::LIFE_LOSS_ON_HIT;
-        isInvulnerable = true;
-        invulnerableStartTime = now;
-
-        VisualEffect::EffectConfig config;
-        config.color = { 255, 0, 0, 255 }; // Red for damage
-        config.fontSize = 28;
-        config.riseSpeed = 0.08f;
-        config.duration = 1200;
-
-        VisualEffect::add("-" + std::to_string(GameConfig::LIFE_LOSS_ON_HIT) + " Life",
-            Player::getX(), Player::getY(), config);
-    }
+    // Let the bot move the player if autoplay is on
+    AutoPlay::update(session.getScore(), session.getTimeRemaining(), session.getLives(),
+        session.getInvulnerableLeft(), session.getNextSecondIn());
 
-    // Win condition
-    if (Goal::checkReached()) {
-        gameWon = true;
-        gameOver = true;
-    }
+    // Timers, enemies, items, pickups, hits, win/lose
+    session.update();
 
-    // Lose condition
-    if (timeRemaining <= 0 || playerLives <= 0) {
-        gameWon = false;
-        gameOver = true;
+    // With level progression, reaching the goal goes straight on to the next level
+    if (session.hasWon() && LevelProgression::isActive()) {
+        LevelProgression::advance();
     }
+    LevelProgression::update();
+    HintPath::update();
 }
 
 // ---------------------
@@ -188,14 +151,19 @@ void Game::render() {
     SDL_SetRenderDrawColor(renderer, GameConfig::COLOR_BG.r, GameConfig::COLOR_BG.g, GameConfig::COLOR_BG.b, 255);
     SDL_RenderClear(renderer);
 
+    const GameSession& session = GameSession::current();
+
     // Draw game components
-    Maze::render();
+    if (!LevelProgression::renderBackground()) {
+        Maze::render();
+    }
+    HintPath::render();
     Item::renderAll();
     Enemy::renderAll();
     Goal::render();
-    Player::render(isInvulnerable);
+    Player::render(session.isInvulnerable());
     VisualEffect::renderAll();
-    UIManager::renderAll(score, timeRemaining, playerLives);
+    UIManager::renderAll(session.getScore(), session.getTimeRemaining(), session.getLives());
 
     SDL_RenderPresent(renderer);
 }
@@ -204,21 +172,21 @@ void Game::render() {
 // END SCREEN POPUP
 // ---------------------
 bool Game::isOver() {
-    return gameOver;
+    return GameSession::current().isOver();
 }
 
 void Game::showEndScreen() {
-    Uint64 endTime = SDL_GetTicks();
-    float seconds = (endTime - gameStartTime) / 1000.0f;
+    GameSession& session = GameSession::current();
+    float seconds = session.getPlayTime() / 1000.0f;
 
     // Format time with configurable decimal places
     std::ostringstream timeStream;
     timeStream.precision(GameConfig::TIME_PLAYED_DECIMALS);
     timeStream << std::fixed << seconds;
 
-    std::string title = gameWon ? "You Win!" : "You Lose!";
-    std::string message = "Final Score: " + std::to_string(score) +
-        "\nLives Remaining: " + std::to_string(playerLives) +
+    std::string title = session.hasWon() ? "You Win!" : "You Lose!";
+    std::string message = "Final Score: " + std::to_string(session.getScore()) +
+        "\nLives Remaining: " + std::to_string(session.getLives()) +
         "\nTime Played: " + timeStream.str() + "s";
 
     const SDL_MessageBoxButtonData buttons[] = {
@@ -237,14 +205,7 @@ void Game::showEndScreen() {
 
     if (buttonId == 1) {
         // Restart the game
-        Maze::reload();
-        gameOver = false;
-        gameWon = false;
-        timeRemaining = 100;
-        playerLives = GameConfig::PLAYER_LIVES;
-        score = 0;
-        gameStartTime = SDL_GetTicks();
-        lastTimeDecrease = gameStartTime;
+        session.restart();
         UIManager::setupDefaultLabels();
     }
     else {
@@ -2,19 +2,28 @@
 #include "Game.h"
 #include "GameConfig.h"
 #include "Maze.h"
+#include "MazeFile.h"
+#include "MazeGenerator.h"
 #include "UIManager.h"
+#include "Benchmark.h"
+#include "CaveGenerator.h"
+#include "ContractionHierarchy.h"
+#include "Playtest.h"
+#include "GameSession.h"
+#include "LevelPack.h"
+#include "LevelProgression.h"
+#include "MappedMaze.h"
+#include "MazeImage.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <memory>
+#include <string>
 
 int main(int argc, char* argv[]) {
-    // Initialize SDL and game systems
-    if (!Game::init()) {
-        return 1;   // Exit if initialization fails
-    }
-
-    // Seed the random number generator (used for item/enemy placement)
-    srand(static_cast<unsigned int>(time(nullptr)));
+    // Seed the game's random number generator (used for item/enemy placement and movement)
+    GameSession::current().seedRandom(static_cast<unsigned int>(time(nullptr)));
 
     // Define the maze layout
     // 0 = Wall, 1 = Path, 2 = Item, 3 = Player, 4 = Goal, 5 = Enemy
@@ -37,12 +46,209 @@ int main(int argc, char* argv[]) {
         {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
     };
 
+    // "MazeGame --generate <algorithm> [seed]" plays a freshly generated maze instead
+    // (backtracker, kruskal, prim, wilson or growing-tree);
+    // "MazeGame --levels <algorithm> [seed]" goes on to a new one every time the goal is reached
+    bool levels = argc >= 3 && std::string(argv[1]) == "--levels";
+    MazeGenerator::Algorithm algorithm = MazeGenerator::Algorithm::BACKTRACKER;
+    unsigned int generateSeed = 0;
+    if (argc >= 3 && (std::string(argv[1]) == "--generate" || levels)) {
+        if (!MazeGenerator::findAlgorithm(argv[2], algorithm)) {
+            SDL_Log("Unknown maze algorithm '%s'", argv[2]);
+            return 1;
+        }
+        generateSeed = argc >= 4 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10))
+            : static_cast<unsigned int>(time(nullptr));
+        layout = MazeGenerator::generate(algorithm, GameConfig::MAZE_WIDTH, GameConfig::MAZE_HEIGHT, generateSeed);
+    }
+
+    // "MazeGame --cave [seed]" plays a generated cave instead
+    if (argc >= 2 && std::string(argv[1]) == "--cave") {
+        unsigned int seed = argc >= 3 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10))
+            : static_cast<unsigned int>(time(nullptr));
+        layout = CaveGenerator::generateLayout(GameConfig::MAZE_WIDTH, GameConfig::MAZE_HEIGHT, seed);
+    }
+
+    // "MazeGame <file>" plays a maze from a text file instead (see MazeFile.h and the levels folder),
+    // or a binary maze file straight from the disk (see MappedMaze.h);
+    // "MazeGame <pack file> [level]" plays the levels of a level pack one after another (see LevelPack.h);
+    // "MazeGame <image.bmp> [palette file]" plays a maze drawn as an image (see MazeImage.h)
+    bool mapped = argc >= 2 && argv[1][0] != '-' && MappedMaze::isMazeFile(argv[1]);
+    std::shared_ptr<LevelPack> pack;
+    int packLevel = 1;
+    if (argc >= 2 && argv[1][0] != '-' && LevelPack::isPackFile(argv[1])) {
+        pack = std::make_shared<LevelPack>();
+        packLevel = argc >= 3 ? std::max(1, std::atoi(argv[2])) : 1;
+        MazeFile::TileGrid grid;
+        std::string error;
+        if (!pack->open(argv[1], error) || !pack->load(packLevel - 1, grid, error) ||
+            !MazeFile::toLayout(grid, layout, error)) {
+            SDL_Log("Can't play %s: %s", argv[1], error.c_str());
+            return 1;
+        }
+    }
+    else if (argc >= 2 && argv[1][0] != '-' && MazeImage::isBmpFile(argv[1])) {
+        std::vector<MazeImage::PaletteColor> palette = MazeImage::defaultPalette();
+        MazeFile::TileGrid grid;
+        std::string error;
+        if ((argc >= 3 && !MazeImage::loadPalette(argv[2], palette, error)) ||
+            !MazeImage::load(argv[1], palette, grid, error) || !MazeFile::toLayout(grid, layout, error)) {
+            SDL_Log("Can't play %s: %s", argv[1], error.c_str());
+            return 1;
+        }
+    }
+    else if (argc >= 2 && argv[1][0] != '-' && !mapped) {
+        MazeFile::TileGrid grid;
+        std::string error;
+        if (!MazeFile::load(argv[1], grid, error) || !MazeFile::toLayout(grid, layout, error)) {
+            SDL_Log("Can't play %s: %s", argv[1], error.c_str());
+            return 1;
+        }
+    }
+
+    // "MazeGame --convert <text file> <binary file>" turns a text maze into a binary maze file;
+    // "MazeGame --convert <image.bmp> <binary file> [palette file]" does the same for an image,
+    // which is the way to play images too big for MAZE_WIDTH and MAZE_HEIGHT
+    if (argc >= 4 && std::string(argv[1]) == "--convert") {
+        MazeFile::TileGrid grid;
+        std::string error;
+        bool read;
+        if (MazeImage::isBmpFile(argv[2])) {
+            std::vector<MazeImage::PaletteColor> palette = MazeImage::defaultPalette();
+            read = (argc < 5 || MazeImage::loadPalette(argv[4], palette, error)) &&
+                MazeImage::load(argv[2], palette, grid, error);
+        }
+        else {
+            read = MazeFile::load(argv[2], grid, error);
+        }
+        if (!read || !MappedMaze::write(argv[3], grid, error)) {
+            SDL_Log("Can't convert %s: %s", argv[2], error.c_str());
+            return 1;
+        }
+        SDL_Log("Wrote %s (%d x %d tiles)", argv[3], grid.width, grid.height);
+        return 0;
+    }
+
+    // "MazeGame --contract <maze file> [sidecar]" builds the contraction hierarchy of a text or
+    // binary maze and saves it next to the maze (or as `sidecar`). Playing a binary maze that
+    // has one shows the steps to the goal in the hint (the H key), wherever the goal is.
+    if (argc >= 3 && std::string(argv[1]) == "--contract") {
+        BitGrid walk;
+        std::string error;
+        if (MappedMaze::isMazeFile(argv[2])) {
+            MappedMaze mappedMaze;
+            if (!mappedMaze.open(argv[2], error)) {
+                SDL_Log("Can't read %s: %s", argv[2], error.c_str());
+                return 1;
+            }
+            mappedMaze.copyWalls(walk);
+        }
+        else {
+            MazeFile::TileGrid grid;
+            if (!MazeFile::load(argv[2], grid, error)) {
+                SDL_Log("Can't read %s: %s", argv[2], error.c_str());
+                return 1;
+            }
+            walk = BitGrid(grid.width, grid.height);
+            for (int y = 0; y < grid.height; ++y) {
+                for (int x = 0; x < grid.width; ++x) {
+                    walk.set(x, y, grid.at(x, y) != 0);
+                }
+            }
+        }
+
+        const std::string sidecar = argc >= 4 ? argv[3] : ContractionHierarchy::sidecarPath(argv[2]);
+        ContractionHierarchy hierarchy;
+        hierarchy.build(walk);
+        if (!hierarchy.save(sidecar)) {
+            SDL_Log("Can't write %s", sidecar.c_str());
+            return 1;
+        }
+        SDL_Log("Wrote %s (%d junctions, %d shortcuts)", sidecar.c_str(), hierarchy.getNodeCount(),
+            hierarchy.getShortcutCount());
+        return 0;
+    }
+
+    // "MazeGame --pack <pack file> <text files...>" puts text mazes into a level pack, in that order
+    if (argc >= 4 && std::string(argv[1]) == "--pack") {
+        std::vector<MazeFile::TileGrid> packLevels(argc - 3);
+        std::string error;
+        for (int i = 3; i < argc; ++i) {
+            if (!MazeFile::load(argv[i], packLevels[i - 3], error)) {
+                SDL_Log("Can't read %s: %s", argv[i], error.c_str());
+                return 1;
+            }
+        }
+        if (!LevelPack::write(argv[2], packLevels, error)) {
+            SDL_Log("Can't write the pack: %s", error.c_str());
+            return 1;
+        }
+        SDL_Log("Wrote %s (%d levels)", argv[2], argc - 3);
+        return 0;
+    }
+
     // Load the maze and place items, enemies, player, etc.
-    Maze::loadLayout(layout);
+    // "MazeGame --endless [seed]" plays a maze that keeps going down instead
+    if (argc >= 2 && std::string(argv[1]) == "--endless") {
+        unsigned int seed = argc >= 3 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10))
+            : static_cast<unsigned int>(time(nullptr));
+        Maze::loadEndless(seed);
+    }
+    // "MazeGame --world [seed]" plays a maze without edges in every direction
+    else if (argc >= 2 && std::string(argv[1]) == "--world") {
+        unsigned int seed = argc >= 3 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10))
+            : static_cast<unsigned int>(time(nullptr));
+        Maze::loadWorld(seed);
+    }
+    else if (mapped) {
+        std::string error;
+        if (!Maze::loadMapped(argv[1], error)) {
+            SDL_Log("Can't play %s: %s", argv[1], error.c_str());
+            return 1;
+        }
+    }
+    else {
+        Maze::loadLayout(layout);
+    }
+
+    // "MazeGame --bench <name>" runs a benchmark in the console instead of the game
+    if (argc >= 3 && std::string(argv[1]) == "--bench") {
+        return Benchmark::run(argv[2]) ? 0 : 1;
+    }
+
+    // "MazeGame --playtest [games]" plays this layout with bots and prints how often they win;
+    // "MazeGame --playtest-sweep [games]" does the same for a grid of difficulty settings
+    if (argc >= 2 && (std::string(argv[1]) == "--playtest" || std::string(argv[1]) == "--playtest-sweep")) {
+        bool sweep = std::string(argv[1]) == "--playtest-sweep";
+        int games = argc >= 3 ? std::atoi(argv[2]) : (sweep ? 500 : 2000);
+        Playtest::run(layout, std::max(1, games), sweep);
+        return 0;
+    }
+
+    // "MazeGame --playtest-mcts [games] [ms]" compares the MCTS bot (thinking `ms` per move) with the others
+    if (argc >= 2 && std::string(argv[1]) == "--playtest-mcts") {
+        int games = argc >= 3 ? std::atoi(argv[2]) : 20;
+        int moveTime = argc >= 4 ? std::atoi(argv[3]) : 20;
+        Playtest::runMcts(layout, std::max(1, games), static_cast<Uint64>(std::max(1, moveTime)));
+        return 0;
+    }
+
+    // Initialize SDL and game systems
+    if (!Game::init()) {
+        return 1;   // Exit if initialization fails
+    }
 
     // Setup UI labels like Score, Time, Lives
     UIManager::setupDefaultLabels();
 
+    // Start making the second level while the first one is played
+    if (levels) {
+        LevelProgression::start(algorithm, generateSeed);
+    }
+    if (pack) {
+        LevelProgression::startPack(pack, packLevel);
+    }
+
     // Main game loop
     bool quit = false;
     SDL_Event event;